@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include "cosigner/cmp_key_persistency.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// Pool of pre generated auxiliary keys (paillier and ring pedersen key pairs) for cmp_setup_service. Generating these keys requires
+// a search for large primes which takes seconds, so the pool generates them in background threads and key setup only takes a ready pair.
+// Each key pair is handed out once and never reused.
+class COSIGNER_EXPORT cmp_auxiliary_keys_pool final
+{
+public:
+    // Optional persistency, allows keeping the pre generated keys across restarts
+    class pool_persistency
+    {
+    public:
+        virtual ~pool_persistency();
+
+        // called once by the pool constructor
+        virtual void load_pool_keys(std::map<uint64_t, auxiliary_keys>& keys) = 0;
+        virtual void store_pool_keys(uint64_t id, const auxiliary_keys& aux) = 0;
+        // the pool hands out the keys only after this function returns, so it must delete them durably or throw
+        virtual void delete_pool_keys(uint64_t id) = 0;
+    };
+
+    // capacity is the maximal number of keys kept in the pool, threads is the number of background generators (0 disables background generation)
+    cmp_auxiliary_keys_pool(size_t capacity, size_t threads = 1, pool_persistency* persistency = NULL);
+    // waits for the keys currently being generated
+    ~cmp_auxiliary_keys_pool();
+
+    cmp_auxiliary_keys_pool(const cmp_auxiliary_keys_pool&) = delete;
+    cmp_auxiliary_keys_pool& operator=(const cmp_auxiliary_keys_pool&) = delete;
+
+    // returns a key pair from the pool, if the pool is empty generates a new one
+    auxiliary_keys get();
+    // returns the number of ready key pairs
+    size_t size() const;
+    // generates key pairs in the calling thread until the pool is full
+    void fill();
+
+private:
+    bool reserve_slot(bool wait, uint64_t& id);
+    void generate_and_add(uint64_t id);
+    void generator_thread();
+
+    const size_t _capacity;
+    pool_persistency* _persistency;
+
+    mutable std::mutex _lock;
+    std::condition_variable _cond;
+    std::deque<std::pair<uint64_t, auxiliary_keys>> _keys;
+    uint64_t _next_id;
+    size_t _pending;
+    bool _stop;
+    std::vector<std::thread> _threads;
+};
+
+}
+}
+}
@@ -12,6 +12,7 @@ namespace cosigner
 {
 
 struct cmp_signature_preprocessed_data;
+struct cmp_signature_r_info;
 
 // this class implements MPC CMP for offline signing based on https://eprint.iacr.org/2020/492 paper
 class COSIGNER_EXPORT cmp_ecdsa_offline_signing_service final : public cmp_ecdsa_signing_service
@@ -52,6 +53,8 @@ public:
     void cancel_preprocessing(const std::string& request_id);
 
 private:
+    static void calc_r_info(cosigner_sign_algorithm algorithm, const elliptic_curve_point& R, cmp_signature_r_info& info);
+
     preprocessing_persistency& _preprocessing_persistency;
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include "cosigner/cmp_ecdsa_offline_signing_service.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// Runs the 4 rounds of cmp_ecdsa_offline_signing_service preprocessing on a pool of worker threads, so several preprocessing requests
+// (of the same or different keys) can be in flight and the cores are used by one request while the messages of another are on the wire.
+// Each function queues the round and returns immediately, the future holds the round output (or the exception it threw).
+// Queued rounds are executed from the last round to the first, so requests in flight complete (and free their memory) before new ones progress.
+// The number of requests in flight is bounded by max_in_flight, a request is in flight from start until store_presigning_data returns,
+// any of its rounds fails or it's canceled. Rounds 2-4 are accepted only for requests in flight with no other round queued, otherwise the function
+// throws cosigner_exception::INVALID_TRANSACTION. The preprocessing_persistency must support concurrent calls for different request ids.
+class COSIGNER_EXPORT cmp_ecdsa_preprocessing_pipeline final
+{
+public:
+    cmp_ecdsa_preprocessing_pipeline(cmp_ecdsa_offline_signing_service& service, size_t max_in_flight, size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+    // rounds that didn't start yet are abandoned, their futures throw std::future_error
+    ~cmp_ecdsa_preprocessing_pipeline();
+
+    cmp_ecdsa_preprocessing_pipeline(const cmp_ecdsa_preprocessing_pipeline&) = delete;
+    cmp_ecdsa_preprocessing_pipeline& operator=(const cmp_ecdsa_preprocessing_pipeline&) = delete;
+
+    // throws cosigner_exception::BUSY if max_in_flight requests are in flight
+    std::future<std::vector<cmp_mta_request>> start_ecdsa_signature_preprocessing(const std::string& tenant_id, const std::string& key_id, const std::string& request_id, uint32_t start_index, uint32_t count, uint32_t total_count, const std::set<uint64_t>& players_ids);
+    std::future<cmp_mta_responses> offline_mta_response(const std::string& request_id, std::map<uint64_t, std::vector<cmp_mta_request>> requests);
+    std::future<std::vector<cmp_mta_deltas>> offline_mta_verify(const std::string& request_id, std::map<uint64_t, cmp_mta_responses> mta_responses);
+    // the future holds the key id
+    std::future<std::string> store_presigning_data(const std::string& request_id, std::map<uint64_t, std::vector<cmp_mta_deltas>> deltas);
+
+    void cancel_preprocessing(const std::string& request_id);
+
+    size_t in_flight() const;
+
+private:
+    static const size_t ROUNDS = 4;
+
+    template<typename T>
+    std::future<T> enqueue(size_t round, const std::string& request_id, std::function<T()> func);
+    void request_done(const std::string& request_id);
+    bool is_in_flight(const std::string& request_id) const;
+    void stop();
+    void worker_thread();
+
+    cmp_ecdsa_offline_signing_service& _service;
+    const size_t _max_in_flight;
+
+    mutable std::mutex _lock;
+    std::condition_variable _cond;
+    std::deque<std::function<void()>> _queues[ROUNDS];
+    std::map<std::string, bool> _in_flight; // request id -> has a queued round
+    bool _stop;
+    std::vector<std::thread> _threads;
+};
+
+}
+}
+}
@@ -4,8 +4,10 @@
 
 #include "cosigner/types.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 struct paillier_public_key;
@@ -20,11 +22,69 @@ namespace common
 namespace cosigner
 {
 
+COSIGNER_EXPORT void deserialize_public_key(const byte_vector_t& serialized, std::shared_ptr<struct paillier_public_key>& key);
+COSIGNER_EXPORT void deserialize_public_key(const byte_vector_t& serialized, std::shared_ptr<struct ring_pedersen_public>& key);
+
+// Holds a player public key which is either set directly or deserialized on first access from the serialized key provided by the store,
+// so a round pays only for the keys it uses. Copies share the deserialized key. Only keys created by from_serialized allocate the shared
+// state, and once loaded accessing the key costs a single acquire load.
+template <typename T>
+class lazy_public_key
+{
+public:
+    lazy_public_key() {}
+    lazy_public_key(std::shared_ptr<T> key) : _key(std::move(key)) {}
+
+    // throws cosigner_exception::INTERNAL_ERROR if the key fails to deserialize
+    const std::shared_ptr<T>& key() const
+    {
+        if (!_pending)
+            return _key;
+        if (!_pending->loaded.load(std::memory_order_acquire))
+            load();
+        return _pending->key;
+    }
+    
+    T* get() const {return key().get();}
+    operator const std::shared_ptr<T>&() const {return key();}
+    explicit operator bool() const {return key() != nullptr;}
+
+    static lazy_public_key from_serialized(byte_vector_t serialized)
+    {
+        lazy_public_key ret;
+        ret._pending = std::make_shared<pending>();
+        ret._pending->serialized = std::move(serialized);
+        return ret;
+    }
+
+private:
+    void load() const
+    {
+        std::lock_guard<std::mutex> lg(_pending->lock);
+        if (_pending->loaded.load(std::memory_order_relaxed))
+            return;
+        // if deserialization throws the key stays unloaded, so the next access retries it
+        deserialize_public_key(_pending->serialized, _pending->key);
+        _pending->serialized.clear();
+        _pending->loaded.store(true, std::memory_order_release);
+    }
+
+    struct pending
+    {
+        std::atomic<bool> loaded{false};
+        std::mutex lock;
+        byte_vector_t serialized;
+        std::shared_ptr<T> key;
+    };
+    std::shared_ptr<T> _key;
+    std::shared_ptr<pending> _pending;
+};
+
 struct cmp_player_info
 {
     elliptic_curve_point public_share;
-    std::shared_ptr<struct paillier_public_key> paillier;
-    std::shared_ptr<struct ring_pedersen_public> ring_pedersen;
+    lazy_public_key<struct paillier_public_key> paillier;
+    lazy_public_key<struct ring_pedersen_public> ring_pedersen;
 };
 
 struct cmp_key_metadata
@@ -53,6 +113,8 @@ public:
     virtual void load_key(const std::string& key_id, cosigner_sign_algorithm& algorithm, elliptic_curve256_scalar_t& private_key) const = 0;
     virtual const std::string get_tenantid_from_keyid(const std::string& key_id) const = 0;
 
+    // when full_load is set the players paillier and ring pedersen public keys must be loaded, the store can set them using
+    // lazy_public_key::from_serialized so only the keys used by the caller are deserialized
     virtual void load_key_metadata(const std::string& key_id, cmp_key_metadata& metadata, bool full_load) const = 0;
     virtual void load_auxiliary_keys(const std::string& key_id, auxiliary_keys& aux) const = 0;
 };
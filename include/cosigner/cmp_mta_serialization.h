@@ -0,0 +1,213 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include "cosigner/cmp_ecdsa_signing_service.h"
+
+#include <iterator>
+#include <utility>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// Compact binary encoding of the CMP ECDSA MtA rounds messages (a batch of cmp_mta_request, cmp_mta_responses and a batch of cmp_mta_deltas).
+// Every buffer starts with a 4 bytes header (version, message type and 2 reserved bytes), followed by the records count and a table of records offsets,
+// so each record can be accessed directly. All integers are little endian and all variable length fields are prefixed by their uint32_t length.
+// Player indexed maps are encoded as a uint32_t count followed by the entries sorted by player id.
+//
+// The *_view classes validate the whole buffer once on construction (throwing cosigner_exception::INVALID_PARAMETERS if it's malformed) and then
+// access the fields in place, they never copy or allocate and are valid only as long as the underlying buffer is.
+static constexpr const uint8_t CMP_MTA_WIRE_FORMAT_VERSION = 1;
+
+struct const_byte_span
+{
+    const uint8_t* data;
+    uint32_t size;
+
+    byte_vector_t to_vector() const {return byte_vector_t(data, data + size);}
+};
+
+struct cmp_mta_message_view
+{
+    const_byte_span message;
+    const_byte_span commitment;
+    const_byte_span proof;
+
+    cmp_mta_message to_struct() const {return cmp_mta_message{message.to_vector(), commitment.to_vector(), proof.to_vector()};}
+};
+
+namespace wire_format
+{
+// the buffer was already validated when these are called
+
+static inline uint32_t read_uint32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t read_uint64(const uint8_t* p)
+{
+    return (uint64_t)read_uint32(p) | ((uint64_t)read_uint32(p + sizeof(uint32_t)) << 32);
+}
+
+static inline const uint8_t* decode(const uint8_t* p, const_byte_span& out)
+{
+    out.size = read_uint32(p);
+    out.data = p + sizeof(uint32_t);
+    return out.data + out.size;
+}
+
+static inline const uint8_t* decode(const uint8_t* p, cmp_mta_message_view& out)
+{
+    p = decode(p, out.message);
+    p = decode(p, out.commitment);
+    return decode(p, out.proof);
+}
+}
+
+// player id indexed map (T is either const_byte_span or cmp_mta_message_view)
+template<typename T>
+class player_map_view
+{
+public:
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<uint64_t, T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef const value_type& reference;
+
+        iterator(const uint8_t* ptr, uint32_t remaining) : _ptr(ptr), _remaining(remaining) {load();}
+        reference operator*() const {return _value;}
+        pointer operator->() const {return &_value;}
+        iterator& operator++() {_ptr = _next; --_remaining; load(); return *this;}
+        bool operator==(const iterator& other) const {return _remaining == other._remaining;}
+        bool operator!=(const iterator& other) const {return _remaining != other._remaining;}
+
+    private:
+        void load()
+        {
+            if (_remaining)
+            {
+                _value.first = wire_format::read_uint64(_ptr);
+                _next = wire_format::decode(_ptr + sizeof(uint64_t), _value.second);
+            }
+        }
+        const uint8_t* _ptr;
+        const uint8_t* _next = nullptr;
+        uint32_t _remaining;
+        value_type _value = {};
+    };
+
+    player_map_view() : _entries(nullptr), _count(0) {}
+    player_map_view(const uint8_t* entries, uint32_t count) : _entries(entries), _count(count) {}
+
+    uint32_t size() const {return _count;}
+    bool empty() const {return _count == 0;}
+    iterator begin() const {return iterator(_entries, _count);}
+    iterator end() const {return iterator(nullptr, 0);}
+
+    bool find(uint64_t id, T& value) const
+    {
+        for (auto it = begin(); it != end(); ++it)
+        {
+            if (it->first == id)
+            {
+                value = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const uint8_t* _entries;
+    uint32_t _count;
+};
+
+struct cmp_mta_request_view
+{
+    cmp_mta_message_view mta;
+    player_map_view<const_byte_span> mta_proofs;
+    const elliptic_curve256_point_t* A;
+    const elliptic_curve256_point_t* B;
+    const elliptic_curve256_point_t* Z;
+
+    void to_struct(cmp_mta_request& request) const;
+};
+
+struct cmp_mta_response_view
+{
+    player_map_view<cmp_mta_message_view> k_gamma_mta;
+    player_map_view<cmp_mta_message_view> k_x_mta;
+    const elliptic_curve256_point_t* GAMMA;
+    player_map_view<const_byte_span> gamma_proofs;
+
+    void to_struct(cmp_mta_response& response) const;
+};
+
+struct cmp_mta_deltas_view
+{
+    const elliptic_curve256_scalar_t* delta;
+    const elliptic_curve256_point_t* DELTA;
+    const_byte_span proof;
+
+    void to_struct(cmp_mta_deltas& deltas) const;
+};
+
+// base class for the batch views, holds the records offsets table
+class COSIGNER_EXPORT cmp_mta_batch_view
+{
+public:
+    uint32_t size() const {return _count;}
+
+protected:
+    cmp_mta_batch_view(const uint8_t* buffer, size_t size, uint8_t type, size_t prefix_size);
+    const uint8_t* record(uint32_t index) const;
+
+    const uint8_t* _prefix;
+    const uint8_t* _offsets;
+    const uint8_t* _records;
+    uint32_t _count;
+    size_t _records_size;
+};
+
+class COSIGNER_EXPORT cmp_mta_requests_view final : public cmp_mta_batch_view
+{
+public:
+    cmp_mta_requests_view(const uint8_t* buffer, size_t size);
+    cmp_mta_request_view operator[](uint32_t index) const;
+    void to_struct(std::vector<cmp_mta_request>& requests) const;
+};
+
+class COSIGNER_EXPORT cmp_mta_responses_view final : public cmp_mta_batch_view
+{
+public:
+    cmp_mta_responses_view(const uint8_t* buffer, size_t size);
+    const commitments_sha256_t& ack() const {return *reinterpret_cast<const commitments_sha256_t*>(_prefix);}
+    cmp_mta_response_view operator[](uint32_t index) const;
+    void to_struct(cmp_mta_responses& responses) const;
+};
+
+class COSIGNER_EXPORT cmp_mta_deltas_batch_view final : public cmp_mta_batch_view
+{
+public:
+    cmp_mta_deltas_batch_view(const uint8_t* buffer, size_t size);
+    cmp_mta_deltas_view operator[](uint32_t index) const;
+    void to_struct(std::vector<cmp_mta_deltas>& deltas) const;
+};
+
+// These functions serialize the messages into buffer (overriding it's content) using a single allocation
+COSIGNER_EXPORT void serialize_mta_requests(const std::vector<cmp_mta_request>& requests, byte_vector_t& buffer);
+COSIGNER_EXPORT void serialize_mta_responses(const cmp_mta_responses& responses, byte_vector_t& buffer);
+COSIGNER_EXPORT void serialize_mta_deltas(const std::vector<cmp_mta_deltas>& deltas, byte_vector_t& buffer);
+
+}
+}
+}
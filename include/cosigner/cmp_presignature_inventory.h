@@ -0,0 +1,118 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+class platform_service;
+
+// Tracks the presignature indices of cmp_ecdsa_offline_signing_service per key. Each key has capacity slots (the total_count passed to
+// start_ecdsa_signature_preprocessing), every slot is free, pending (preprocessing was requested), ready (can be used by ecdsa_sign) or in use.
+// acquire hands out consecutive ready indices atomically, so concurrent signing requests never use the same presignature. An acquired slot
+// is reused for preprocessing only after signing_completed was called, as its data is overwritten by store_presigning_data.
+// When the number of ready and pending slots drops below the low watermark a replenishment request is emitted, its size is based on
+// the consumption rate observed over the last rate_window_ms (using platform_service::now_msec) so it covers lead_time_ms of signing.
+// All players must use the same indices, so only the party coordinating the preprocessing and signing requests should own an inventory.
+class COSIGNER_EXPORT cmp_presignature_inventory final
+{
+public:
+    struct config
+    {
+        uint64_t capacity;      // total number of presignature slots, passed as total_count to start_ecdsa_signature_preprocessing
+        uint64_t low_watermark; // replenish when ready + pending slots drop below this number
+        uint32_t min_batch;     // minimal and maximal number of presignatures requested at once
+        uint32_t max_batch;
+        uint64_t lead_time_ms;  // expected time to complete a preprocessing request
+        uint64_t rate_window_ms;
+    };
+
+    struct replenishment_request
+    {
+        std::string key_id;
+        uint64_t start_index;
+        uint32_t count;
+        uint64_t total_count;
+    };
+
+    // called (not under the inventory lock) when preprocessing should be started, the caller must later call preprocessing_completed or
+    // preprocessing_failed with the same range. If the callback throws the range is freed and requested again on the next replenishment
+    typedef std::function<void(const replenishment_request&)> replenishment_callback;
+
+    cmp_presignature_inventory(const platform_service& service, replenishment_callback callback);
+
+    cmp_presignature_inventory(const cmp_presignature_inventory&) = delete;
+    cmp_presignature_inventory(cmp_presignature_inventory&&) = delete;
+    cmp_presignature_inventory& operator=(const cmp_presignature_inventory&) = delete;
+    cmp_presignature_inventory& operator=(cmp_presignature_inventory&&) = delete;
+
+    // starts tracking key_id, ready_indices are the presignatures already stored (e.g. after restart), throws cosigner_exception::INVALID_PARAMETERS
+    // if the key already exists or the config is invalid. Emits the initial replenishment request
+    void add_key(const std::string& key_id, const config& cfg, const std::vector<uint64_t>& ready_indices = std::vector<uint64_t>());
+    void remove_key(const std::string& key_id);
+
+    // marks count consecutive ready slots as in use and sets start_index to the first of them, the caller should pass it as preprocessed_data_index
+    // to ecdsa_sign. Returns false if there are no count consecutive ready slots, in this case the caller should wait or use online signing
+    bool acquire(const std::string& key_id, uint32_t count, uint64_t& start_index);
+    // frees acquired slots once ecdsa_sign loaded (and deleted) their presignatures
+    void signing_completed(const std::string& key_id, uint64_t start_index, uint32_t count);
+    // returns acquired slots that weren't used (e.g. the signing request was rejected before ecdsa_sign was called) back to the inventory
+    void release(const std::string& key_id, uint64_t start_index, uint32_t count);
+
+    // should be called once store_presigning_data returned for a replenishment request
+    void preprocessing_completed(const std::string& key_id, uint64_t start_index, uint32_t count);
+    void preprocessing_failed(const std::string& key_id, uint64_t start_index, uint32_t count);
+
+    uint64_t available(const std::string& key_id) const;
+    uint64_t pending(const std::string& key_id) const;
+
+private:
+    enum slot_state : uint8_t
+    {
+        SLOT_FREE = 0,
+        SLOT_PENDING,
+        SLOT_READY,
+        SLOT_IN_USE,
+    };
+
+    struct key_inventory
+    {
+        config cfg;
+        std::vector<uint8_t> slots;
+        uint64_t ready;
+        uint64_t pending;
+        uint64_t next_ready;
+        uint64_t next_free;
+        bool replenishing;
+        std::deque<std::pair<uint64_t, uint32_t>> consumption; // (time, count) of the acquires in the rate window
+    };
+
+    key_inventory& get_key(const std::string& key_id);
+    const key_inventory& get_key(const std::string& key_id) const;
+    void set_range(const std::string& key_id, key_inventory& key, uint64_t start_index, uint32_t count, slot_state from, slot_state to);
+    bool find_run(const key_inventory& key, slot_state state, uint64_t from, uint32_t min_count, uint32_t max_count, uint64_t& start, uint32_t& count) const;
+    uint32_t batch_size(key_inventory& key, uint64_t now) const;
+    bool schedule_replenishment(const std::string& key_id, key_inventory& key, replenishment_request& request);
+    void replenish(std::unique_lock<std::mutex>& lock, const std::string& key_id);
+
+    const platform_service& _service;
+    const replenishment_callback _callback;
+
+    mutable std::mutex _lock;
+    std::map<std::string, key_inventory> _keys;
+};
+
+}
+}
+}
@@ -17,6 +17,8 @@ namespace common
 namespace cosigner
 {
 
+class cmp_auxiliary_keys_pool;
+
 struct public_share
 {
     elliptic_curve_point X;
@@ -76,21 +78,39 @@ public:
         virtual void delete_temporary_key_data(const std::string& key_id, bool delete_key = false) = 0;
     };
 
-    cmp_setup_service(platform_service& service, setup_key_persistency& key_persistency) : _service(service), _key_persistency(key_persistency) {}
+    // aux_keys_pool is optional, when set the auxiliary keys are taken from it instead of being generated during setup
+    cmp_setup_service(platform_service& service, setup_key_persistency& key_persistency, cmp_auxiliary_keys_pool* aux_keys_pool = NULL) : 
+        _service(service), _key_persistency(key_persistency), _aux_keys_pool(aux_keys_pool) {}
     void generate_setup_commitments(const std::string& key_id, const std::string& tenant_id, cosigner_sign_algorithm algorithm, const std::vector<uint64_t>& players_ids, uint8_t t, uint64_t ttl, const share_derivation_args& derive_from, commitment& setup_commitment);
     void store_setup_commitments(const std::string& key_id, const std::map<uint64_t, commitment>& commitments, setup_decommitment& decommitment);
     void generate_setup_proofs(const std::string& key_id, const std::map<uint64_t, setup_decommitment>& decommitments, setup_zk_proofs& proofs);
     void verify_setup_proofs(const std::string& key_id, const std::map<uint64_t, setup_zk_proofs>& proofs, std::map<uint64_t, byte_vector_t>& paillier_large_factor_proofs);
     void create_secret(const std::string& key_id, const std::map<uint64_t, std::map<uint64_t, byte_vector_t>>& paillier_large_factor_proofs, std::string& public_key, cosigner_sign_algorithm& algorithm);
 
+    // Batched versions of the setup rounds above, running the setup of many keys (with the same players) in a single message exchange,
+    // the messages are maps from key id to the single key message. Each key still gets its own auxiliary keys and proofs, as sharing them
+    // between keys would link the keys, but the keys are processed concurrently, so the key persistency and platform service must support
+    // concurrent calls for different keys. Each key succeeds or fails on its own: only the keys that succeeded are added to the output map
+    // and the ids of the keys that failed are returned, they should be dropped from the next rounds. No key is ever deleted by the batch,
+    // so a key that failed is left as the single key round leaves it.
+    std::vector<std::string> generate_setup_commitments_batch(const std::vector<std::string>& key_ids, const std::string& tenant_id, cosigner_sign_algorithm algorithm, const std::vector<uint64_t>& players_ids, uint8_t t, uint64_t ttl, 
+        std::map<std::string, commitment>& setup_commitments);
+    std::vector<std::string> store_setup_commitments_batch(const std::map<std::string, std::map<uint64_t, commitment>>& commitments, std::map<std::string, setup_decommitment>& decommitments);
+    std::vector<std::string> generate_setup_proofs_batch(const std::map<std::string, std::map<uint64_t, setup_decommitment>>& decommitments, std::map<std::string, setup_zk_proofs>& proofs);
+    std::vector<std::string> verify_setup_proofs_batch(const std::map<std::string, std::map<uint64_t, setup_zk_proofs>>& proofs, std::map<std::string, std::map<uint64_t, byte_vector_t>>& paillier_large_factor_proofs);
+    std::vector<std::string> create_secret_batch(const std::map<std::string, std::map<uint64_t, std::map<uint64_t, byte_vector_t>>>& paillier_large_factor_proofs, std::map<std::string, std::string>& public_keys, 
+        std::map<std::string, cosigner_sign_algorithm>& algorithms);
+
     void add_user_request(const std::string& key_id, cosigner_sign_algorithm algorithm, const std::string& new_key_id, const std::vector<uint64_t>& players_ids, uint8_t t, add_user_data& data);
     void add_user(const std::string& tenant_id, const std::string& key_id, cosigner_sign_algorithm algorithm, uint8_t t, const std::map<uint64_t, add_user_data>& data, uint64_t ttl, commitment& setup_commitment);
 
+    // generates a new paillier and ring pedersen key pairs
+    static auxiliary_keys create_auxiliary_keys();
+
 private:
     // helpers
     void generate_setup_commitments(const std::string& key_id, const std::string& tenant_id, cosigner_sign_algorithm algorithm, const elliptic_curve256_algebra_ctx_t* algebra, const std::vector<uint64_t>& players_ids, 
         uint8_t t, uint64_t ttl, const elliptic_curve256_scalar_t& key, const elliptic_curve256_point_t* pubkey, commitment& setup_commitment);
-    auxiliary_keys create_auxiliary_keys();
     void serialize_auxiliary_keys(const auxiliary_keys& aux, std::vector<uint8_t>& paillier_public_key, std::vector<uint8_t>& ring_pedersen_public_key);
     void deserialize_auxiliary_keys(uint64_t id, const std::vector<uint8_t>& paillier_public_key, std::shared_ptr<paillier_public_key_t>& paillier, 
         const std::vector<uint8_t>& ring_pedersen_public_key, std::shared_ptr<ring_pedersen_public_t>& ring_pedersen);
@@ -108,6 +128,7 @@ private:
 
     platform_service& _service;
     setup_key_persistency& _key_persistency;
+    cmp_auxiliary_keys_pool* _aux_keys_pool;
 
     static const std::unique_ptr<elliptic_curve256_algebra_ctx_t, void(*)(elliptic_curve256_algebra_ctx_t*)> _secp256k1;
     static const std::unique_ptr<elliptic_curve256_algebra_ctx_t, void(*)(elliptic_curve256_algebra_ctx_t*)> _secp256r1;
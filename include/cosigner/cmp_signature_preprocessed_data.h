@@ -9,13 +9,25 @@ namespace common
 namespace cosigner
 {
 
+// values derived from R, calculated once when the presigning data is stored so ecdsa_sign won't need to do any EC operation
+struct cmp_signature_r_info
+{
+    elliptic_curve256_scalar_t r;           // R.x mod q
+    elliptic_curve256_scalar_t positive_r;  // (positive_r_multiplier * R).x mod q
+    uint8_t v;                              // recovery id of r
+    uint8_t positive_v;                     // recovery id of positive_r
+    uint8_t positive_r_multiplier;          // smallest c for which (c * R).x is positive, 0 means that the values weren't calculated
+    cmp_signature_r_info() {OPENSSL_cleanse(this, sizeof(cmp_signature_r_info));}
+};
+
 struct cmp_signature_preprocessed_data
 {
     elliptic_curve_scalar k;
     elliptic_curve_scalar chi;
     elliptic_curve_point R;
+    cmp_signature_r_info r_info;
 };
 
 }
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include "cosigner/cmp_ecdsa_signing_service.h"
+#include "cosigner/cmp_signature_preprocessed_data.h"
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// Canonical persistence format of the CMP ECDSA presigning state, to be used by preprocessing_persistency implementations.
+// Both formats start with a 4 bytes header (version, type and 2 reserved bytes) followed by a fixed size region holding all the secret
+// scalars, so the secrets can be encrypted in place (or stored separately) without parsing the rest of the buffer.
+// All integers are little endian. The serialized buffers contain secrets, the caller is responsible to cleanse them after use.
+static constexpr const uint8_t CMP_SIGNING_DATA_FORMAT_VERSION = 1;
+static constexpr const size_t CMP_SIGNING_DATA_SECRET_OFFSET = 4;
+
+// ecdsa_signing_data layout:
+// header | k | gamma | a | b | delta | chi | GAMMA | mta_request | G_proofs | public_data
+// where mta_request is length prefixed, G_proofs is a count followed by (player id, length prefixed proof) entries and
+// public_data is a count followed by (player id, A, B, Z, GAMMA, length prefixed gamma_commitment) entries, both sorted by player id
+static constexpr const size_t CMP_ECDSA_SIGNING_DATA_SECRET_SIZE = 6 * sizeof(elliptic_curve256_scalar_t);
+
+// cmp_signature_preprocessed_data layout, fixed size:
+// header | k | chi | R | r | positive_r | v | positive_v | positive_r_multiplier
+static constexpr const size_t CMP_SIGNATURE_PREPROCESSED_DATA_SECRET_SIZE = 2 * sizeof(elliptic_curve256_scalar_t);
+static constexpr const size_t CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE = CMP_SIGNING_DATA_SECRET_OFFSET + CMP_SIGNATURE_PREPROCESSED_DATA_SECRET_SIZE +
+    sizeof(elliptic_curve256_point_t) + 2 * sizeof(elliptic_curve256_scalar_t) + 3;
+
+// serializes data into buffer (overriding it's content) using a single allocation
+COSIGNER_EXPORT void serialize_ecdsa_signing_data(const ecdsa_signing_data& data, byte_vector_t& buffer);
+// throws cosigner_exception::INVALID_PARAMETERS if the buffer is malformed
+COSIGNER_EXPORT void deserialize_ecdsa_signing_data(const uint8_t* buffer, size_t size, ecdsa_signing_data& data);
+
+// buffer must be at least CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE bytes long
+COSIGNER_EXPORT void serialize_signature_preprocessed_data(const cmp_signature_preprocessed_data& data, uint8_t* buffer, size_t size);
+// throws cosigner_exception::INVALID_PARAMETERS if the buffer is malformed
+COSIGNER_EXPORT void deserialize_signature_preprocessed_data(const uint8_t* buffer, size_t size, cmp_signature_preprocessed_data& data);
+
+}
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "cosigner_export.h"
+
+#include "cosigner/types.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+struct cmp_signature_preprocessed_data;
+
+// Reference implementation of the preprocessed data part of cmp_ecdsa_offline_signing_service::preprocessing_persistency
+// (create/store/load/delete_preprocessed_data), preprocessing_persistency implementations can forward these calls to it.
+//
+// Each key is stored in its own file under directory, holding a header, a bitmap with a bit per slot and an array of fixed size records
+// (see cmp_signing_data_serialization.h). The file is allocated in full when created and memory mapped, so storing or loading a record is O(1).
+// The store is crash consistent: a slot bit is set only after its record was synced to disk and load_preprocessed_data clears and syncs
+// the bit before returning the record, so a presignature can never be returned twice, even if the process crashes.
+// The file is exclusively locked while the store uses it and created with 0600 permissions, note that the records aren't encrypted.
+class COSIGNER_EXPORT mmap_preprocessed_data_store final
+{
+public:
+    // directory must exist
+    explicit mmap_preprocessed_data_store(const std::string& directory);
+    ~mmap_preprocessed_data_store();
+
+    mmap_preprocessed_data_store(const mmap_preprocessed_data_store&) = delete;
+    mmap_preprocessed_data_store(mmap_preprocessed_data_store&&) = delete;
+    mmap_preprocessed_data_store& operator=(const mmap_preprocessed_data_store&) = delete;
+    mmap_preprocessed_data_store& operator=(mmap_preprocessed_data_store&&) = delete;
+
+    // allocates size slots for key_id, throws cosigner_exception::INVALID_TRANSACTION if key_id already exists with a different size
+    void create_preprocessed_data(const std::string& key_id, uint64_t size);
+    // throws cosigner_exception::INVALID_PRESIGNING_INDEX if index is out of range
+    void store_preprocessed_data(const std::string& key_id, uint64_t index, const cmp_signature_preprocessed_data& data);
+    // loads and deletes the data at index, throws cosigner_exception::INVALID_PRESIGNING_INDEX if index is out of range or the slot is empty
+    void load_preprocessed_data(const std::string& key_id, uint64_t index, cmp_signature_preprocessed_data& data);
+    void delete_preprocessed_data(const std::string& key_id);
+
+    // returns the number of stored (not yet loaded) records
+    uint64_t count(const std::string& key_id);
+
+private:
+    struct mapped_file;
+
+    static std::shared_ptr<mapped_file> map_file(const std::string& path, int fd);
+    std::shared_ptr<mapped_file> get_file(const std::string& key_id);
+    std::string file_path(const std::string& key_id) const;
+
+    const std::string _directory;
+    std::mutex _lock;
+    std::map<std::string, std::shared_ptr<mapped_file>> _files;
+};
+
+}
+}
+}
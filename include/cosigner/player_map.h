@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// A map from player id to T, stored as a vector sorted by player id. As the number of players is small (usually 2-10) this is much more
+// cache friendly than std::map and requires a single allocation. It's meant for the per player state built inside a protocol round, the
+// public structures keep using std::map. The interface is only a subset of std::map interface and unlike std::map, like std::vector,
+// inserting or erasing an element INVALIDATES ALL the iterators and references to the map elements (including operator[] of a new id),
+// so create all the entries before taking references to them.
+template<typename T>
+class player_map
+{
+public:
+    typedef uint64_t key_type;
+    typedef T mapped_type;
+    typedef std::pair<uint64_t, T> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+    typedef typename std::vector<value_type>::size_type size_type;
+
+    player_map() = default;
+    player_map(std::initializer_list<value_type> init)
+    {
+        for (auto it = init.begin(); it != init.end(); ++it)
+            insert(*it);
+    }
+
+    iterator begin() {return _data.begin();}
+    iterator end() {return _data.end();}
+    const_iterator begin() const {return _data.begin();}
+    const_iterator end() const {return _data.end();}
+    const_iterator cbegin() const {return _data.cbegin();}
+    const_iterator cend() const {return _data.cend();}
+
+    size_type size() const {return _data.size();}
+    bool empty() const {return _data.empty();}
+    void clear() {_data.clear();}
+    void reserve(size_type size) {_data.reserve(size);}
+
+    iterator find(uint64_t id)
+    {
+        auto it = lower_bound(id);
+        return (it != _data.end() && it->first == id) ? it : _data.end();
+    }
+    const_iterator find(uint64_t id) const
+    {
+        auto it = lower_bound(id);
+        return (it != _data.end() && it->first == id) ? it : _data.end();
+    }
+    size_type count(uint64_t id) const {return find(id) != end() ? 1 : 0;}
+
+    T& at(uint64_t id)
+    {
+        auto it = find(id);
+        if (it == _data.end())
+            throw std::out_of_range("player_map::at");
+        return it->second;
+    }
+    const T& at(uint64_t id) const
+    {
+        auto it = find(id);
+        if (it == _data.end())
+            throw std::out_of_range("player_map::at");
+        return it->second;
+    }
+
+    T& operator[](uint64_t id)
+    {
+        auto it = lower_bound(id);
+        if (it == _data.end() || it->first != id)
+            it = _data.emplace(it, std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+        return it->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        auto it = lower_bound(value.first);
+        if (it != _data.end() && it->first == value.first)
+            return std::make_pair(it, false);
+        return std::make_pair(_data.insert(it, value), true);
+    }
+
+    template<typename... ARGS>
+    std::pair<iterator, bool> emplace(uint64_t id, ARGS&&... args)
+    {
+        auto it = lower_bound(id);
+        if (it != _data.end() && it->first == id)
+            return std::make_pair(it, false);
+        return std::make_pair(_data.emplace(it, std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple(std::forward<ARGS>(args)...)), true);
+    }
+
+    size_type erase(uint64_t id)
+    {
+        auto it = find(id);
+        if (it == _data.end())
+            return 0;
+        _data.erase(it);
+        return 1;
+    }
+    iterator erase(const_iterator pos) {return _data.erase(pos);}
+
+    bool operator==(const player_map& other) const {return _data == other._data;}
+    bool operator!=(const player_map& other) const {return _data != other._data;}
+
+private:
+    iterator lower_bound(uint64_t id)
+    {
+        return std::lower_bound(_data.begin(), _data.end(), id, [](const value_type& val, uint64_t key) {return val.first < key;});
+    }
+    const_iterator lower_bound(uint64_t id) const
+    {
+        return std::lower_bound(_data.begin(), _data.end(), id, [](const value_type& val, uint64_t key) {return val.first < key;});
+    }
+
+    std::vector<value_type> _data;
+};
+
+}
+}
+}
@@ -33,6 +33,8 @@ COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_verify_linear_co
     uint32_t points_count, uint8_t *result);
 /* Returns g^exp on the curve, exp must be smaller than the group order */
 COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_generator_mul(const GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exp);
+/* Computes res[i] = g^exps[i] for count scalars, the scalars are reduced modulo the group order and all the points are normalized with a single field inversion */
+COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_generator_mul_batch(const GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exps, uint32_t count);
 /* Adds p1 and p2 points on the curve */
 COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_add_points(const GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p1, const elliptic_curve256_point_t *p2);
 /* Computes p^exp on the curve where p is an arbitrary point in the curve */
@@ -47,6 +49,9 @@ COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_sub_scalars(GFp_
 COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_mul_scalars(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len);
 /* Calculates val ^ -1 modulo the group order */
 COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_inverse(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *val);
+/* Calculates res[i] = vals[i] ^ -1 modulo the group order for count values using a single inversion, res may be vals.
+ * Set constant_time when the values are secret. Fails with ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR if any of the values is 0 */
+COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_batch_inverse(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time);
 /* Returns the positive (unsigned) value of val modulo the group order, e.g. if val > field/2 return -val */
 COSIGNER_EXPORT elliptic_curve_algebra_status GFp_curve_algebra_abs(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *val);
 /* Returns a random number modulo the group order */
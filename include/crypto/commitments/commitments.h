@@ -34,6 +34,11 @@ COSIGNER_EXPORT commitments_status commitments_create_commitment_for_data(const
 /* Verfies the data commitment (SHA256) */
 COSIGNER_EXPORT commitments_status commitments_verify_commitment(const uint8_t *data, uint32_t data_len, const commitments_commitment_t *commitment);
 
+/* Batch versions of the above for count independent data buffers, the hashes are computed using sha256_batch.
+   commitments_verify_commitments_batch returns COMMITMENTS_INVALID_COMMITMENT if any of the commitments is invalid */
+COSIGNER_EXPORT commitments_status commitments_create_commitments_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, commitments_commitment_t *commitments);
+COSIGNER_EXPORT commitments_status commitments_verify_commitments_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, const commitments_commitment_t *commitments);
+
 /* Commitment context functions are usfull to create/verify commitment on scattered data */
 
 /* Creates commitment context */
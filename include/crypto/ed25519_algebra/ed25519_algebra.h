@@ -39,6 +39,12 @@ COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_verify_linear_comb
     uint32_t points_count, uint8_t *result);
 /* Returns g^exp over the ed25519 curve, exp must be inside ED25519_FIELD */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_generator_mul(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_scalar_t *exp);
+/* Computes res[i] = g^exps[i] over the ed25519 curve, the big endian scalars are reduced modulo ED25519_FIELD and all the points are encoded with a single field inversion */
+COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_generator_mul_batch(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_scalar_t *exps, uint32_t count);
+/* Computes g^generator_exp * sum(points[i]^exps[i]) over the ed25519 curve, generator_exp may be NULL. The scalars are little endian and must be smaller than 2^255
+   and the points must be in the prime order subgroup. Runs in variable time, so it must be used only with public values (e.g. for batch verification) */
+COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_multi_point_mul_vartime(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_le_scalar_t *generator_exp, 
+    const ed25519_point_t *points, const ed25519_le_scalar_t *exps, uint32_t count);
 /* Adds p1 and p2 points over the ed25519 curve */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_add_points(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_point_t *p1, const ed25519_point_t *p2);
 /* Computes p^exp over the ed25519 curve */
@@ -53,6 +59,9 @@ COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_mul_scalars(const
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_add_le_scalars(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *res, const ed25519_le_scalar_t *a, const ed25519_le_scalar_t *b);
 /* Calculates val ^ -1 over the ed25519 order */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_inverse(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const ed25519_scalar_t *val);
+/* Calculates res[i] = vals[i] ^ -1 over the ed25519 order for count values using a single inversion, res may be vals.
+ * The computation is always constant time, constant_time is ignored. Fails with ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR if any of the values is 0 */
+COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_batch_inverse(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const ed25519_scalar_t *vals, uint32_t count, uint8_t constant_time);
 /* Returns a random number over the ed25519 order */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_rand(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res);
 /* Computes s % ED25519_FIELD */
@@ -65,6 +74,8 @@ COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_le_to_be(ed25519_s
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_be_to_le(ed25519_le_scalar_t *res, const ed25519_scalar_t *n);
 /* Calculates H(RAM) the hash of R || public key || message and reduces the result to ed25519 field */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_calc_hram(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *hram, const ed25519_point_t *R, const ed25519_point_t *public_key, const uint8_t *message, uint32_t message_size, uint8_t use_keccak);
+/* Calculates hrams[i] = H(RAM) of Rs[i] || public_keys[i] || messages[i] for count blocks, the keccak hashes are computed in parallel lanes when the CPU supports it */
+COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_calc_hram_batch(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *hrams, const ed25519_point_t *Rs, const ed25519_point_t *public_keys, const uint8_t **messages, const uint32_t *message_sizes, uint32_t count, uint8_t use_keccak);
 /* Signs the message using the private key directly (without diriving the private key from the private seed) */
 COSIGNER_EXPORT elliptic_curve_algebra_status ed25519_algebra_sign(const ed25519_algebra_ctx_t *ctx, const ed25519_scalar_t *private_key, const uint8_t *message, uint32_t message_size, uint8_t use_keccak, uint8_t signature[64]);
 /* Verifies the signature using the message and public_key key */
@@ -34,12 +34,14 @@ typedef elliptic_curve_algebra_status (*elliptic_curve256_verify_linear_combinat
     const elliptic_curve256_scalar_t *coefficients, uint32_t points_count, uint8_t *result);
 
 typedef elliptic_curve_algebra_status (*elliptic_curve256_generator_mul)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exp);
+typedef elliptic_curve_algebra_status (*elliptic_curve256_generator_mul_batch)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exps, uint32_t count);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_add_points)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p1, const elliptic_curve256_point_t *p2);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_point_mul)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p, const elliptic_curve256_scalar_t *exp);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_add_scalars)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_sub_scalars)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_mul_scalars)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_inverse)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *val);
+typedef elliptic_curve_algebra_status (*elliptic_curve256_batch_inverse)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_rand)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res);
 typedef elliptic_curve_algebra_status (*elliptic_curve256_reduce)(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *val);
 
@@ -72,6 +74,13 @@ typedef struct elliptic_curve256_algebra_ctx
 
     /* Returns the internal represantation of group order */
     const struct bignum_st *(*order_internal)(const struct elliptic_curve256_algebra_ctx *ctx);
+
+    /* Computes res[i] = g^exps[i] for count scalars (reduced modulo the group order like generator_mul_data), the points share a single field inversion for the normalization */
+    elliptic_curve256_generator_mul_batch generator_mul_batch;
+
+    /* Computes res[i] = vals[i]^-1 modulo the group order for count scalars using montgomery's trick (a single inversion), res may be vals.
+     * Set constant_time when the values are secret, the GFp curves then use constant time BIGNUM operations and blind the product (ed25519 is always constant time) */
+    elliptic_curve256_batch_inverse batch_inverse;
 } elliptic_curve256_algebra_ctx_t;
 
 COSIGNER_EXPORT elliptic_curve256_algebra_ctx_t *elliptic_curve256_new_secp256k1_algebra();
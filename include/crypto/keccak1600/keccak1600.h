@@ -28,6 +28,35 @@ COSIGNER_EXPORT int keccak1600_init(KECCAK1600_CTX *ctx, size_t md_size_in_bits,
 COSIGNER_EXPORT int keccak1600_update(KECCAK1600_CTX *ctx, const uint8_t *inp, size_t len);
 COSIGNER_EXPORT int keccak1600_final(KECCAK1600_CTX *ctx, unsigned char *md);
 
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+} keccak1600_batch_buffer_t;
+
+/* A message is the concatenation of its parts, like calling keccak1600_update for each part */
+typedef struct
+{
+    const keccak1600_batch_buffer_t *parts;
+    uint32_t parts_count;
+} keccak1600_batch_message_t;
+
+typedef enum
+{
+    KECCAK1600_BATCH_IMPL_AUTO     = 0,
+    KECCAK1600_BATCH_IMPL_SCALAR   = 1, /* one message at a time using keccak1600_update */
+    KECCAK1600_BATCH_IMPL_AVX2     = 2, /* 4 messages in parallel, x86_64 only */
+    KECCAK1600_BATCH_IMPL_AVX512   = 3, /* 8 messages in parallel, x86_64 only */
+} keccak1600_batch_impl;
+
+/* Hashes count independent messages with the same digest size and padding, the digest of messages[i] is stored at mds + i * md_size_in_bits / 8.
+   md_size_in_bits must be a multiple of 32 between 128 and 512. The implementation is selected at runtime by the CPU features.
+   Returns 1 on success and 0 if the parameters are invalid (or the implementation isn't supported by the CPU) */
+COSIGNER_EXPORT int keccak1600_batch(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds);
+COSIGNER_EXPORT int keccak1600_batch_with_impl(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds, keccak1600_batch_impl impl);
+/* Returns the implementation keccak1600_batch uses on this CPU */
+COSIGNER_EXPORT keccak1600_batch_impl keccak1600_batch_default_impl(void);
+
 #ifdef __cplusplus
 }
 #endif //__cplusplus
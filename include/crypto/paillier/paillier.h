@@ -13,6 +13,9 @@ typedef struct paillier_public_key paillier_public_key_t;
 typedef struct paillier_private_key paillier_private_key_t;
 typedef struct paillier_ciphertext paillier_ciphertext_t;
 
+typedef void (*paillier_task_t)(void *arg, uint32_t index);
+typedef void (*paillier_parallel_for_t)(void *executor, uint32_t count, paillier_task_t task, void *arg);
+
 #define PAILLIER_SUCCESS 0
 #define PAILLIER_ERROR_UNKNOWN 1
 #define PAILLIER_ERROR_KEYLEN_TOO_SHORT 2
@@ -39,6 +42,10 @@ COSIGNER_EXPORT long paillier_generate_coprime_zkp(const paillier_private_key_t
 COSIGNER_EXPORT long paillier_verify_coprime_zkp(const paillier_public_key_t *pub, const uint8_t *aad, uint32_t aad_len, const uint8_t *y, uint32_t y_len);
 
 COSIGNER_EXPORT long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, const uint8_t *aad, uint32_t aad_len, uint8_t *serialized_proof, uint32_t proof_len, uint32_t *proof_real_len);
+// same as paillier_generate_paillier_blum_zkp, but the independent proof rounds are run by parallel_for, which must call task(arg, i) for every i in [0, count)
+// (possibly concurrently) and return after all the calls completed. The library doesn't create threads itself, so the caller keeps its own threads policy
+COSIGNER_EXPORT long paillier_generate_paillier_blum_zkp_parallel(const paillier_private_key_t *priv, const uint8_t *aad, uint32_t aad_len, uint8_t *serialized_proof, uint32_t proof_len, uint32_t *proof_real_len,
+    paillier_parallel_for_t parallel_for, void *executor);
 COSIGNER_EXPORT long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const uint8_t *aad, uint32_t aad_len, const uint8_t *serialized_proof, uint32_t proof_len);
 
 COSIGNER_EXPORT long paillier_public_key_n(const paillier_public_key_t *pub, uint8_t *n, uint32_t n_len, uint32_t *n_real_len);
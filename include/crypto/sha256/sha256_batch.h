@@ -0,0 +1,55 @@
+#ifndef __SHA256_BATCH_H__
+#define __SHA256_BATCH_H__
+
+#include "cosigner_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+#include <stdint.h>
+
+typedef uint8_t sha256_md_t[32];
+
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t len;
+} sha256_batch_buffer_t;
+
+/* A message is the concatenation of its parts, like calling SHA256_Update for each part */
+typedef struct
+{
+    const sha256_batch_buffer_t *parts;
+    uint32_t parts_count;
+} sha256_batch_message_t;
+
+typedef enum
+{
+    SHA256_BATCH_SUCCESS               =  0,
+    SHA256_BATCH_INVALID_PARAMETER     = -1,
+    SHA256_BATCH_NOT_SUPPORTED         = -2,
+} sha256_batch_status;
+
+typedef enum
+{
+    SHA256_BATCH_IMPL_AUTO                = 0,
+    SHA256_BATCH_IMPL_OPENSSL             = 1, /* one message at a time, openssl uses SHA-NI/AVX2 when available */
+    SHA256_BATCH_IMPL_MULTI_BUFFER        = 2, /* 8 messages in parallel using AVX2, x86_64 only */
+    SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512 = 3, /* 16 messages in parallel using AVX-512, x86_64 only */
+} sha256_batch_impl;
+
+/* Hashes count independent messages, digests[i] is the SHA256 of messages[i].
+   The implementation is selected at runtime: CPUs with SHA-NI hash faster one message at a time, so the multi buffer implementations are used
+   only on AVX-512/AVX2 CPUs without SHA-NI and when there are enough messages to fill the lanes */
+COSIGNER_EXPORT sha256_batch_status sha256_batch(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests);
+/* Same as sha256_batch but with a specific implementation, returns SHA256_BATCH_NOT_SUPPORTED if the CPU doesn't support it */
+COSIGNER_EXPORT sha256_batch_status sha256_batch_with_impl(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests, sha256_batch_impl impl);
+/* Returns the implementation sha256_batch uses for large batches on this CPU */
+COSIGNER_EXPORT sha256_batch_impl sha256_batch_default_impl(void);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+
+#endif // __SHA256_BATCH_H__
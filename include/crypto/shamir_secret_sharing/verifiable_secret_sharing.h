@@ -67,10 +67,22 @@ COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_get_p
  * if shares_count is less then the needed t shares wrong secret will be generated */
 COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_reconstruct(const elliptic_curve256_algebra_ctx_t *algebra, const shamir_secret_share_t *shares, uint8_t shares_count, uint8_t *secret, uint32_t secret_len, uint32_t *out_secret_len);
 
+/* Returns the lagrange coefficients for reconstructing the secret from the shares of ids, coefficients[i] is the coefficient of ids[i].
+ * The coefficients are cached per curve and (sorted) ids set, so repeating signer sets don't recompute them */
+COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_get_lagrange_coefficients(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, uint8_t ids_count, elliptic_curve256_scalar_t *coefficients);
+/* Frees all the cached lagrange coefficients */
+COSIGNER_EXPORT void verifiable_secret_sharing_clear_lagrange_cache(void);
+
 /* Verifies that share proof for share id id, is a vaild share for polynom represented by coefficient_proofs
  * The share proof it self should be authenticated using secp256k1_algebra_verify function 
  * each share proof and coefficient proof should be verified using the pre given commitments and the verifiable_secret_sharing_verify_commitment func */
 COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_verify_share(const elliptic_curve256_algebra_ctx_t *algebra, uint64_t id, const elliptic_curve256_point_t *share_proof, uint8_t threshold, const elliptic_curve256_point_t *coefficient_proofs);
+/* Verifies count shares at once, share_proofs[i] is the proof of share id ids[i] and coefficient_proofs[i * threshold .. (i + 1) * threshold - 1] are the proofs of its dealer polynom.
+ * All the shares are checked together with a random linear combination in a single multi scalar multiplication where shares of the same dealer (equal coefficient proofs)
+ * share the coefficient proofs multiplications, if the check fails the batch is bisected
+ * and the index of the first invalid share is returned via the optional invalid_index */
+COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_verify_shares_batch(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, const elliptic_curve256_point_t *share_proofs, uint32_t count, 
+    uint8_t threshold, const elliptic_curve256_point_t *coefficient_proofs, uint32_t *invalid_index);
 /* Verfies the proofs commitment (SHA256) */
 COSIGNER_EXPORT verifiable_secret_sharing_status verifiable_secret_sharing_verify_commitment(const elliptic_curve256_point_t *proofs, uint8_t proofs_count, const commitments_commitment_t *commitment);
 
@@ -19,6 +19,21 @@ extern "C" {
 
 COSIGNER_EXPORT void cosigner_log_init(cosigner_log_callback cb, void* userp);
 
+// messages with level lower then the minimum level are dropped by the LOG macros before formatting them, the default is 0 (log everything)
+COSIGNER_EXPORT void cosigner_log_set_min_level(int level);
+COSIGNER_EXPORT int cosigner_log_get_min_level(void);
+// don't access directly, use cosigner_log_set_min_level
+COSIGNER_EXPORT extern int cosigner_log_min_level;
+
+// Starts delivering the messages to the callback from a background thread. Each message is formatted by the calling thread into a slot
+// of a lock free ring buffer of slots_count slots (must be a power of 2), so it never waits for the callback.
+// If all the slots are in use the message is dropped, the number of dropped messages is reported by the background thread. ERROR and FATAL
+// messages are never dropped, they are delivered synchronously instead.
+// Returns 0 on success, or -1 if the parameter is invalid, the background thread is already running or failed to start
+COSIGNER_EXPORT int cosigner_log_async_start(unsigned int slots_count);
+// Delivers the queued messages and stops the background thread, the messages logged afterwards are delivered synchronously
+COSIGNER_EXPORT void cosigner_log_async_stop(void);
+
 COSIGNER_EXPORT void cosigner_log_msg(int level, const char* file, int line, const char* func, const char* message, ...)
     __attribute__ ((format (printf, 5, 6)));
 
@@ -26,7 +41,11 @@ COSIGNER_EXPORT void cosigner_log_msg(int level, const char* file, int line, con
 }
 #endif //__cplusplus
 
-#define LOG(level, message, ...) cosigner_log_msg((level), __FILE__, __LINE__, __func__, (message), ##__VA_ARGS__)
+#define LOG(level, message, ...) \
+    do { \
+        if ((level) >= __atomic_load_n(&cosigner_log_min_level, __ATOMIC_RELAXED)) \
+            cosigner_log_msg((level), __FILE__, __LINE__, __func__, (message), ##__VA_ARGS__); \
+    } while (0)
 #define LOG_TRACE(message, ...)  LOG(COSIGNER_LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
 #define LOG_DEBUG(message, ...)  LOG(COSIGNER_LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
 #define LOG_INFO(message, ...)   LOG(COSIGNER_LOG_LEVEL_INFO,  message, ##__VA_ARGS__)
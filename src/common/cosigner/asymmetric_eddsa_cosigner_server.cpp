@@ -8,8 +8,11 @@
 
 #include <openssl/sha.h>
 #include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
 
 #include <inttypes.h>
+#include <memory>
 
 namespace fireblocks
 {
@@ -18,6 +21,8 @@ namespace common
 namespace cosigner
 {
 
+static const size_t BATCH_COEFFICIENT_SIZE = 16;
+
 class ed25519_scalar_cleaner
 {
 public:
@@ -27,6 +32,92 @@ private:
     ed25519_scalar_t& _secret;
 };
 
+struct block_verification_data
+{
+    ed25519_le_scalar_t hram;
+    ed25519_scalar_t delta;
+    ed25519_point_t derived_public_key;
+};
+
+// ED25519_FIELD - 1 in little endian
+static const ed25519_le_scalar_t ED25519_MINUS_ONE = {
+    0xec, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10};
+static const ed25519_le_scalar_t ED25519_ZERO = {0};
+static const ed25519_point_t ED25519_IDENTITY = {1};
+
+// The batch verifications multiply each block equation by a random 128 bit coefficient and check that the sum of the equations holds
+// using a single multi scalar multiplication, a batch containing an invalid equation passes with probability of 2^-128
+static void random_coefficient(ed25519_le_scalar_t& z)
+{
+    memset(z, 0, sizeof(ed25519_le_scalar_t));
+    if (!RAND_bytes(z, BATCH_COEFFICIENT_SIZE))
+    {
+        LOG_ERROR("Failed to get random number, error %lu", ERR_get_error());
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+}
+
+// verifies s[i]*G == R[i] + hram[i]*(public_share + delta[i]*G) for all blocks, by checking that
+// sum(z[i]*R[i]) + sum(z[i]*hram[i])*public_share + (sum(z[i]*hram[i]*delta[i]) - sum(z[i]*s[i]))*G is the identity
+static bool verify_client_s_batch(const ed25519_algebra_ctx_t* ctx, const std::vector<eddsa_signature>& partial_sigs, const std::vector<block_verification_data>& blocks, const elliptic_curve_point& public_share)
+{
+    const size_t count = partial_sigs.size();
+    std::unique_ptr<ed25519_point_t[]> points(new ed25519_point_t[count + 1]);
+    std::unique_ptr<ed25519_le_scalar_t[]> exps(new ed25519_le_scalar_t[count + 1]);
+    ed25519_le_scalar_t generator_exp = {0};
+    ed25519_le_scalar_t& public_share_exp = exps[count];
+    memset(public_share_exp, 0, sizeof(ed25519_le_scalar_t));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        ed25519_le_scalar_t zhram, tmp;
+        ed25519_le_large_scalar_t s = {0};
+        random_coefficient(exps[i]);
+        memcpy(points[i], partial_sigs[i].R, sizeof(ed25519_point_t));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &zhram, &exps[i], &blocks[i].hram, &ED25519_ZERO));
+        throw_cosigner_exception(ed25519_algebra_add_le_scalars(ctx, &public_share_exp, &public_share_exp, &zhram));
+        throw_cosigner_exception(ed25519_algebra_be_to_le(&tmp, &blocks[i].delta));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &generator_exp, &zhram, &tmp, &generator_exp));
+
+        // s isn't necessarily reduced
+        throw_cosigner_exception(ed25519_algebra_be_to_le((ed25519_le_scalar_t*)&s, &partial_sigs[i].s));
+        throw_cosigner_exception(ed25519_algebra_reduce(ctx, &tmp, &s));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &tmp, &exps[i], &tmp, &ED25519_ZERO));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &generator_exp, &tmp, &ED25519_MINUS_ONE, &generator_exp));
+    }
+    memcpy(points[count], public_share.data, sizeof(ed25519_point_t));
+
+    ed25519_point_t res;
+    throw_cosigner_exception(ed25519_algebra_multi_point_mul_vartime(ctx, &res, &generator_exp, points.get(), exps.get(), count + 1));
+    return memcmp(res, ED25519_IDENTITY, sizeof(ed25519_point_t)) == 0;
+}
+
+// verifies s[i]*G == R[i] + hram[i]*derived_public_key[i] for all blocks, where s[i] is little endian, by checking that
+// sum(z[i]*R[i]) + sum(z[i]*hram[i]*derived_public_key[i]) - sum(z[i]*s[i])*G is the identity
+static bool verify_signatures_batch(const ed25519_algebra_ctx_t* ctx, const std::vector<eddsa_signature>& sigs, const std::vector<block_verification_data>& blocks)
+{
+    const size_t count = sigs.size();
+    std::unique_ptr<ed25519_point_t[]> points(new ed25519_point_t[2 * count]);
+    std::unique_ptr<ed25519_le_scalar_t[]> exps(new ed25519_le_scalar_t[2 * count]);
+    ed25519_le_scalar_t generator_exp = {0};
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        ed25519_le_scalar_t tmp;
+        random_coefficient(exps[i]);
+        memcpy(points[i], sigs[i].R, sizeof(ed25519_point_t));
+        memcpy(points[count + i], blocks[i].derived_public_key, sizeof(ed25519_point_t));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &exps[count + i], &exps[i], &blocks[i].hram, &ED25519_ZERO));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &tmp, &exps[i], &sigs[i].s, &ED25519_ZERO));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ctx, &generator_exp, &tmp, &ED25519_MINUS_ONE, &generator_exp));
+    }
+
+    ed25519_point_t res;
+    throw_cosigner_exception(ed25519_algebra_multi_point_mul_vartime(ctx, &res, &generator_exp, points.get(), exps.get(), 2 * count));
+    return memcmp(res, ED25519_IDENTITY, sizeof(ed25519_point_t)) == 0;
+}
+
 asymmetric_eddsa_cosigner_server::signing_persistency::~signing_persistency()
 {
 }
@@ -377,7 +468,8 @@ uint64_t asymmetric_eddsa_cosigner_server::broadcast_si(const std::string& txid,
         LOG_INFO("My id %" PRIu64 " is the min id, will add client s to my s", my_id);
     }
 
-    sigs.reserve(data.sig_data.size());
+    std::vector<block_verification_data> blocks(partial_sigs.size());
+    sigs.resize(data.sig_data.size());
     for (size_t i = 0; i < partial_sigs.size(); ++i)
     {
         eddsa_commitment commitment;
@@ -387,24 +479,40 @@ uint64_t asymmetric_eddsa_cosigner_server::broadcast_si(const std::string& txid,
             LOG_ERROR("Failed to verify commitment from player %" PRIu64 " to block %lu", sender, i);
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
-        eddsa_signature sig;
-        throw_cosigner_exception(ed25519_algebra_add_points(ed25519, &sig.R, (ed25519_point_t*)&data.sig_data[i].R.data, &partial_sigs[i].R));
-
-        ed25519_point_t derived_public_key;
-        ed25519_scalar_t delta;
-        derivation_key_delta(metadata.public_key, data.chaincode, data.sig_data[i].path, data.signers_ids.size(), delta, derived_public_key);
-        ed25519_le_scalar_t hram;
-        throw_cosigner_exception(ed25519_calc_hram(ed25519, &hram, &sig.R, &derived_public_key, (const uint8_t*)data.sig_data[i].message.data(), data.sig_data[i].message.size(), data.sig_data[i].flags & EDDSA_KECCAK));
-        if (!verify_client_s(partial_sigs[i].R, partial_sigs[i].s, hram, sender_info->second.public_share, delta))
+        if (partial_sigs[i].s[0] & 0x80)
         {
-            LOG_ERROR("Failed to verify the signature s sent by client %" PRIu64 " for block %lu txid %s", sender, i, txid.c_str());
+            LOG_ERROR("Invalid signature s sent by client %" PRIu64 " for block %lu txid %s", sender, i, txid.c_str());
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
+        throw_cosigner_exception(ed25519_algebra_add_points(ed25519, &sigs[i].R, (ed25519_point_t*)&data.sig_data[i].R.data, &partial_sigs[i].R));
+
+        derivation_key_delta(metadata.public_key, data.chaincode, data.sig_data[i].path, data.signers_ids.size(), blocks[i].delta, blocks[i].derived_public_key);
+        throw_cosigner_exception(ed25519_calc_hram(ed25519, &blocks[i].hram, &sigs[i].R, &blocks[i].derived_public_key, (const uint8_t*)data.sig_data[i].message.data(), data.sig_data[i].message.size(), data.sig_data[i].flags & EDDSA_KECCAK));
+    }
+
+    if (!verify_client_s_batch(ed25519, partial_sigs, blocks, sender_info->second.public_share))
+    {
+        // find the invalid block
+        for (size_t i = 0; i < partial_sigs.size(); ++i)
+        {
+            if (!verify_client_s(partial_sigs[i].R, partial_sigs[i].s, blocks[i].hram, sender_info->second.public_share, blocks[i].delta))
+            {
+                LOG_ERROR("Failed to verify the signature s sent by client %" PRIu64 " for block %lu txid %s", sender, i, txid.c_str());
+                throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+            }
+        }
+        LOG_ERROR("Failed to verify the signatures s sent by client %" PRIu64 " txid %s", sender, txid.c_str());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    for (size_t i = 0; i < partial_sigs.size(); ++i)
+    {
+        eddsa_signature& sig = sigs[i];
         ed25519_scalar_t x;
-        throw_cosigner_exception(ed25519_algebra_add_scalars(ed25519, &x, key.data, sizeof(elliptic_curve256_scalar_t), delta, sizeof(ed25519_scalar_t)));
+        throw_cosigner_exception(ed25519_algebra_add_scalars(ed25519, &x, key.data, sizeof(elliptic_curve256_scalar_t), blocks[i].delta, sizeof(ed25519_scalar_t)));
         ed25519_scalar_cleaner xcleaner(x);
         throw_cosigner_exception(ed25519_algebra_be_to_le(&x, &x));
-        throw_cosigner_exception(ed25519_algebra_mul_add(ed25519, &sig.s, &hram, &x, &data.sig_data[i].k.data));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ed25519, &sig.s, &blocks[i].hram, &x, &data.sig_data[i].k.data));
 
         if (final_sig)
         {
@@ -412,19 +520,6 @@ uint64_t asymmetric_eddsa_cosigner_server::broadcast_si(const std::string& txid,
             ed25519_le_scalar_t s;
             throw_cosigner_exception(ed25519_algebra_be_to_le(&s, &partial_sigs[i].s));
             throw_cosigner_exception(ed25519_algebra_add_le_scalars(ed25519, &sig.s, &sig.s, &s));
-
-            unsigned char raw_sig[64];
-            memcpy(raw_sig, sig.R, 32);
-            memcpy(raw_sig + 32, sig.s, 32);
-            if (ed25519_verify(ed25519, (const uint8_t*)data.sig_data[i].message.data(), data.sig_data[i].message.size(), raw_sig, derived_public_key, data.sig_data[i].flags & EDDSA_KECCAK))
-            {
-                LOG_INFO("Signature validated for block %lu", i);
-            }
-            else
-            {
-                LOG_FATAL("failed to verify signature for block %lu", i);
-                throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
-            }
         }
         else
         {
@@ -432,9 +527,31 @@ uint64_t asymmetric_eddsa_cosigner_server::broadcast_si(const std::string& txid,
             if (my_id == min_signer_id)
                 throw_cosigner_exception(ed25519_algebra_add_scalars(ed25519, &sig.s, sig.s, sizeof(ed25519_scalar_t), partial_sigs[i].s, sizeof(ed25519_scalar_t)));
             memcpy(data.sig_data[i].R.data, sig.R, sizeof(ed25519_point_t));
+        }
+    }
 
+    if (final_sig)
+    {
+        if (verify_signatures_batch(ed25519, sigs, blocks))
+        {
+            LOG_INFO("Signatures validated for %lu blocks", sigs.size());
+        }
+        else
+        {
+            for (size_t i = 0; i < sigs.size(); ++i)
+            {
+                unsigned char raw_sig[64];
+                memcpy(raw_sig, sigs[i].R, 32);
+                memcpy(raw_sig + 32, sigs[i].s, 32);
+                if (!ed25519_verify(ed25519, (const uint8_t*)data.sig_data[i].message.data(), data.sig_data[i].message.size(), raw_sig, blocks[i].derived_public_key, data.sig_data[i].flags & EDDSA_KECCAK))
+                {
+                    LOG_FATAL("failed to verify signature for block %lu", i);
+                    throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+                }
+            }
+            LOG_FATAL("failed to verify signatures");
+            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
         }
-        sigs.push_back(sig);
     }
 
     if (final_sig)
@@ -0,0 +1,149 @@
+#include "cosigner/cmp_auxiliary_keys_pool.h"
+#include "cosigner/cmp_setup_service.h"
+#include "cosigner/cosigner_exception.h"
+#include "logging/logging_t.h"
+
+#include <inttypes.h>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+cmp_auxiliary_keys_pool::pool_persistency::~pool_persistency()
+{
+}
+
+cmp_auxiliary_keys_pool::cmp_auxiliary_keys_pool(size_t capacity, size_t threads, pool_persistency* persistency) :
+    _capacity(capacity), _persistency(persistency), _next_id(0), _pending(0), _stop(false)
+{
+    if (!capacity)
+    {
+        LOG_ERROR("auxiliary keys pool capacity must be positive");
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    if (_persistency)
+    {
+        std::map<uint64_t, auxiliary_keys> keys;
+        _persistency->load_pool_keys(keys);
+        for (auto it = keys.begin(); it != keys.end(); ++it)
+        {
+            if (!it->second.paillier || !it->second.ring_pedersen)
+            {
+                LOG_ERROR("auxiliary keys %" PRIu64 " loaded from persistency are missing", it->first);
+                throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            }
+            _keys.emplace_back(it->first, it->second);
+        }
+        if (!keys.empty())
+            _next_id = keys.rbegin()->first + 1;
+        LOG_INFO("loaded %lu auxiliary keys", keys.size());
+    }
+
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+        _threads.emplace_back(&cmp_auxiliary_keys_pool::generator_thread, this);
+}
+
+cmp_auxiliary_keys_pool::~cmp_auxiliary_keys_pool()
+{
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        _stop = true;
+    }
+    _cond.notify_all();
+    for (auto it = _threads.begin(); it != _threads.end(); ++it)
+        it->join();
+}
+
+auxiliary_keys cmp_auxiliary_keys_pool::get()
+{
+    std::pair<uint64_t, auxiliary_keys> keys;
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        if (!_keys.empty())
+        {
+            keys = std::move(_keys.front());
+            _keys.pop_front();
+        }
+    }
+
+    if (!keys.second.paillier)
+    {
+        LOG_WARN("auxiliary keys pool is empty, generating keys inline");
+        return cmp_setup_service::create_auxiliary_keys();
+    }
+    _cond.notify_one();
+
+    // if the delete fails the keys aren't used, they will be loaded again on restart but were never handed out
+    if (_persistency)
+        _persistency->delete_pool_keys(keys.first);
+    return keys.second;
+}
+
+size_t cmp_auxiliary_keys_pool::size() const
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    return _keys.size();
+}
+
+void cmp_auxiliary_keys_pool::fill()
+{
+    uint64_t id;
+    while (reserve_slot(false, id))
+        generate_and_add(id);
+}
+
+bool cmp_auxiliary_keys_pool::reserve_slot(bool wait, uint64_t& id)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    if (wait)
+        _cond.wait(lock, [this] {return _stop || _keys.size() + _pending < _capacity;});
+    if (_stop || _keys.size() + _pending >= _capacity)
+        return false;
+    ++_pending;
+    id = _next_id++;
+    return true;
+}
+
+void cmp_auxiliary_keys_pool::generate_and_add(uint64_t id)
+{
+    try
+    {
+        auxiliary_keys aux = cmp_setup_service::create_auxiliary_keys();
+        if (_persistency)
+            _persistency->store_pool_keys(id, aux);
+        std::lock_guard<std::mutex> lg(_lock);
+        _keys.emplace_back(id, std::move(aux));
+        --_pending;
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        --_pending;
+        throw;
+    }
+}
+
+void cmp_auxiliary_keys_pool::generator_thread()
+{
+    uint64_t id;
+    while (reserve_slot(true, id))
+    {
+        try
+        {
+            generate_and_add(id);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("failed to generate auxiliary keys, error %s", e.what());
+        }
+    }
+}
+
+}
+}
+}
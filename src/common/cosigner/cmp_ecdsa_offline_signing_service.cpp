@@ -263,15 +263,26 @@ uint64_t cmp_ecdsa_offline_signing_service::store_presigning_data(const std::str
     }
 
     std::string uuid = metadata.key_id + request_id;
+    std::vector<ecdsa_signing_data> data(metadata.count);
+    std::vector<cmp_signature_preprocessed_data> sig_data(metadata.count);
+    std::vector<ecdsa_signing_data*> data_ptrs(metadata.count);
+    std::vector<elliptic_curve_point*> R_ptrs(metadata.count);
     for (size_t i = 0; i < metadata.count; i++)
     {
-        ecdsa_signing_data data;
-        _preprocessing_persistency.load_preprocessing_data(request_id, metadata.start_index + i, data);
+        _preprocessing_persistency.load_preprocessing_data(request_id, metadata.start_index + i, data[i]);
+        calc_delta(data[i], algebra, my_id, uuid, key_md, deltas, i);
+        data_ptrs[i] = &data[i];
+        R_ptrs[i] = &sig_data[i].R;
+    }
+
+    calc_R(data_ptrs, R_ptrs, algebra);
 
-        elliptic_curve_point R;
-        calc_R(data, R, algebra, my_id, uuid, key_md, deltas, i);
-        cmp_signature_preprocessed_data sig_data = {data.k, data.chi, R};
-        _preprocessing_persistency.store_preprocessed_data(metadata.key_id, metadata.start_index + i, sig_data);
+    for (size_t i = 0; i < metadata.count; i++)
+    {
+        sig_data[i].k = data[i].k;
+        sig_data[i].chi = data[i].chi;
+        calc_r_info(metadata.algorithm, sig_data[i].R, sig_data[i].r_info);
+        _preprocessing_persistency.store_preprocessed_data(metadata.key_id, metadata.start_index + i, sig_data[i]);
     }
 
     _preprocessing_persistency.delete_preprocessing_data(request_id);
@@ -327,6 +338,11 @@ void cmp_ecdsa_offline_signing_service::ecdsa_sign(const std::string& key_id, co
 
     auto algebra = get_algebra(algo);
     GFp_curve_algebra_ctx_t* curve = (GFp_curve_algebra_ctx_t*)algebra->ctx;
+
+    // R' = R * counter blocks, their s is multiplied by counter^-1 after all the blocks are signed
+    std::vector<size_t> counter_indexes;
+    std::vector<uint8_t> counters;
+
     for (size_t i = 0; i < data.blocks.size(); i++)
     {
         if (sizeof(elliptic_curve256_scalar_t) != data.blocks[i].data.size())
@@ -351,26 +367,22 @@ void cmp_ecdsa_offline_signing_service::ecdsa_sign(const std::string& key_id, co
 
         const elliptic_curve_scalar delta = derivation_key_delta(algebra, metadata.public_key, data.chaincode, data.blocks[i].path);
         
-        recoverable_signature sig = {{0}, {0}, 0};
-        uint8_t overflow = 0;
-        throw_cosigner_exception(GFp_curve_algebra_get_point_projection(curve, &sig.r, &preprocessed_data.R.data, &overflow));
+        // presigning data stored by older versions doesn't contain the R info
+        if (!preprocessed_data.r_info.positive_r_multiplier)
+            calc_r_info(algo, preprocessed_data.R, preprocessed_data.r_info);
 
-        elliptic_curve256_point_t R;
-        memcpy(R, preprocessed_data.R.data, sizeof(elliptic_curve256_point_t));
-        
+        recoverable_signature sig = {{0}, {0}, 0};
         uint8_t counter = 1;
-        while (flags[i] & POSITIVE_R && !is_positive(algo, sig.r) && counter)
+        if (flags[i] & POSITIVE_R)
         {
-            ++counter;
-            throw_cosigner_exception(GFp_curve_algebra_add_points(curve, &R, &preprocessed_data.R.data, &R));
-            throw_cosigner_exception(GFp_curve_algebra_get_point_projection(curve, &sig.r, &R, &overflow));
+            counter = preprocessed_data.r_info.positive_r_multiplier;
+            memcpy(sig.r, preprocessed_data.r_info.positive_r, sizeof(elliptic_curve256_scalar_t));
+            sig.v = preprocessed_data.r_info.positive_v;
         }
-
-        // the probability of not getting positive r after 255 attemps is 1/2^255
-        if (!counter)
+        else
         {
-            LOG_ERROR("failed to found positive R, WTF???");
-            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR); 
+            memcpy(sig.r, preprocessed_data.r_info.r, sizeof(elliptic_curve256_scalar_t));
+            sig.v = preprocessed_data.r_info.v;
         }
 
         LOG_INFO("calculating sig with R' = R * %u", counter);
@@ -387,14 +399,27 @@ void cmp_ecdsa_offline_signing_service::ecdsa_sign(const std::string& key_id, co
         throw_cosigner_exception(GFp_curve_algebra_add_scalars(curve, &sig.s, sig.s, sizeof(elliptic_curve256_scalar_t), tmp, sizeof(elliptic_curve256_scalar_t)));
         if (counter > 1)
         {
-            elliptic_curve256_scalar_t counter_inverse = {0};
-            counter_inverse[sizeof(elliptic_curve256_scalar_t) - 1] = counter;
-            throw_cosigner_exception(GFp_curve_algebra_inverse(curve, &counter_inverse, &counter_inverse));
-            throw_cosigner_exception(GFp_curve_algebra_mul_scalars(curve, &sig.s, sig.s, sizeof(elliptic_curve256_scalar_t), counter_inverse, sizeof(elliptic_curve256_scalar_t)));
+            counter_indexes.push_back(partial_sigs.size());
+            counters.push_back(counter);
         }
-        sig.v = (overflow ? 2 : 0) | (is_odd_point(R) ? 1 : 0);
         partial_sigs.push_back(sig);
     }
+
+    if (counter_indexes.size())
+    {
+        std::vector<elliptic_curve256_scalar_t> counter_inverses(counters.size());
+        for (size_t i = 0; i < counters.size(); i++)
+        {
+            memset(counter_inverses[i], 0, sizeof(elliptic_curve256_scalar_t));
+            counter_inverses[i][sizeof(elliptic_curve256_scalar_t) - 1] = counters[i];
+        }
+        throw_cosigner_exception(GFp_curve_algebra_batch_inverse(curve, counter_inverses.data(), counter_inverses.data(), counter_inverses.size(), 0));
+        for (size_t i = 0; i < counter_indexes.size(); i++)
+        {
+            recoverable_signature& sig = partial_sigs[counter_indexes[i]];
+            throw_cosigner_exception(GFp_curve_algebra_mul_scalars(curve, &sig.s, sig.s, sizeof(elliptic_curve256_scalar_t), counter_inverses[i], sizeof(elliptic_curve256_scalar_t)));
+        }
+    }
 }
 
 uint64_t cmp_ecdsa_offline_signing_service::ecdsa_offline_signature(const std::string& key_id, const std::string& txid, cosigner_sign_algorithm algorithm, const std::map<uint64_t, std::vector<recoverable_signature>>& partial_sigs, std::vector<recoverable_signature>& sigs)
@@ -461,6 +486,35 @@ void cmp_ecdsa_offline_signing_service::cancel_preprocessing(const std::string&
     _preprocessing_persistency.delete_preprocessing_data(request_id);
 }
 
+void cmp_ecdsa_offline_signing_service::calc_r_info(cosigner_sign_algorithm algorithm, const elliptic_curve_point& R, cmp_signature_r_info& info)
+{
+    GFp_curve_algebra_ctx_t* curve = (GFp_curve_algebra_ctx_t*)get_algebra(algorithm)->ctx;
+    uint8_t overflow = 0;
+    throw_cosigner_exception(GFp_curve_algebra_get_point_projection(curve, &info.r, &R.data, &overflow));
+    info.v = (overflow ? 2 : 0) | (is_odd_point(R.data) ? 1 : 0);
+
+    elliptic_curve256_point_t positive_R;
+    memcpy(positive_R, R.data, sizeof(elliptic_curve256_point_t));
+    memcpy(info.positive_r, info.r, sizeof(elliptic_curve256_scalar_t));
+    
+    uint8_t counter = 1;
+    while (!is_positive(algorithm, info.positive_r) && counter)
+    {
+        ++counter;
+        throw_cosigner_exception(GFp_curve_algebra_add_points(curve, &positive_R, &R.data, &positive_R));
+        throw_cosigner_exception(GFp_curve_algebra_get_point_projection(curve, &info.positive_r, &positive_R, &overflow));
+    }
+
+    // the probability of not getting positive r after 255 attemps is 1/2^255
+    if (!counter)
+    {
+        LOG_ERROR("failed to found positive R, WTF???");
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR); 
+    }
+    info.positive_v = (overflow ? 2 : 0) | (is_odd_point(positive_R) ? 1 : 0);
+    info.positive_r_multiplier = counter;
+}
+
 }
 }
 }
\ No newline at end of file
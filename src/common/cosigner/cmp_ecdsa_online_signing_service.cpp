@@ -17,6 +17,10 @@ namespace common
 namespace cosigner
 {
 
+// signing requests with up to LOW_LATENCY_MAX_BLOCKS blocks (usually a single transfer) are latency bound, so the proofs of each block
+// are generated concurrently. Larger requests are throughput bound and generate them serially to leave the cores to other requests
+static const size_t LOW_LATENCY_MAX_BLOCKS = 4;
+
 #ifdef DEBUG
 template<typename T>
 static inline std::string HexStr(const T itbegin, const T itend)
@@ -123,6 +127,7 @@ void cmp_ecdsa_online_signing_service::start_signing(const std::string& key_id,
     auto aad = build_aad(key_id + txid, my_id, metadata.seed);
 
     auto algebra = get_algebra(metadata.algorithm);
+    const bool low_latency = blocks <= LOW_LATENCY_MAX_BLOCKS;
 
     for (size_t i = 0; i < blocks; i++)
     {
@@ -130,7 +135,7 @@ void cmp_ecdsa_online_signing_service::start_signing(const std::string& key_id,
         memcpy(sig_data.message, data.blocks[i].data.data(), sizeof(elliptic_curve256_scalar_t));
         sig_data.path = data.blocks[i].path;
         sig_data.flags = NONE;
-        cmp_mta_request msg = create_mta_request(sig_data, algebra, my_id, aad, metadata, paillier);
+        cmp_mta_request msg = create_mta_request(sig_data, algebra, my_id, aad, metadata, paillier, low_latency);
         mta_requests.push_back(std::move(msg));
         info.sig_data.push_back(std::move(sig_data));
     }
@@ -329,10 +334,23 @@ uint64_t cmp_ecdsa_online_signing_service::get_si(const std::string& txid, const
     cosigner_sign_algorithm algo;
     _key_persistency.load_key(metadata.key_id, algo, key.data);
 
+    std::vector<ecdsa_signing_data*> data_ptrs(metadata.sig_data.size());
+    std::vector<elliptic_curve_point*> R_ptrs(metadata.sig_data.size());
+    for (size_t i = 0; i < metadata.sig_data.size(); i++)
+    {
+        calc_delta(metadata.sig_data[i], algebra, my_id, uuid, key_md, deltas, i);
+        data_ptrs[i] = &metadata.sig_data[i];
+        R_ptrs[i] = &metadata.sig_data[i].R;
+    }
+    calc_R(data_ptrs, R_ptrs, algebra);
+
+    // R' = R * counter blocks, their s is multiplied by counter^-1 after all the blocks are signed
+    std::vector<size_t> counter_indexes;
+    std::vector<uint8_t> counters;
+
     for (size_t i = 0; i < metadata.sig_data.size(); i++)
     {
         cmp_signature_data& data = metadata.sig_data[i];
-        calc_R(data, data.R, algebra, my_id, uuid, key_md, deltas, i);
 
 #ifdef DEBUG
         elliptic_curve256_point_t derived_public_key;
@@ -384,13 +402,27 @@ uint64_t cmp_ecdsa_online_signing_service::get_si(const std::string& txid, const
         throw_cosigner_exception(GFp_curve_algebra_add_scalars(curve, &s.data, s.data, sizeof(elliptic_curve256_scalar_t), tmp, sizeof(elliptic_curve256_scalar_t)));
         if (counter > 1)
         {
-            elliptic_curve256_scalar_t counter_inverse = {0};
-            counter_inverse[sizeof(elliptic_curve256_scalar_t) - 1] = counter;
-            throw_cosigner_exception(GFp_curve_algebra_inverse(curve, &counter_inverse, &counter_inverse));
-            throw_cosigner_exception(GFp_curve_algebra_mul_scalars(curve, &s.data, s.data, sizeof(elliptic_curve256_scalar_t), counter_inverse, sizeof(elliptic_curve256_scalar_t)));
+            counter_indexes.push_back(sis.size());
+            counters.push_back(counter);
         }
         sis.push_back(s);
     }
+
+    if (counter_indexes.size())
+    {
+        std::vector<elliptic_curve256_scalar_t> counter_inverses(counters.size());
+        for (size_t i = 0; i < counters.size(); i++)
+        {
+            memset(counter_inverses[i], 0, sizeof(elliptic_curve256_scalar_t));
+            counter_inverses[i][sizeof(elliptic_curve256_scalar_t) - 1] = counters[i];
+        }
+        throw_cosigner_exception(GFp_curve_algebra_batch_inverse(curve, counter_inverses.data(), counter_inverses.data(), counter_inverses.size(), 0));
+        for (size_t i = 0; i < counter_indexes.size(); i++)
+        {
+            elliptic_curve_scalar& s = sis[counter_indexes[i]];
+            throw_cosigner_exception(GFp_curve_algebra_mul_scalars(curve, &s.data, s.data, sizeof(elliptic_curve256_scalar_t), counter_inverses[i], sizeof(elliptic_curve256_scalar_t)));
+        }
+    }
     _signing_persistency.update_cmp_signing_data(txid, metadata);
     return my_id;
 }
@@ -0,0 +1,223 @@
+#include "cosigner/cmp_ecdsa_preprocessing_pipeline.h"
+#include "cosigner/cosigner_exception.h"
+#include "logging/logging_t.h"
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+cmp_ecdsa_preprocessing_pipeline::cmp_ecdsa_preprocessing_pipeline(cmp_ecdsa_offline_signing_service& service, size_t max_in_flight, size_t threads) :
+    _service(service), _max_in_flight(max_in_flight), _stop(false)
+{
+    if (!max_in_flight || !threads)
+    {
+        LOG_ERROR("preprocessing pipeline requires at least one request in flight and one thread");
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    try
+    {
+        _threads.reserve(threads);
+        for (size_t i = 0; i < threads; i++)
+            _threads.emplace_back(&cmp_ecdsa_preprocessing_pipeline::worker_thread, this);
+    }
+    catch (...)
+    {
+        LOG_ERROR("failed to start preprocessing pipeline threads, started %lu of %lu", _threads.size(), threads);
+        stop();
+        throw;
+    }
+}
+
+cmp_ecdsa_preprocessing_pipeline::~cmp_ecdsa_preprocessing_pipeline()
+{
+    stop();
+}
+
+void cmp_ecdsa_preprocessing_pipeline::stop()
+{
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        _stop = true;
+    }
+    _cond.notify_all();
+    for (auto it = _threads.begin(); it != _threads.end(); ++it)
+        it->join();
+}
+
+std::future<std::vector<cmp_mta_request>> cmp_ecdsa_preprocessing_pipeline::start_ecdsa_signature_preprocessing(const std::string& tenant_id, const std::string& key_id, const std::string& request_id, uint32_t start_index, uint32_t count, uint32_t total_count, const std::set<uint64_t>& players_ids)
+{
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        if (_in_flight.size() >= _max_in_flight)
+        {
+            LOG_WARN("can't start preprocessing request %s, %lu requests are in flight", request_id.c_str(), _in_flight.size());
+            throw cosigner_exception(cosigner_exception::BUSY);
+        }
+        if (!_in_flight.emplace(request_id, false).second)
+        {
+            LOG_ERROR("preprocessing request %s is already in flight", request_id.c_str());
+            throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+        }
+    }
+
+    return enqueue<std::vector<cmp_mta_request>>(0, request_id, [this, tenant_id, key_id, request_id, start_index, count, total_count, players_ids]()
+    {
+        std::vector<cmp_mta_request> mta_requests;
+        _service.start_ecdsa_signature_preprocessing(tenant_id, key_id, request_id, start_index, count, total_count, players_ids, mta_requests);
+        return mta_requests;
+    });
+}
+
+std::future<cmp_mta_responses> cmp_ecdsa_preprocessing_pipeline::offline_mta_response(const std::string& request_id, std::map<uint64_t, std::vector<cmp_mta_request>> requests)
+{
+    auto shared_requests = std::make_shared<std::map<uint64_t, std::vector<cmp_mta_request>>>(std::move(requests));
+    return enqueue<cmp_mta_responses>(1, request_id, [this, request_id, shared_requests]()
+    {
+        cmp_mta_responses response;
+        _service.offline_mta_response(request_id, *shared_requests, response);
+        return response;
+    });
+}
+
+std::future<std::vector<cmp_mta_deltas>> cmp_ecdsa_preprocessing_pipeline::offline_mta_verify(const std::string& request_id, std::map<uint64_t, cmp_mta_responses> mta_responses)
+{
+    auto shared_responses = std::make_shared<std::map<uint64_t, cmp_mta_responses>>(std::move(mta_responses));
+    return enqueue<std::vector<cmp_mta_deltas>>(2, request_id, [this, request_id, shared_responses]()
+    {
+        std::vector<cmp_mta_deltas> deltas;
+        _service.offline_mta_verify(request_id, *shared_responses, deltas);
+        return deltas;
+    });
+}
+
+std::future<std::string> cmp_ecdsa_preprocessing_pipeline::store_presigning_data(const std::string& request_id, std::map<uint64_t, std::vector<cmp_mta_deltas>> deltas)
+{
+    auto shared_deltas = std::make_shared<std::map<uint64_t, std::vector<cmp_mta_deltas>>>(std::move(deltas));
+    return enqueue<std::string>(3, request_id, [this, request_id, shared_deltas]()
+    {
+        std::string key_id;
+        _service.store_presigning_data(request_id, *shared_deltas, key_id);
+        request_done(request_id);
+        return key_id;
+    });
+}
+
+void cmp_ecdsa_preprocessing_pipeline::cancel_preprocessing(const std::string& request_id)
+{
+    _service.cancel_preprocessing(request_id);
+    request_done(request_id);
+}
+
+size_t cmp_ecdsa_preprocessing_pipeline::in_flight() const
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    return _in_flight.size();
+}
+
+template<typename T>
+std::future<T> cmp_ecdsa_preprocessing_pipeline::enqueue(size_t round, const std::string& request_id, std::function<T()> func)
+{
+    // a failed round ends the request, the other players will fail the next round as well
+    auto task = std::make_shared<std::packaged_task<T()>>([this, round, request_id, func]()
+    {
+        try
+        {
+            // the request may have been canceled or failed while the round was queued
+            if (!is_in_flight(request_id))
+            {
+                LOG_ERROR("preprocessing request %s is no longer in flight, dropping round %lu", request_id.c_str(), round + 1);
+                throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+            }
+            return func();
+        }
+        catch (...)
+        {
+            LOG_ERROR("preprocessing request %s failed in round %lu", request_id.c_str(), round + 1);
+            request_done(request_id);
+            throw;
+        }
+    });
+    std::future<T> ret = task->get_future();
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        auto it = _in_flight.find(request_id);
+        if (it == _in_flight.end())
+        {
+            LOG_ERROR("preprocessing request %s is not in flight, can't queue round %lu", request_id.c_str(), round + 1);
+            throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+        }
+        // the first round is queued by start_ecdsa_signature_preprocessing which just added the request
+        if (round && it->second)
+        {
+            LOG_ERROR("preprocessing request %s already has a queued round, can't queue round %lu", request_id.c_str(), round + 1);
+            throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+        }
+        it->second = true;
+        _queues[round].emplace_back([this, task, request_id]()
+        {
+            {
+                std::lock_guard<std::mutex> lg(_lock);
+                auto it = _in_flight.find(request_id);
+                if (it != _in_flight.end())
+                    it->second = false;
+            }
+            (*task)();
+        });
+    }
+    _cond.notify_one();
+    return ret;
+}
+
+void cmp_ecdsa_preprocessing_pipeline::request_done(const std::string& request_id)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    _in_flight.erase(request_id);
+}
+
+bool cmp_ecdsa_preprocessing_pipeline::is_in_flight(const std::string& request_id) const
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    return _in_flight.find(request_id) != _in_flight.end();
+}
+
+void cmp_ecdsa_preprocessing_pipeline::worker_thread()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _cond.wait(lock, [this]
+            {
+                if (_stop)
+                    return true;
+                for (size_t i = 0; i < ROUNDS; i++)
+                    if (!_queues[i].empty())
+                        return true;
+                return false;
+            });
+            if (_stop)
+                return;
+
+            for (size_t i = ROUNDS; i > 0; i--)
+            {
+                if (!_queues[i - 1].empty())
+                {
+                    task = std::move(_queues[i - 1].front());
+                    _queues[i - 1].pop_front();
+                    break;
+                }
+            }
+        }
+        // the packaged task stores the exception in the future
+        task();
+    }
+}
+
+}
+}
+}
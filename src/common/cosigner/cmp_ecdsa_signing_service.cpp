@@ -25,7 +25,7 @@ cmp_ecdsa_signing_service::~cmp_ecdsa_signing_service()
 {
 }
 
-cmp_mta_request cmp_ecdsa_signing_service::create_mta_request(ecdsa_signing_data& data, const elliptic_curve256_algebra_ctx_t* algebra, uint64_t my_id, const std::vector<uint8_t>& aad, const cmp_key_metadata& metadata, const std::shared_ptr<paillier_public_key_t>& paillier)
+cmp_mta_request cmp_ecdsa_signing_service::create_mta_request(ecdsa_signing_data& data, const elliptic_curve256_algebra_ctx_t* algebra, uint64_t my_id, const std::vector<uint8_t>& aad, const cmp_key_metadata& metadata, const std::shared_ptr<paillier_public_key_t>& paillier, bool low_latency)
 {
     throw_cosigner_exception(algebra->rand(algebra, &data.k.data));
     throw_cosigner_exception(algebra->rand(algebra, &data.a.data));
@@ -43,7 +43,7 @@ cmp_mta_request cmp_ecdsa_signing_service::create_mta_request(ecdsa_signing_data
     throw_cosigner_exception(algebra->mul_scalars(algebra, &tmp, data.a.data, sizeof(elliptic_curve256_scalar_t), data.b.data, sizeof(elliptic_curve256_scalar_t)));
     throw_cosigner_exception(algebra->add_scalars(algebra, &tmp, tmp, sizeof(elliptic_curve256_scalar_t), data.k.data, sizeof(elliptic_curve256_scalar_t)));
     throw_cosigner_exception(algebra->generator_mul(algebra, &msg.Z.data, &tmp));
-    msg.mta = mta::request(my_id, algebra, data.k, data.gamma, data.a, data.b, aad, paillier, metadata.players_info, msg.mta_proofs, data.G_proofs);
+    msg.mta = mta::request(my_id, algebra, data.k, data.gamma, data.a, data.b, aad, paillier, metadata.players_info, msg.mta_proofs, data.G_proofs, low_latency);
 
     data.mta_request = msg.mta.message;
     return msg;
@@ -101,12 +101,15 @@ cmp_mta_response cmp_ecdsa_signing_service::create_mta_response(ecdsa_signing_da
         if (req_it->first == my_id)
             continue;
         const auto& other = metadata.players_info.at(req_it->first);
-        auto& gamma_mta = resp.k_gamma_mta[req_it->first];
-        auto beta = mta::answer_mta_request(algebra, req_it->second[index].mta, data.gamma.data, sizeof(elliptic_curve256_scalar_t), aad, aux_keys.paillier, other.paillier, other.ring_pedersen, gamma_mta);
-        throw_cosigner_exception(algebra->sub_scalars(algebra, &data.delta.data, data.delta.data, sizeof(elliptic_curve256_scalar_t), beta.data, sizeof(elliptic_curve256_scalar_t)));
-        auto& x_mta = resp.k_x_mta[req_it->first];
-        beta = mta::answer_mta_request(algebra, req_it->second[index].mta, key.data, sizeof(elliptic_curve256_scalar_t), aad, aux_keys.paillier, other.paillier, other.ring_pedersen, x_mta);
-        throw_cosigner_exception(algebra->sub_scalars(algebra, &data.chi.data, data.chi.data, sizeof(elliptic_curve256_scalar_t), beta.data, sizeof(elliptic_curve256_scalar_t)));
+        // both mta answers use the same K, so it's parsed once
+        const elliptic_curve_scalar secrets[2] = {data.gamma, key};
+        cmp_mta_message mta_responses[2];
+        elliptic_curve_scalar betas[2];
+        mta::answer_mta_requests(algebra, req_it->second[index].mta, secrets, 2, aad, aux_keys.paillier, other.paillier, other.ring_pedersen, mta_responses, betas);
+        resp.k_gamma_mta[req_it->first] = std::move(mta_responses[0]);
+        resp.k_x_mta[req_it->first] = std::move(mta_responses[1]);
+        throw_cosigner_exception(algebra->sub_scalars(algebra, &data.delta.data, data.delta.data, sizeof(elliptic_curve256_scalar_t), betas[0].data, sizeof(elliptic_curve256_scalar_t)));
+        throw_cosigner_exception(algebra->sub_scalars(algebra, &data.chi.data, data.chi.data, sizeof(elliptic_curve256_scalar_t), betas[1].data, sizeof(elliptic_curve256_scalar_t)));
         auto& pub = data.public_data[req_it->first];
         pub.A = req_it->second[index].A;
         pub.B = req_it->second[index].B;
@@ -176,7 +179,7 @@ cmp_mta_deltas cmp_ecdsa_signing_service::mta_verify(
     return delta;
 }
 
-void cmp_ecdsa_signing_service::calc_R(ecdsa_signing_data& data, elliptic_curve_point& R, const elliptic_curve256_algebra_ctx_t* algebra, uint64_t my_id, const std::string& uuid, const cmp_key_metadata& metadata,
+void cmp_ecdsa_signing_service::calc_delta(ecdsa_signing_data& data, const elliptic_curve256_algebra_ctx_t* algebra, uint64_t my_id, const std::string& uuid, const cmp_key_metadata& metadata,
         const std::map<uint64_t, std::vector<cmp_mta_deltas>>& deltas, size_t index)
 {
     elliptic_curve256_point_t DELTA;
@@ -215,11 +218,29 @@ void cmp_ecdsa_signing_service::calc_R(ecdsa_signing_data& data, elliptic_curve_
         LOG_ERROR("Failed to verify that g^delta == DELTA");
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    throw_cosigner_exception(algebra->inverse(algebra, &data.delta.data, &data.delta.data));
-    throw_cosigner_exception(algebra->point_mul(algebra, &R.data, &data.GAMMA.data, &data.delta.data));
     data.public_data.clear();
 }
 
+void cmp_ecdsa_signing_service::calc_R(std::vector<ecdsa_signing_data*>& data, std::vector<elliptic_curve_point*>& R, const elliptic_curve256_algebra_ctx_t* algebra)
+{
+    if (data.size() != R.size())
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    if (data.empty())
+        return;
+
+    // delta is the sum of the values all the players published, so it isn't a secret and the faster inversion can be used
+    std::vector<elliptic_curve256_scalar_t> delta_inverses(data.size());
+    for (size_t i = 0; i < data.size(); i++)
+        memcpy(delta_inverses[i], data[i]->delta.data, sizeof(elliptic_curve256_scalar_t));
+    throw_cosigner_exception(algebra->batch_inverse(algebra, delta_inverses.data(), delta_inverses.data(), delta_inverses.size(), 0));
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        memcpy(data[i]->delta.data, delta_inverses[i], sizeof(elliptic_curve256_scalar_t));
+        throw_cosigner_exception(algebra->point_mul(algebra, &R[i]->data, &data[i]->GAMMA.data, &data[i]->delta.data));
+    }
+}
+
 std::vector<uint8_t> cmp_ecdsa_signing_service::build_aad(const std::string& sid, uint64_t id, const commitments_sha256_t srid)
 {
     std::vector<uint8_t> ret(sid.begin(), sid.end());
@@ -1,4 +1,8 @@
 #include "cosigner/cmp_key_persistency.h"
+#include "cosigner/cosigner_exception.h"
+#include "crypto/commitments/ring_pedersen.h"
+#include "crypto/paillier/paillier.h"
+#include "logging/logging_t.h"
 
 namespace fireblocks
 {
@@ -7,6 +11,26 @@ namespace common
 namespace cosigner
 {
 
+void deserialize_public_key(const byte_vector_t& serialized, std::shared_ptr<struct paillier_public_key>& key)
+{
+    key.reset(paillier_public_key_deserialize(serialized.data(), serialized.size()), paillier_free_public_key);
+    if (!key)
+    {
+        LOG_ERROR("failed to deserialize paillier public key");
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+}
+
+void deserialize_public_key(const byte_vector_t& serialized, std::shared_ptr<struct ring_pedersen_public>& key)
+{
+    key.reset(ring_pedersen_public_deserialize(serialized.data(), serialized.size()), ring_pedersen_free_public);
+    if (!key)
+    {
+        LOG_ERROR("failed to deserialize ring pedersen public key");
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+}
+
 cmp_key_persistency::~cmp_key_persistency()
 {
 }
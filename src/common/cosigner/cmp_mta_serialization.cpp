@@ -0,0 +1,320 @@
+#include "cosigner/cmp_mta_serialization.h"
+#include "cosigner/cosigner_exception.h"
+#include "serialization.h"
+#include "logging/logging_t.h"
+
+#include <assert.h>
+#include <inttypes.h>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+using wire_format::writer;
+using wire_format::reader;
+using wire_format::HEADER_SIZE;
+using wire_format::serialized_size;
+
+enum CMP_MTA_WIRE_TYPE
+{
+    MTA_REQUESTS    = 1,
+    MTA_RESPONSES   = 2,
+    MTA_DELTAS      = 3
+};
+
+static cmp_mta_request_view read_request(reader& r)
+{
+    cmp_mta_request_view ret;
+    ret.A = r.get<elliptic_curve256_point_t>();
+    ret.B = r.get<elliptic_curve256_point_t>();
+    ret.Z = r.get<elliptic_curve256_point_t>();
+    ret.mta = r.get_message();
+    ret.mta_proofs = r.get_map(&reader::get_bytes);
+    return ret;
+}
+
+static cmp_mta_response_view read_response(reader& r)
+{
+    cmp_mta_response_view ret;
+    ret.GAMMA = r.get<elliptic_curve256_point_t>();
+    ret.k_gamma_mta = r.get_map(&reader::get_message);
+    ret.k_x_mta = r.get_map(&reader::get_message);
+    ret.gamma_proofs = r.get_map(&reader::get_bytes);
+    return ret;
+}
+
+static cmp_mta_deltas_view read_deltas(reader& r)
+{
+    cmp_mta_deltas_view ret;
+    ret.delta = r.get<elliptic_curve256_scalar_t>();
+    ret.DELTA = r.get<elliptic_curve256_point_t>();
+    ret.proof = r.get_bytes();
+    return ret;
+}
+
+cmp_mta_batch_view::cmp_mta_batch_view(const uint8_t* buffer, size_t size, uint8_t type, size_t prefix_size)
+{
+    if (!buffer)
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    reader r(buffer, buffer + size);
+    r.get_header(CMP_MTA_WIRE_FORMAT_VERSION, type);
+    _prefix = r.take(prefix_size);
+    _count = r.get_uint32();
+    _offsets = r.take((size_t)_count * sizeof(uint32_t));
+    _records = _offsets + (size_t)_count * sizeof(uint32_t);
+    _records_size = buffer + size - _records;
+
+    // records must be stored one after the other
+    size_t expected = 0;
+    for (uint32_t i = 0; i < _count; i++)
+    {
+        size_t offset = wire_format::read_uint32(_offsets + i * sizeof(uint32_t));
+        size_t end = i + 1 < _count ? wire_format::read_uint32(_offsets + (i + 1) * sizeof(uint32_t)) : _records_size;
+        if (offset != expected || end < offset || end > _records_size)
+        {
+            LOG_ERROR("mta record %u offsets [%lu, %lu) are invalid", i, offset, end);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+        expected = end;
+    }
+    if (!_count && _records_size)
+    {
+        LOG_ERROR("got %lu bytes after an empty mta batch", _records_size);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+}
+
+const uint8_t* cmp_mta_batch_view::record(uint32_t index) const
+{
+    if (index >= _count)
+    {
+        LOG_ERROR("mta record index %u is out of range, batch size is %u", index, _count);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+    return _records + wire_format::read_uint32(_offsets + index * sizeof(uint32_t));
+}
+
+template<typename T>
+static T read_record(const uint8_t* begin, const uint8_t* end, T (*read)(reader&))
+{
+    reader r(begin, end);
+    T ret = read(r);
+    if (r.remaining())
+    {
+        LOG_ERROR("mta record has %lu trailing bytes", r.remaining());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+    return ret;
+}
+
+static inline const uint8_t* record_end(const uint8_t* records, size_t records_size, const uint8_t* offsets, uint32_t count, uint32_t index)
+{
+    return records + (index + 1 < count ? wire_format::read_uint32(offsets + (index + 1) * sizeof(uint32_t)) : records_size);
+}
+
+cmp_mta_requests_view::cmp_mta_requests_view(const uint8_t* buffer, size_t size) : cmp_mta_batch_view(buffer, size, MTA_REQUESTS, 0)
+{
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i];
+}
+
+cmp_mta_request_view cmp_mta_requests_view::operator[](uint32_t index) const
+{
+    return read_record(record(index), record_end(_records, _records_size, _offsets, _count, index), read_request);
+}
+
+void cmp_mta_requests_view::to_struct(std::vector<cmp_mta_request>& requests) const
+{
+    requests.clear();
+    requests.resize(_count);
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i].to_struct(requests[i]);
+}
+
+cmp_mta_responses_view::cmp_mta_responses_view(const uint8_t* buffer, size_t size) : cmp_mta_batch_view(buffer, size, MTA_RESPONSES, sizeof(commitments_sha256_t))
+{
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i];
+}
+
+cmp_mta_response_view cmp_mta_responses_view::operator[](uint32_t index) const
+{
+    return read_record(record(index), record_end(_records, _records_size, _offsets, _count, index), read_response);
+}
+
+void cmp_mta_responses_view::to_struct(cmp_mta_responses& responses) const
+{
+    memcpy(responses.ack, ack(), sizeof(commitments_sha256_t));
+    responses.response.clear();
+    responses.response.resize(_count);
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i].to_struct(responses.response[i]);
+}
+
+cmp_mta_deltas_batch_view::cmp_mta_deltas_batch_view(const uint8_t* buffer, size_t size) : cmp_mta_batch_view(buffer, size, MTA_DELTAS, 0)
+{
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i];
+}
+
+cmp_mta_deltas_view cmp_mta_deltas_batch_view::operator[](uint32_t index) const
+{
+    return read_record(record(index), record_end(_records, _records_size, _offsets, _count, index), read_deltas);
+}
+
+void cmp_mta_deltas_batch_view::to_struct(std::vector<cmp_mta_deltas>& deltas) const
+{
+    deltas.clear();
+    deltas.resize(_count);
+    for (uint32_t i = 0; i < _count; i++)
+        (*this)[i].to_struct(deltas[i]);
+}
+
+void cmp_mta_request_view::to_struct(cmp_mta_request& request) const
+{
+    request.mta = mta.to_struct();
+    request.mta_proofs.clear();
+    for (auto it = mta_proofs.begin(); it != mta_proofs.end(); ++it)
+        request.mta_proofs[it->first] = it->second.to_vector();
+    memcpy(request.A.data, *A, sizeof(elliptic_curve256_point_t));
+    memcpy(request.B.data, *B, sizeof(elliptic_curve256_point_t));
+    memcpy(request.Z.data, *Z, sizeof(elliptic_curve256_point_t));
+}
+
+void cmp_mta_response_view::to_struct(cmp_mta_response& response) const
+{
+    response.k_gamma_mta.clear();
+    for (auto it = k_gamma_mta.begin(); it != k_gamma_mta.end(); ++it)
+        response.k_gamma_mta[it->first] = it->second.to_struct();
+    response.k_x_mta.clear();
+    for (auto it = k_x_mta.begin(); it != k_x_mta.end(); ++it)
+        response.k_x_mta[it->first] = it->second.to_struct();
+    memcpy(response.GAMMA.data, *GAMMA, sizeof(elliptic_curve256_point_t));
+    response.gamma_proofs.clear();
+    for (auto it = gamma_proofs.begin(); it != gamma_proofs.end(); ++it)
+        response.gamma_proofs[it->first] = it->second.to_vector();
+}
+
+void cmp_mta_deltas_view::to_struct(cmp_mta_deltas& deltas) const
+{
+    memcpy(deltas.delta.data, *delta, sizeof(elliptic_curve256_scalar_t));
+    memcpy(deltas.DELTA.data, *DELTA, sizeof(elliptic_curve256_point_t));
+    deltas.proof = proof.to_vector();
+}
+
+static inline size_t serialized_size(const cmp_mta_message& msg)
+{
+    return serialized_size(msg.message) + serialized_size(msg.commitment) + serialized_size(msg.proof);
+}
+
+template<typename MAP>
+static inline size_t serialized_map_size(const MAP& map)
+{
+    size_t ret = sizeof(uint32_t);
+    for (auto it = map.begin(); it != map.end(); ++it)
+        ret += sizeof(uint64_t) + serialized_size(it->second);
+    return ret;
+}
+
+static inline void put_value(writer& w, const byte_vector_t& data) {w.put_bytes(data);}
+static inline void put_value(writer& w, const cmp_mta_message& msg) {w.put_message(msg);}
+
+template<typename MAP>
+static inline void put_map(writer& w, const MAP& map)
+{
+    w.put_uint32(map.size());
+    for (auto it = map.begin(); it != map.end(); ++it)
+    {
+        w.put_uint64(it->first);
+        put_value(w, it->second);
+    }
+}
+
+static inline size_t serialized_size(const cmp_mta_request& request)
+{
+    return 3 * sizeof(elliptic_curve256_point_t) + serialized_size(request.mta) + serialized_map_size(request.mta_proofs);
+}
+
+static inline size_t serialized_size(const cmp_mta_response& response)
+{
+    return sizeof(elliptic_curve256_point_t) + serialized_map_size(response.k_gamma_mta) + serialized_map_size(response.k_x_mta) + serialized_map_size(response.gamma_proofs);
+}
+
+static inline size_t serialized_size(const cmp_mta_deltas& deltas)
+{
+    return sizeof(elliptic_curve256_scalar_t) + sizeof(elliptic_curve256_point_t) + serialized_size(deltas.proof);
+}
+
+static inline void put_record(writer& w, const cmp_mta_request& request)
+{
+    w.put_raw(request.A.data, sizeof(elliptic_curve256_point_t));
+    w.put_raw(request.B.data, sizeof(elliptic_curve256_point_t));
+    w.put_raw(request.Z.data, sizeof(elliptic_curve256_point_t));
+    w.put_message(request.mta);
+    put_map(w, request.mta_proofs);
+}
+
+static inline void put_record(writer& w, const cmp_mta_response& response)
+{
+    w.put_raw(response.GAMMA.data, sizeof(elliptic_curve256_point_t));
+    put_map(w, response.k_gamma_mta);
+    put_map(w, response.k_x_mta);
+    put_map(w, response.gamma_proofs);
+}
+
+static inline void put_record(writer& w, const cmp_mta_deltas& deltas)
+{
+    w.put_raw(deltas.delta.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(deltas.DELTA.data, sizeof(elliptic_curve256_point_t));
+    w.put_bytes(deltas.proof);
+}
+
+template<typename T>
+static void serialize_batch(uint8_t type, const uint8_t* prefix, size_t prefix_size, const std::vector<T>& records, byte_vector_t& buffer)
+{
+    const size_t table_size = HEADER_SIZE + prefix_size + sizeof(uint32_t) + records.size() * sizeof(uint32_t);
+    size_t records_size = 0;
+    for (auto it = records.begin(); it != records.end(); ++it)
+        records_size += serialized_size(*it);
+    if (records.size() > UINT32_MAX || records_size > UINT32_MAX)
+    {
+        LOG_ERROR("mta batch is too large, %lu records of total size %lu", records.size(), records_size);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    buffer.resize(table_size + records_size);
+    writer w(buffer.data());
+    w.put_header(CMP_MTA_WIRE_FORMAT_VERSION, type);
+    w.put_raw(prefix, prefix_size);
+    w.put_uint32(records.size());
+    writer offsets(w.ptr());
+    writer data(buffer.data() + table_size);
+    for (auto it = records.begin(); it != records.end(); ++it)
+    {
+        offsets.put_uint32(data.ptr() - (buffer.data() + table_size));
+        put_record(data, *it);
+    }
+    assert(data.ptr() == buffer.data() + buffer.size());
+}
+
+void serialize_mta_requests(const std::vector<cmp_mta_request>& requests, byte_vector_t& buffer)
+{
+    serialize_batch(MTA_REQUESTS, NULL, 0, requests, buffer);
+}
+
+void serialize_mta_responses(const cmp_mta_responses& responses, byte_vector_t& buffer)
+{
+    serialize_batch(MTA_RESPONSES, responses.ack, sizeof(commitments_sha256_t), responses.response, buffer);
+}
+
+void serialize_mta_deltas(const std::vector<cmp_mta_deltas>& deltas, byte_vector_t& buffer)
+{
+    serialize_batch(MTA_DELTAS, NULL, 0, deltas, buffer);
+}
+
+}
+}
+}
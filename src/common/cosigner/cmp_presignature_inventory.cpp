@@ -0,0 +1,312 @@
+#include "cosigner/cmp_presignature_inventory.h"
+#include "cosigner/cosigner_exception.h"
+#include "cosigner/platform_service.h"
+#include "logging/logging_t.h"
+
+#include <inttypes.h>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+cmp_presignature_inventory::cmp_presignature_inventory(const platform_service& service, replenishment_callback callback) :
+    _service(service), _callback(std::move(callback))
+{
+    if (!_callback)
+    {
+        LOG_ERROR("presignature inventory requires a replenishment callback");
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+}
+
+void cmp_presignature_inventory::add_key(const std::string& key_id, const config& cfg, const std::vector<uint64_t>& ready_indices)
+{
+    if (!cfg.capacity || cfg.low_watermark > cfg.capacity || !cfg.min_batch || cfg.min_batch > cfg.max_batch || cfg.max_batch > cfg.capacity || !cfg.rate_window_ms)
+    {
+        LOG_ERROR("invalid presignature inventory config for key %s", key_id.c_str());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    std::unique_lock<std::mutex> lock(_lock);
+    if (_keys.find(key_id) != _keys.end())
+    {
+        LOG_ERROR("key %s already exists in presignature inventory", key_id.c_str());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    key_inventory key;
+    key.cfg = cfg;
+    key.slots.assign(cfg.capacity, SLOT_FREE);
+    key.ready = 0;
+    key.pending = 0;
+    key.next_ready = 0;
+    key.next_free = 0;
+    key.replenishing = false;
+    for (auto it = ready_indices.begin(); it != ready_indices.end(); ++it)
+    {
+        if (*it >= cfg.capacity)
+        {
+            LOG_ERROR("presignature index %" PRIu64 " of key %s is out of range", *it, key_id.c_str());
+            throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
+        }
+        if (key.slots[*it] != SLOT_READY)
+        {
+            key.slots[*it] = SLOT_READY;
+            ++key.ready;
+        }
+        if (*it + 1 > key.next_free)
+            key.next_free = *it + 1;
+    }
+    key.next_free %= cfg.capacity;
+
+    _keys.emplace(key_id, std::move(key));
+    replenish(lock, key_id);
+}
+
+void cmp_presignature_inventory::remove_key(const std::string& key_id)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    _keys.erase(key_id);
+}
+
+bool cmp_presignature_inventory::acquire(const std::string& key_id, uint32_t count, uint64_t& start_index)
+{
+    if (!count)
+    {
+        LOG_ERROR("can't acquire 0 presignatures");
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    std::unique_lock<std::mutex> lock(_lock);
+    key_inventory& key = get_key(key_id);
+    uint32_t found;
+    bool ret = find_run(key, SLOT_READY, key.next_ready, count, count, start_index, found);
+    if (ret)
+    {
+        set_range(key_id, key, start_index, count, SLOT_READY, SLOT_IN_USE);
+        key.next_ready = (start_index + count) % key.cfg.capacity;
+        key.consumption.emplace_back(_service.now_msec(), count);
+    }
+    else
+        LOG_WARN("key %s has no %u consecutive presignatures (%" PRIu64 " ready, %" PRIu64 " pending)", key_id.c_str(), count, key.ready, key.pending);
+
+    replenish(lock, key_id);
+    return ret;
+}
+
+void cmp_presignature_inventory::signing_completed(const std::string& key_id, uint64_t start_index, uint32_t count)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    set_range(key_id, get_key(key_id), start_index, count, SLOT_IN_USE, SLOT_FREE);
+    replenish(lock, key_id);
+}
+
+void cmp_presignature_inventory::release(const std::string& key_id, uint64_t start_index, uint32_t count)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    set_range(key_id, get_key(key_id), start_index, count, SLOT_IN_USE, SLOT_READY);
+}
+
+void cmp_presignature_inventory::preprocessing_completed(const std::string& key_id, uint64_t start_index, uint32_t count)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    key_inventory& key = get_key(key_id);
+    set_range(key_id, key, start_index, count, SLOT_PENDING, SLOT_READY);
+    key.replenishing = false;
+    replenish(lock, key_id);
+}
+
+void cmp_presignature_inventory::preprocessing_failed(const std::string& key_id, uint64_t start_index, uint32_t count)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    key_inventory& key = get_key(key_id);
+    set_range(key_id, key, start_index, count, SLOT_PENDING, SLOT_FREE);
+    key.replenishing = false;
+    // the range is requested again on the next acquire, not here, as the callback may fail synchronously again
+    LOG_WARN("preprocessing of presignatures [%" PRIu64 ", %" PRIu64 ") for key %s failed", start_index, start_index + count, key_id.c_str());
+}
+
+uint64_t cmp_presignature_inventory::available(const std::string& key_id) const
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    return get_key(key_id).ready;
+}
+
+uint64_t cmp_presignature_inventory::pending(const std::string& key_id) const
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    return get_key(key_id).pending;
+}
+
+cmp_presignature_inventory::key_inventory& cmp_presignature_inventory::get_key(const std::string& key_id)
+{
+    auto it = _keys.find(key_id);
+    if (it == _keys.end())
+    {
+        LOG_ERROR("key %s not found in presignature inventory", key_id.c_str());
+        throw cosigner_exception(cosigner_exception::BAD_KEY);
+    }
+    return it->second;
+}
+
+const cmp_presignature_inventory::key_inventory& cmp_presignature_inventory::get_key(const std::string& key_id) const
+{
+    auto it = _keys.find(key_id);
+    if (it == _keys.end())
+    {
+        LOG_ERROR("key %s not found in presignature inventory", key_id.c_str());
+        throw cosigner_exception(cosigner_exception::BAD_KEY);
+    }
+    return it->second;
+}
+
+void cmp_presignature_inventory::set_range(const std::string& key_id, key_inventory& key, uint64_t start_index, uint32_t count, slot_state from, slot_state to)
+{
+    if (!count || start_index >= key.cfg.capacity || count > key.cfg.capacity - start_index)
+    {
+        LOG_ERROR("presignatures range [%" PRIu64 ", %" PRIu64 ") of key %s is out of range", start_index, start_index + count, key_id.c_str());
+        throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
+    }
+    for (uint64_t i = start_index; i < start_index + count; i++)
+    {
+        if (key.slots[i] != from)
+        {
+            LOG_ERROR("presignature %" PRIu64 " of key %s is in state %u, expected %u", i, key_id.c_str(), key.slots[i], from);
+            throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
+        }
+    }
+
+    for (uint64_t i = start_index; i < start_index + count; i++)
+        key.slots[i] = to;
+    if (from == SLOT_READY)
+        key.ready -= count;
+    else if (from == SLOT_PENDING)
+        key.pending -= count;
+    if (to == SLOT_READY)
+        key.ready += count;
+    else if (to == SLOT_PENDING)
+        key.pending += count;
+}
+
+bool cmp_presignature_inventory::find_run(const key_inventory& key, slot_state state, uint64_t from, uint32_t min_count, uint32_t max_count, uint64_t& start, uint32_t& count) const
+{
+    const uint64_t capacity = key.slots.size();
+    uint64_t pos = from % capacity;
+    uint64_t scanned = 0;
+
+    // the indices passed to the signing service are consecutive, so a run can't wrap around the end of the slots
+    while (scanned < capacity)
+    {
+        if (key.slots[pos] != state)
+        {
+            pos = (pos + 1) % capacity;
+            ++scanned;
+            continue;
+        }
+
+        uint64_t end = pos;
+        while (end < capacity && end - pos < max_count && key.slots[end] == state)
+            ++end;
+        if (end - pos >= min_count)
+        {
+            start = pos;
+            count = (uint32_t)(end - pos);
+            return true;
+        }
+        scanned += end - pos;
+        pos = end % capacity;
+    }
+    return false;
+}
+
+uint32_t cmp_presignature_inventory::batch_size(key_inventory& key, uint64_t now) const
+{
+    while (!key.consumption.empty() && now - key.consumption.front().first > key.cfg.rate_window_ms)
+        key.consumption.pop_front();
+
+    uint64_t consumed = 0;
+    for (auto it = key.consumption.begin(); it != key.consumption.end(); ++it)
+        consumed += it->second;
+
+    // presignatures expected to be consumed until the new batch is ready, on top of the low watermark
+    uint64_t target = key.cfg.low_watermark + (consumed * key.cfg.lead_time_ms + key.cfg.rate_window_ms - 1) / key.cfg.rate_window_ms;
+    uint64_t have = key.ready + key.pending;
+    uint64_t batch = target > have ? target - have : 0;
+    if (batch < key.cfg.min_batch)
+        batch = key.cfg.min_batch;
+    if (batch > key.cfg.max_batch)
+        batch = key.cfg.max_batch;
+    return (uint32_t)batch;
+}
+
+bool cmp_presignature_inventory::schedule_replenishment(const std::string& key_id, key_inventory& key, replenishment_request& request)
+{
+    if (key.replenishing || key.ready + key.pending >= key.cfg.low_watermark)
+        return false;
+
+    uint32_t batch = batch_size(key, _service.now_msec());
+    uint64_t start;
+    uint32_t count;
+    if (!find_run(key, SLOT_FREE, key.next_free, batch, batch, start, count) &&
+        !find_run(key, SLOT_FREE, key.next_free, 1, batch, start, count))
+    {
+        LOG_WARN("key %s has no free presignature slots, %" PRIu64 " in use", key_id.c_str(), key.cfg.capacity - key.ready - key.pending);
+        return false;
+    }
+
+    set_range(key_id, key, start, count, SLOT_FREE, SLOT_PENDING);
+    key.next_free = (start + count) % key.cfg.capacity;
+    key.replenishing = true;
+
+    request.key_id = key_id;
+    request.start_index = start;
+    request.count = count;
+    request.total_count = key.cfg.capacity;
+    LOG_INFO("requesting %u presignatures for key %s at index %" PRIu64 ", %" PRIu64 " ready", count, key_id.c_str(), start, key.ready);
+    return true;
+}
+
+void cmp_presignature_inventory::replenish(std::unique_lock<std::mutex>& lock, const std::string& key_id)
+{
+    replenishment_request request;
+    auto it = _keys.find(key_id);
+    if (it == _keys.end() || !schedule_replenishment(key_id, it->second, request))
+        return;
+
+    // returns the slots if the request failed, so the key can be replenished again
+    auto cancel_request = [&]()
+    {
+        lock.lock();
+        auto key_it = _keys.find(key_id);
+        if (key_it != _keys.end())
+        {
+            set_range(key_id, key_it->second, request.start_index, request.count, SLOT_PENDING, SLOT_FREE);
+            key_it->second.replenishing = false;
+        }
+    };
+
+    lock.unlock();
+    try
+    {
+        _callback(request);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("failed to request presignatures for key %s, error %s", key_id.c_str(), e.what());
+        cancel_request();
+    }
+    catch (...)
+    {
+        // unknown exceptions (e.g. thread cancellation) must reach the caller
+        LOG_ERROR("failed to request presignatures for key %s, unknown error", key_id.c_str());
+        cancel_request();
+        throw;
+    }
+}
+
+}
+}
+}
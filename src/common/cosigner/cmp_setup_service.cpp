@@ -1,4 +1,5 @@
 #include "cosigner/cmp_setup_service.h"
+#include "cosigner/cmp_auxiliary_keys_pool.h"
 #include "cosigner/cosigner_exception.h"
 #include "utils.h"
 #include "crypto/zero_knowledge_proof/schnorr.h"
@@ -7,6 +8,8 @@
 #include <openssl/sha.h>
 #include <openssl/crypto.h>
 #include <algorithm>
+#include <memory>
+#include <new>
 
 #include <inttypes.h>
 
@@ -29,6 +32,37 @@ static inline void xor_seed(commitments_sha256_t a, const commitments_sha256_t b
         p1[i] ^= p2[i];
 }
 
+// runs the paillier proof rounds on parallel_for, so they follow its threads policy (and run serially inside a batched setup).
+// The tasks are C functions and don't throw, and parallel_for runs the tasks on this thread when it can't start threads, so it throws only
+// if it fails to allocate its bookkeeping. Then the tasks that didn't complete run here, so none of them runs twice
+static void paillier_parallel_for(void* /*executor*/, uint32_t count, paillier_task_t task, void* arg)
+{
+    std::unique_ptr<uint8_t[]> done(new (std::nothrow) uint8_t[count]());
+    if (!done)
+    {
+        for (uint32_t i = 0; i < count; i++)
+            task(arg, i);
+        return;
+    }
+
+    try
+    {
+        parallel_for(count, [task, arg, &done](size_t i)
+        {
+            task(arg, (uint32_t)i);
+            done[i] = 1;
+        });
+    }
+    catch (...)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!done[i])
+                task(arg, i);
+        }
+    }
+}
+
 static inline const char* to_string(cosigner_sign_algorithm algorithm)
 {
     switch (algorithm)
@@ -214,17 +248,22 @@ void cmp_setup_service::verify_setup_proofs(const std::string& key_id, const std
     auxiliary_keys aux;
     _key_persistency.load_auxiliary_keys(key_id, aux);
 
+    std::vector<std::pair<const cmp_player_info*, byte_vector_t*>> others;
+    others.reserve(metadata.players_info.size());
     for (auto i = metadata.players_info.begin(); i != metadata.players_info.end(); ++i)
     {
-        if (i->first == my_id)
-            continue;
+        if (i->first != my_id)
+            others.emplace_back(&i->second, &paillier_large_factor_proofs[i->first]);
+    }
 
+    parallel_for(others.size(), [&](size_t i)
+    {
         uint32_t len = 0;
-        range_proof_paillier_large_factors_zkp_generate(aux.paillier.get(), i->second.ring_pedersen.get(), aad.data(), aad.size(), NULL, 0, &len);
-        auto& buffer = paillier_large_factor_proofs[i->first];
+        range_proof_paillier_large_factors_zkp_generate(aux.paillier.get(), others[i].first->ring_pedersen.get(), aad.data(), aad.size(), NULL, 0, &len);
+        auto& buffer = *others[i].second;
         buffer.resize(len);
-        throw_cosigner_exception(range_proof_paillier_large_factors_zkp_generate(aux.paillier.get(), i->second.ring_pedersen.get(), aad.data(), aad.size(), buffer.data(), buffer.size(), &len));
-    }
+        throw_cosigner_exception(range_proof_paillier_large_factors_zkp_generate(aux.paillier.get(), others[i].first->ring_pedersen.get(), aad.data(), aad.size(), buffer.data(), buffer.size(), &len));
+    });
 }
 
 void cmp_setup_service::create_secret(const std::string& key_id, const std::map<uint64_t, std::map<uint64_t, byte_vector_t>>& paillier_large_factor_proofs, std::string& public_key, cosigner_sign_algorithm& algorithm)
@@ -291,6 +330,119 @@ void cmp_setup_service::create_secret(const std::string& key_id, const std::map<
     LOG_INFO("key share created for keyid %s, and algorithm %s", key_id.c_str(), to_string(metadata.algorithm));
 }
 
+// runs func(key_id, input, output) for every key of the batch concurrently, each key succeeds or fails on its own. Only the outputs of the
+// keys that succeeded are added to out, and the ids of the keys that failed are returned. Nothing is deleted for the failed keys, they are
+// left as the single key round leaves them (a key may even not belong to the batch, e.g. an already existing key id)
+template<typename IN, typename OUT, typename F>
+static std::vector<std::string> run_setup_batch(const std::map<std::string, IN>& in, std::map<std::string, OUT>& out, F&& func)
+{
+    std::vector<typename std::map<std::string, IN>::const_iterator> inputs;
+    inputs.reserve(in.size());
+    for (auto i = in.begin(); i != in.end(); ++i)
+        inputs.push_back(i);
+
+    // the outputs are kept aside as out can't be modified concurrently
+    std::vector<OUT> outputs(inputs.size());
+    std::vector<uint8_t> failed(inputs.size(), 0);
+    parallel_for(inputs.size(), [&](size_t i)
+    {
+        const std::string& key_id = inputs[i]->first;
+        try
+        {
+            func(key_id, inputs[i]->second, outputs[i]);
+        }
+        catch (const cosigner_exception& e)
+        {
+            LOG_ERROR("setup of keyid %s failed, error %d", key_id.c_str(), e.error_code());
+            failed[i] = 1;
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("setup of keyid %s failed, error %s", key_id.c_str(), e.what());
+            failed[i] = 1;
+        }
+        catch (...)
+        {
+            LOG_ERROR("setup of keyid %s failed, unknown error", key_id.c_str());
+            failed[i] = 1;
+        }
+    });
+
+    std::vector<std::string> failed_key_ids;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (failed[i])
+            failed_key_ids.push_back(inputs[i]->first);
+        else
+            out[inputs[i]->first] = std::move(outputs[i]);
+    }
+    return failed_key_ids;
+}
+
+std::vector<std::string> cmp_setup_service::generate_setup_commitments_batch(const std::vector<std::string>& key_ids, const std::string& tenant_id, cosigner_sign_algorithm algorithm, const std::vector<uint64_t>& players_ids, uint8_t t, uint64_t ttl, 
+    std::map<std::string, commitment>& setup_commitments)
+{
+    if (key_ids.empty())
+    {
+        LOG_ERROR("got empty setup batch");
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    std::map<std::string, uint8_t> distinct_key_ids;
+    for (auto it = key_ids.begin(); it != key_ids.end(); ++it)
+        distinct_key_ids.emplace(*it, 0);
+    if (distinct_key_ids.size() != key_ids.size())
+    {
+        LOG_ERROR("Received setup batch with duplicated key id, batch size %lu but only %lu uniq ones", key_ids.size(), distinct_key_ids.size());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    return run_setup_batch(distinct_key_ids, setup_commitments, [&](const std::string& key_id, uint8_t, commitment& setup_commitment)
+    {
+        generate_setup_commitments(key_id, tenant_id, algorithm, players_ids, t, ttl, share_derivation_args(), setup_commitment);
+    });
+}
+
+std::vector<std::string> cmp_setup_service::store_setup_commitments_batch(const std::map<std::string, std::map<uint64_t, commitment>>& commitments, std::map<std::string, setup_decommitment>& decommitments)
+{
+    return run_setup_batch(commitments, decommitments, [&](const std::string& key_id, const std::map<uint64_t, commitment>& key_commitments, setup_decommitment& decommitment)
+    {
+        store_setup_commitments(key_id, key_commitments, decommitment);
+    });
+}
+
+std::vector<std::string> cmp_setup_service::generate_setup_proofs_batch(const std::map<std::string, std::map<uint64_t, setup_decommitment>>& decommitments, std::map<std::string, setup_zk_proofs>& proofs)
+{
+    return run_setup_batch(decommitments, proofs, [&](const std::string& key_id, const std::map<uint64_t, setup_decommitment>& key_decommitments, setup_zk_proofs& key_proofs)
+    {
+        generate_setup_proofs(key_id, key_decommitments, key_proofs);
+    });
+}
+
+std::vector<std::string> cmp_setup_service::verify_setup_proofs_batch(const std::map<std::string, std::map<uint64_t, setup_zk_proofs>>& proofs, std::map<std::string, std::map<uint64_t, byte_vector_t>>& paillier_large_factor_proofs)
+{
+    return run_setup_batch(proofs, paillier_large_factor_proofs, [&](const std::string& key_id, const std::map<uint64_t, setup_zk_proofs>& key_proofs, std::map<uint64_t, byte_vector_t>& key_large_factor_proofs)
+    {
+        verify_setup_proofs(key_id, key_proofs, key_large_factor_proofs);
+    });
+}
+
+std::vector<std::string> cmp_setup_service::create_secret_batch(const std::map<std::string, std::map<uint64_t, std::map<uint64_t, byte_vector_t>>>& paillier_large_factor_proofs, std::map<std::string, std::string>& public_keys, 
+    std::map<std::string, cosigner_sign_algorithm>& algorithms)
+{
+    std::map<std::string, std::pair<std::string, cosigner_sign_algorithm>> results;
+    auto failed_key_ids = run_setup_batch(paillier_large_factor_proofs, results, [&](const std::string& key_id, const std::map<uint64_t, std::map<uint64_t, byte_vector_t>>& key_proofs, std::pair<std::string, cosigner_sign_algorithm>& result)
+    {
+        create_secret(key_id, key_proofs, result.first, result.second);
+    });
+    for (auto i = results.begin(); i != results.end(); ++i)
+    {
+        public_keys[i->first] = std::move(i->second.first);
+        algorithms[i->first] = i->second.second;
+    }
+    return failed_key_ids;
+}
+
 void cmp_setup_service::add_user_request(const std::string& key_id, cosigner_sign_algorithm algorithm, const std::string& new_key_id, const std::vector<uint64_t>& players_ids, uint8_t t, add_user_data& data)
 {
     verify_tenant_id(_service, _key_persistency, key_id);
@@ -448,6 +600,9 @@ void cmp_setup_service::add_user(const std::string& tenant_id, const std::string
             LOG_ERROR("Player %" PRIu64 " didnt send share to me", i->first);
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
+        // the shares are an additive (n of n) split without polynom commitments, so there are no feldman proofs to verify here
+        // (verifiable_secret_sharing_verify_shares_batch doesn't apply), the new shares are verified by verify_setup_proofs which checks
+        // that the sum of the new public shares is the original public key
         auto share = _service.decrypt_message(it->second);
         throw_cosigner_exception(algebra->add_scalars(algebra, &key, key, sizeof(elliptic_curve256_scalar_t), (const uint8_t*)share.data(), share.size()));
     }
@@ -468,7 +623,7 @@ void cmp_setup_service::generate_setup_commitments(const std::string& key_id, co
 
     throw_cosigner_exception(algebra->generator_mul(algebra, &temp_data.public_key.data, &key));
     _service.gen_random(sizeof(commitments_sha256_t), temp_data.seed);
-    auxiliary_keys aux = create_auxiliary_keys();
+    auxiliary_keys aux = _aux_keys_pool ? _aux_keys_pool->get() : create_auxiliary_keys();
     
     uint64_t my_id = _service.get_id_from_keyid(key_id);
     setup_decommitment decommitment;
@@ -575,7 +730,7 @@ void cmp_setup_service::serialize_auxiliary_keys_zkp(const auxiliary_keys& aux,
     uint32_t size = 0;
     paillier_generate_paillier_blum_zkp(aux.paillier.get(), aad.data(), aad.size(), NULL, 0, &size);
     paillier_blum_zkp.resize(size);
-    if (paillier_generate_paillier_blum_zkp(aux.paillier.get(), aad.data(), aad.size(), paillier_blum_zkp.data(), paillier_blum_zkp.size(), &size) != PAILLIER_SUCCESS)
+    if (paillier_generate_paillier_blum_zkp_parallel(aux.paillier.get(), aad.data(), aad.size(), paillier_blum_zkp.data(), paillier_blum_zkp.size(), &size, paillier_parallel_for, NULL) != PAILLIER_SUCCESS)
     {
         LOG_ERROR("failed to generate paillier blum zkp");
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
@@ -680,7 +835,11 @@ void cmp_setup_service::verify_and_load_setup_decommitments(const std::string& k
 
         auto& info = players_info.at(i->first);
         memcpy(info.public_share.data, decommit_it->second.share.X.data, sizeof(elliptic_curve256_point_t));
-        deserialize_auxiliary_keys(i->first, decommit_it->second.paillier_public_key, info.paillier, decommit_it->second.ring_pedersen_public_key, info.ring_pedersen);
+        std::shared_ptr<paillier_public_key_t> paillier;
+        std::shared_ptr<ring_pedersen_public_t> ring_pedersen;
+        deserialize_auxiliary_keys(i->first, decommit_it->second.paillier_public_key, paillier, decommit_it->second.ring_pedersen_public_key, ring_pedersen);
+        info.paillier = paillier;
+        info.ring_pedersen = ring_pedersen;
     }
 }
 
@@ -715,6 +874,8 @@ void cmp_setup_service::verify_setup_proofs(const std::string& key_id, const cmp
     
     auto algebra = get_algebra(metadata.algorithm);
     uint64_t my_id = _service.get_id_from_keyid(key_id);
+    std::vector<std::pair<uint64_t, const setup_zk_proofs*>> others;
+    others.reserve(metadata.players_info.size());
     for (auto i = metadata.players_info.begin(); i != metadata.players_info.end(); ++i)
     {
         auto proof = proofs.find(i->first);
@@ -723,34 +884,41 @@ void cmp_setup_service::verify_setup_proofs(const std::string& key_id, const cmp
             LOG_ERROR("missing proof from player %" PRIu64, i->first);
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
-        if (i->first == my_id)
-            continue;
+        if (i->first != my_id)
+            others.emplace_back(i->first, &proof->second);
+    }
 
-        auto aad = build_aad(key_id, i->first, metadata.seed);
+    // the players proofs are verified concurrently, if several are invalid the error of the player with the lowest id is reported
+    parallel_for(others.size(), [&](size_t idx)
+    {
+        const uint64_t id = others[idx].first;
+        const setup_zk_proofs& proof = *others[idx].second;
+        const cmp_player_info& player = metadata.players_info.at(id);
+        auto aad = build_aad(key_id, id, metadata.seed);
         schnorr_zkp_t schnorr;
-        memcpy(schnorr.R, temp_data.players_schnorr_R.at(i->first).data, sizeof(elliptic_curve256_point_t));
-        memcpy(schnorr.s, proof->second.schnorr_s.data, sizeof(elliptic_curve256_scalar_t));
-        auto status = schnorr_zkp_verify(algebra, aad.data(), aad.size(), &i->second.public_share.data, &schnorr);
+        memcpy(schnorr.R, temp_data.players_schnorr_R.at(id).data, sizeof(elliptic_curve256_point_t));
+        memcpy(schnorr.s, proof.schnorr_s.data, sizeof(elliptic_curve256_scalar_t));
+        auto status = schnorr_zkp_verify(algebra, aad.data(), aad.size(), &player.public_share.data, &schnorr);
         if (status != ZKP_SUCCESS)
         {
-            LOG_ERROR("Failed to verify schnorr zkp from player %" PRIu64, i->first);
+            LOG_ERROR("Failed to verify schnorr zkp from player %" PRIu64, id);
             throw_cosigner_exception(status);
         }
 
-        auto paillier_status = paillier_verify_paillier_blum_zkp(i->second.paillier.get(), aad.data(), aad.size(), proof->second.paillier_blum_zkp.data(), proof->second.paillier_blum_zkp.size());
+        auto paillier_status = paillier_verify_paillier_blum_zkp(player.paillier.get(), aad.data(), aad.size(), proof.paillier_blum_zkp.data(), proof.paillier_blum_zkp.size());
         if (paillier_status != PAILLIER_SUCCESS)
         {
-            LOG_ERROR("Failed to verify paillier blum zkp from player %" PRIu64, i->first);
+            LOG_ERROR("Failed to verify paillier blum zkp from player %" PRIu64, id);
             throw_paillier_exception(paillier_status);
         }
 
-        status = ring_pedersen_parameters_zkp_verify(i->second.ring_pedersen.get(), aad.data(), aad.size(), proof->second.ring_pedersen_param_zkp.data(), proof->second.ring_pedersen_param_zkp.size());
+        status = ring_pedersen_parameters_zkp_verify(player.ring_pedersen.get(), aad.data(), aad.size(), proof.ring_pedersen_param_zkp.data(), proof.ring_pedersen_param_zkp.size());
         if (status != ZKP_SUCCESS)
         {
-            LOG_ERROR("Failed to verify ring pedersen parameters zkp from player %" PRIu64, i->first);
+            LOG_ERROR("Failed to verify ring pedersen parameters zkp from player %" PRIu64, id);
             throw_cosigner_exception(status);   
         }
-    }
+    });
 }
 
 std::vector<uint8_t> cmp_setup_service::build_aad(const std::string& sid, uint64_t id, const commitments_sha256_t srid)
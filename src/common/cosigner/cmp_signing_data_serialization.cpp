@@ -0,0 +1,171 @@
+#include "cosigner/cmp_signing_data_serialization.h"
+#include "cosigner/cosigner_exception.h"
+#include "serialization.h"
+#include "logging/logging_t.h"
+
+#include <assert.h>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+using wire_format::writer;
+using wire_format::reader;
+using wire_format::HEADER_SIZE;
+using wire_format::serialized_size;
+
+static_assert(HEADER_SIZE == CMP_SIGNING_DATA_SECRET_OFFSET, "the secret region must follow the header");
+
+enum CMP_SIGNING_DATA_TYPE
+{
+    ECDSA_SIGNING_DATA              = 1,
+    SIGNATURE_PREPROCESSED_DATA     = 2
+};
+
+static inline void get_scalar(reader& r, elliptic_curve_scalar& val)
+{
+    memcpy(val.data, r.take(sizeof(elliptic_curve256_scalar_t)), sizeof(elliptic_curve256_scalar_t));
+}
+
+static inline void get_point(reader& r, elliptic_curve_point& val)
+{
+    memcpy(val.data, r.take(sizeof(elliptic_curve256_point_t)), sizeof(elliptic_curve256_point_t));
+}
+
+void serialize_ecdsa_signing_data(const ecdsa_signing_data& data, byte_vector_t& buffer)
+{
+    size_t size = HEADER_SIZE + CMP_ECDSA_SIGNING_DATA_SECRET_SIZE + sizeof(elliptic_curve256_point_t) + serialized_size(data.mta_request);
+    size += sizeof(uint32_t);
+    for (auto it = data.G_proofs.begin(); it != data.G_proofs.end(); ++it)
+        size += sizeof(uint64_t) + serialized_size(it->second);
+    size += sizeof(uint32_t);
+    for (auto it = data.public_data.begin(); it != data.public_data.end(); ++it)
+        size += sizeof(uint64_t) + 4 * sizeof(elliptic_curve256_point_t) + serialized_size(it->second.gamma_commitment);
+
+    buffer.resize(size);
+    writer w(buffer.data());
+    w.put_header(CMP_SIGNING_DATA_FORMAT_VERSION, ECDSA_SIGNING_DATA);
+    w.put_raw(data.k.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.gamma.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.a.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.b.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.delta.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.chi.data, sizeof(elliptic_curve256_scalar_t));
+    assert(w.ptr() == buffer.data() + CMP_SIGNING_DATA_SECRET_OFFSET + CMP_ECDSA_SIGNING_DATA_SECRET_SIZE);
+
+    w.put_raw(data.GAMMA.data, sizeof(elliptic_curve256_point_t));
+    w.put_bytes(data.mta_request);
+    w.put_uint32(data.G_proofs.size());
+    for (auto it = data.G_proofs.begin(); it != data.G_proofs.end(); ++it)
+    {
+        w.put_uint64(it->first);
+        w.put_bytes(it->second);
+    }
+    w.put_uint32(data.public_data.size());
+    for (auto it = data.public_data.begin(); it != data.public_data.end(); ++it)
+    {
+        w.put_uint64(it->first);
+        w.put_raw(it->second.A.data, sizeof(elliptic_curve256_point_t));
+        w.put_raw(it->second.B.data, sizeof(elliptic_curve256_point_t));
+        w.put_raw(it->second.Z.data, sizeof(elliptic_curve256_point_t));
+        w.put_raw(it->second.GAMMA.data, sizeof(elliptic_curve256_point_t));
+        w.put_bytes(it->second.gamma_commitment);
+    }
+    assert(w.ptr() == buffer.data() + buffer.size());
+}
+
+void deserialize_ecdsa_signing_data(const uint8_t* buffer, size_t size, ecdsa_signing_data& data)
+{
+    if (!buffer)
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    reader r(buffer, buffer + size);
+    r.get_header(CMP_SIGNING_DATA_FORMAT_VERSION, ECDSA_SIGNING_DATA);
+    get_scalar(r, data.k);
+    get_scalar(r, data.gamma);
+    get_scalar(r, data.a);
+    get_scalar(r, data.b);
+    get_scalar(r, data.delta);
+    get_scalar(r, data.chi);
+    get_point(r, data.GAMMA);
+    data.mta_request = r.get_bytes().to_vector();
+
+    uint32_t count = r.get_uint32();
+    data.G_proofs.clear();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t id = r.get_uint64();
+        if (!data.G_proofs.emplace(id, r.get_bytes().to_vector()).second)
+        {
+            LOG_ERROR("got duplicate G proof for player %" PRIu64, id);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+    }
+
+    count = r.get_uint32();
+    data.public_data.clear();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t id = r.get_uint64();
+        auto res = data.public_data.try_emplace(id);
+        if (!res.second)
+        {
+            LOG_ERROR("got duplicate public data for player %" PRIu64, id);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+        auto& pub = res.first->second;
+        get_point(r, pub.A);
+        get_point(r, pub.B);
+        get_point(r, pub.Z);
+        get_point(r, pub.GAMMA);
+        pub.gamma_commitment = r.get_bytes().to_vector();
+    }
+
+    if (r.remaining())
+    {
+        LOG_ERROR("ecdsa signing data has %lu trailing bytes", r.remaining());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+}
+
+void serialize_signature_preprocessed_data(const cmp_signature_preprocessed_data& data, uint8_t* buffer, size_t size)
+{
+    if (!buffer || size < CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE)
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    writer w(buffer);
+    w.put_header(CMP_SIGNING_DATA_FORMAT_VERSION, SIGNATURE_PREPROCESSED_DATA);
+    w.put_raw(data.k.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.chi.data, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.R.data, sizeof(elliptic_curve256_point_t));
+    w.put_raw(data.r_info.r, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(data.r_info.positive_r, sizeof(elliptic_curve256_scalar_t));
+    w.put_raw(&data.r_info.v, sizeof(uint8_t));
+    w.put_raw(&data.r_info.positive_v, sizeof(uint8_t));
+    w.put_raw(&data.r_info.positive_r_multiplier, sizeof(uint8_t));
+    assert(w.ptr() == buffer + CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE);
+}
+
+void deserialize_signature_preprocessed_data(const uint8_t* buffer, size_t size, cmp_signature_preprocessed_data& data)
+{
+    if (!buffer || size != CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE)
+    {
+        LOG_ERROR("invalid preprocessed data size %lu, expected %lu", size, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+    reader r(buffer, buffer + size);
+    r.get_header(CMP_SIGNING_DATA_FORMAT_VERSION, SIGNATURE_PREPROCESSED_DATA);
+    get_scalar(r, data.k);
+    get_scalar(r, data.chi);
+    get_point(r, data.R);
+    memcpy(data.r_info.r, r.take(sizeof(elliptic_curve256_scalar_t)), sizeof(elliptic_curve256_scalar_t));
+    memcpy(data.r_info.positive_r, r.take(sizeof(elliptic_curve256_scalar_t)), sizeof(elliptic_curve256_scalar_t));
+    data.r_info.v = *r.take(sizeof(uint8_t));
+    data.r_info.positive_v = *r.take(sizeof(uint8_t));
+    data.r_info.positive_r_multiplier = *r.take(sizeof(uint8_t));
+}
+
+}
+}
+}
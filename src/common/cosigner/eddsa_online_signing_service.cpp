@@ -115,9 +115,6 @@ void eddsa_online_signing_service::start_signing(const std::string& key_id, cons
         eddsa_signature_data sigdata;
         throw_cosigner_exception(_ed25519->generator_mul(_ed25519.get(), &sigdata.R.data, &k));
         throw_cosigner_exception(ed25519_algebra_be_to_le(&sigdata.k.data, &k));
-        commitment commit;
-        throw_cosigner_exception(commitments_create_commitment_for_data(sigdata.R.data, sizeof(elliptic_curve256_point_t), &commit.data));
-        commitments.push_back(commit);
 
         sigdata.message = data.blocks[i].data;
         sigdata.path = data.blocks[i].path;
@@ -125,6 +122,19 @@ void eddsa_online_signing_service::start_signing(const std::string& key_id, cons
         info.sig_data.push_back(sigdata);
     }
     OPENSSL_cleanse(k, sizeof(elliptic_curve256_scalar_t));
+
+    if (blocks)
+    {
+        std::vector<const uint8_t*> Rs(blocks);
+        std::vector<uint32_t> sizes(blocks, sizeof(elliptic_curve256_point_t));
+        std::vector<commitments_commitment_t> commits(blocks);
+        for (size_t i = 0; i < blocks; i++)
+            Rs[i] = info.sig_data[i].R.data;
+        throw_cosigner_exception(commitments_create_commitments_batch(Rs.data(), sizes.data(), blocks, commits.data()));
+        for (size_t i = 0; i < blocks; i++)
+            commitments.push_back(commitment(&commits[i]));
+    }
+
     std::vector<uint32_t> flags(blocks, 0);
     _service.fill_signing_info_from_metadata(metadata_json, flags);
     for (size_t i = 0; i < blocks; i++)
@@ -174,11 +184,20 @@ uint64_t eddsa_online_signing_service::store_commitments(const std::string& txid
     assert(my_commit != commitments.end()); //should have been validated by the previous for loop
     R.reserve(data.sig_data.size());
 
-    for (size_t i = 0; i < data.sig_data.size(); ++i)
+    if (!data.sig_data.empty())
     {
-        throw_cosigner_exception(commitments_verify_commitment(data.sig_data[i].R.data, sizeof(elliptic_curve256_point_t), &my_commit->second[i].data));
-        R.push_back(data.sig_data[i].R);
+        std::vector<const uint8_t*> Rs(data.sig_data.size());
+        std::vector<uint32_t> sizes(data.sig_data.size(), sizeof(elliptic_curve256_point_t));
+        std::vector<commitments_commitment_t> commits(data.sig_data.size());
+        for (size_t i = 0; i < data.sig_data.size(); ++i)
+        {
+            Rs[i] = data.sig_data[i].R.data;
+            commits[i] = my_commit->second[i].data;
+        }
+        throw_cosigner_exception(commitments_verify_commitments_batch(Rs.data(), sizes.data(), data.sig_data.size(), commits.data()));
     }
+    for (size_t i = 0; i < data.sig_data.size(); ++i)
+        R.push_back(data.sig_data[i].R);
 
     if (data.version != version)
     {
@@ -233,13 +252,20 @@ uint64_t eddsa_online_signing_service::broadcast_si(const std::string& txid, con
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
 
+        if (data.sig_data.empty())
+            continue;
+        std::vector<const uint8_t*> player_Rs(data.sig_data.size());
+        std::vector<uint32_t> sizes(data.sig_data.size(), sizeof(elliptic_curve256_point_t));
+        std::vector<commitments_commitment_t> commits(data.sig_data.size());
         for (size_t j = 0; j < data.sig_data.size(); ++j)
         {
-            if (commitments_verify_commitment(it->second[j].data, sizeof(elliptic_curve256_point_t), &i->second[j].data) != COMMITMENTS_SUCCESS)
-            {
-                LOG_ERROR("failed to verify gamma commitment for player %" PRIu64, i->first);
-                throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
-            }
+            player_Rs[j] = it->second[j].data;
+            commits[j] = i->second[j].data;
+        }
+        if (commitments_verify_commitments_batch(player_Rs.data(), sizes.data(), data.sig_data.size(), commits.data()) != COMMITMENTS_SUCCESS)
+        {
+            LOG_ERROR("failed to verify gamma commitment for player %" PRIu64, i->first);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
     }
 
@@ -248,6 +274,8 @@ uint64_t eddsa_online_signing_service::broadcast_si(const std::string& txid, con
     ed25519_algebra_ctx_t* ed25519 = (ed25519_algebra_ctx_t*)_ed25519->ctx;
     static const PrivKey ZERO = {0};
 
+    std::vector<elliptic_curve256_scalar_t> deltas(data.sig_data.size());
+    std::vector<ed25519_point_t> derived_public_keys(data.sig_data.size());
     for (size_t i = 0; i < data.sig_data.size(); ++i)
     {
         bool first = true;
@@ -263,34 +291,66 @@ uint64_t eddsa_online_signing_service::broadcast_si(const std::string& txid, con
                 throw_cosigner_exception(_ed25519->add_points(_ed25519.get(), &data.sig_data[i].R.data, &data.sig_data[i].R.data, &j->second[i].data));
         }
 
-        elliptic_curve256_scalar_t delta;
         elliptic_curve256_point_t derived_public_key;
         // hd_derive_status derivation_status = derive_public_key_generic(_ed25519.get(), derived_public_key, metadata.public_key, data.chaincode, data.sig_data[i].path.data(), data.sig_data[i].path.size());
-        hd_derive_status derivation_status = derive_private_and_public_keys(_ed25519.get(), delta, derived_public_key, metadata.public_key, ZERO, data.chaincode, data.sig_data[i].path.data(), data.sig_data[i].path.size());
+        hd_derive_status derivation_status = derive_private_and_public_keys(_ed25519.get(), deltas[i], derived_public_key, metadata.public_key, ZERO, data.chaincode, data.sig_data[i].path.data(), data.sig_data[i].path.size());
         if (derivation_status != HD_DERIVE_SUCCESS)
         {
             LOG_ERROR("failed to derive public key for block %lu, error %d", i, derivation_status);
             throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
         }
+        memcpy(derived_public_keys[i], derived_public_key, sizeof(ed25519_point_t));
+    }
 
-        ed25519_le_scalar_t k;
-        throw_cosigner_exception(ed25519_calc_hram(ed25519, &k, (const ed25519_point_t*)&data.sig_data[i].R.data, (const ed25519_point_t*)&derived_public_key, (const uint8_t*)data.sig_data[i].message.data(), data.sig_data[i].message.size(), data.sig_data[i].flags & EDDSA_KECCAK));
-
-        if (data.signers_ids.size() > 1)
+    // the keccak hrams of all blocks are hashed together so the permutations run in parallel lanes
+    std::vector<ed25519_le_scalar_t> hrams(data.sig_data.size());
+    for (uint8_t use_keccak = 0; use_keccak < 2; ++use_keccak)
+    {
+        std::vector<uint32_t> indexes;
+        std::vector<ed25519_point_t> R(data.sig_data.size());
+        std::vector<ed25519_point_t> public_keys(data.sig_data.size());
+        std::vector<const uint8_t*> messages;
+        std::vector<uint32_t> sizes;
+        for (size_t i = 0; i < data.sig_data.size(); ++i)
         {
-            elliptic_curve256_scalar_t inv = {0};
-            inv[sizeof(elliptic_curve256_scalar_t) - 1] = (uint8_t)data.signers_ids.size();
-            throw_cosigner_exception(ed25519_algebra_inverse(ed25519, &inv, &inv));
-            throw_cosigner_exception(ed25519_algebra_mul_scalars(ed25519, &delta, delta, sizeof(elliptic_curve256_scalar_t), inv, sizeof(elliptic_curve256_scalar_t)));
+            if (((data.sig_data[i].flags & EDDSA_KECCAK) != 0) != (use_keccak != 0))
+                continue;
+            memcpy(R[indexes.size()], data.sig_data[i].R.data, sizeof(ed25519_point_t));
+            memcpy(public_keys[indexes.size()], derived_public_keys[i], sizeof(ed25519_point_t));
+            messages.push_back((const uint8_t*)data.sig_data[i].message.data());
+            sizes.push_back(data.sig_data[i].message.size());
+            indexes.push_back(i);
         }
+        if (indexes.empty())
+            continue;
+
+        std::vector<ed25519_le_scalar_t> batch_hrams(indexes.size());
+        throw_cosigner_exception(ed25519_calc_hram_batch(ed25519, batch_hrams.data(), R.data(), public_keys.data(), messages.data(), sizes.data(), indexes.size(), use_keccak));
+        for (size_t j = 0; j < indexes.size(); ++j)
+            memcpy(hrams[indexes[j]], batch_hrams[j], sizeof(ed25519_le_scalar_t));
+    }
 
+    elliptic_curve_scalar key;
+    cosigner_sign_algorithm algo;
+    _key_persistency.load_key(data.key_id, algo, key.data);
+
+    // the scalars stay little endian for the whole round, the key and the inverse of the signers count (the same for all blocks) are converted once
+    elliptic_curve_scalar key_le;
+    throw_cosigner_exception(ed25519_algebra_be_to_le(&key_le.data, &key.data));
+    elliptic_curve_scalar signers_count_inv;
+    signers_count_inv.data[sizeof(elliptic_curve256_scalar_t) - 1] = (uint8_t)data.signers_ids.size();
+    if (data.signers_ids.size() > 1)
+        throw_cosigner_exception(ed25519_algebra_inverse(ed25519, &signers_count_inv.data, &signers_count_inv.data));
+    throw_cosigner_exception(ed25519_algebra_be_to_le(&signers_count_inv.data, &signers_count_inv.data));
+
+    for (size_t i = 0; i < data.sig_data.size(); ++i)
+    {
+        // x = delta / signers_count + key
         elliptic_curve_scalar x;
-        cosigner_sign_algorithm algo;
-        _key_persistency.load_key(data.key_id, algo, x.data);
-        throw_cosigner_exception(ed25519_algebra_add_scalars(ed25519, &x.data, delta, sizeof(elliptic_curve256_scalar_t), x.data, sizeof(elliptic_curve256_scalar_t)));
-        throw_cosigner_exception(ed25519_algebra_be_to_le(&x.data, &x.data));
+        throw_cosigner_exception(ed25519_algebra_be_to_le(&x.data, &deltas[i]));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ed25519, &x.data, &x.data, &signers_count_inv.data, &key_le.data));
         elliptic_curve_scalar s;
-        throw_cosigner_exception(ed25519_algebra_mul_add(ed25519, &s.data, &k, &x.data, &data.sig_data[i].k.data));
+        throw_cosigner_exception(ed25519_algebra_mul_add(ed25519, &s.data, &hrams[i], &x.data, &data.sig_data[i].k.data));
         throw_cosigner_exception(ed25519_algebra_le_to_be(&data.sig_data[i].s.data, &s.data));
         si.push_back(data.sig_data[i].s);
     }
@@ -352,14 +412,17 @@ uint64_t eddsa_online_signing_service::get_eddsa_signature(const std::string& tx
             throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
         }
 
-        elliptic_curve256_scalar_t s_sum = {0};
-
-        for (auto i = s.begin(); i != s.end(); ++i)
-            throw_cosigner_exception(algebra->add_scalars(algebra, &s_sum, s_sum, sizeof(elliptic_curve256_scalar_t), i->second[index].data, sizeof(elliptic_curve256_scalar_t)));
-        
+        // the sum is computed little endian, as the signature s is
         eddsa_signature cur_sig;
         memcpy(cur_sig.R, data.sig_data[index].R.data, sizeof(ed25519_point_t));
-        ed25519_algebra_be_to_le(&cur_sig.s, &s_sum);
+        memset(cur_sig.s, 0, sizeof(ed25519_le_scalar_t));
+
+        for (auto i = s.begin(); i != s.end(); ++i)
+        {
+            ed25519_le_scalar_t player_s;
+            throw_cosigner_exception(ed25519_algebra_be_to_le(&player_s, &i->second[index].data));
+            throw_cosigner_exception(ed25519_algebra_add_le_scalars(ed25519, &cur_sig.s, &cur_sig.s, &player_s));
+        }
 
         // verify signature
         elliptic_curve256_point_t derived_public_key;
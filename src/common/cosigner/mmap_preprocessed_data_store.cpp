@@ -0,0 +1,361 @@
+#include "cosigner/mmap_preprocessed_data_store.h"
+#include "cosigner/cmp_signature_preprocessed_data.h"
+#include "cosigner/cmp_signing_data_serialization.h"
+#include "cosigner/cosigner_exception.h"
+#include "logging/logging_t.h"
+
+#include <openssl/crypto.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bitset>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+
+// file layout:
+// header (padded to FILE_ALIGNMENT) | slots bitmap (padded to FILE_ALIGNMENT) | records
+// integers are stored in host byte order, the alignment is fixed so the files can be moved between machines with different page sizes
+static constexpr const char FILE_MAGIC[8] = {'M', 'P', 'C', 'P', 'R', 'E', 'S', 'G'};
+static constexpr const uint32_t FILE_FORMAT_VERSION = 1;
+static constexpr const uint64_t FILE_ALIGNMENT = 4096;
+static constexpr const char FILE_SUFFIX[] = ".presig";
+
+struct file_header
+{
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+};
+
+static_assert(sizeof(file_header) <= FILE_ALIGNMENT, "file header must fit in a single block");
+
+static inline uint64_t align(uint64_t size)
+{
+    return (size + FILE_ALIGNMENT - 1) & ~(FILE_ALIGNMENT - 1);
+}
+
+static inline uint64_t bitmap_size(uint64_t capacity)
+{
+    return align((capacity + 7) / 8);
+}
+
+static inline uint64_t file_size(uint64_t capacity)
+{
+    return FILE_ALIGNMENT + bitmap_size(capacity) + align(capacity * CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE);
+}
+
+struct mmap_preprocessed_data_store::mapped_file
+{
+    mapped_file(int fd, uint8_t* base, uint64_t size, uint64_t capacity) : fd(fd), base(base), size(size), capacity(capacity), count(0)
+    {
+        bitmap = base + FILE_ALIGNMENT;
+        records = bitmap + bitmap_size(capacity);
+        for (uint64_t i = 0; i < (capacity + 7) / 8; i++)
+            count += std::bitset<8>(bitmap[i]).count();
+    }
+
+    ~mapped_file()
+    {
+        munmap(base, size);
+        close(fd); // releases the flock
+    }
+
+    bool is_set(uint64_t index) const {return bitmap[index / 8] & (1 << (index % 8));}
+    uint8_t* record(uint64_t index) {return records + index * CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE;}
+
+    // sets or clears the slot bit and synchronously flushes it to disk
+    void set(uint64_t index, bool value)
+    {
+        if (value)
+            bitmap[index / 8] |= (1 << (index % 8));
+        else
+            bitmap[index / 8] &= ~(1 << (index % 8));
+        sync(bitmap + index / 8, 1, MS_SYNC);
+    }
+
+    void sync(uint8_t* ptr, size_t len, int flags)
+    {
+        static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+        uintptr_t start = (uintptr_t)ptr & ~(page_size - 1);
+        if (msync((void*)start, (uintptr_t)ptr + len - start, flags) != 0)
+        {
+            LOG_ERROR("failed to sync preprocessed data file, error %d", errno);
+            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+        }
+    }
+
+    const int fd;
+    uint8_t* const base;
+    const uint64_t size;
+    const uint64_t capacity;
+    uint8_t* bitmap;
+    uint8_t* records;
+    uint64_t count;
+    std::mutex lock;
+};
+
+mmap_preprocessed_data_store::mmap_preprocessed_data_store(const std::string& directory) : _directory(directory)
+{
+    struct stat st;
+    if (stat(directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        LOG_ERROR("preprocessed data store directory %s doesn't exist", directory.c_str());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+}
+
+mmap_preprocessed_data_store::~mmap_preprocessed_data_store()
+{
+}
+
+void mmap_preprocessed_data_store::create_preprocessed_data(const std::string& key_id, uint64_t size)
+{
+    if (!size || size > (UINT64_MAX / 2) / CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE)
+    {
+        LOG_ERROR("invalid preprocessed data size %lu", size);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+
+    std::lock_guard<std::mutex> lg(_lock);
+    auto it = _files.find(key_id);
+    if (it != _files.end())
+    {
+        if (it->second->capacity != size)
+        {
+            LOG_ERROR("preprocessed data for key %s already exists with size %lu", key_id.c_str(), it->second->capacity);
+            throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+        }
+        return;
+    }
+
+    std::string path = file_path(key_id);
+    auto load_existing = [&](int fd)
+    {
+        auto file = map_file(path, fd);
+        if (file->capacity != size)
+        {
+            LOG_ERROR("preprocessed data for key %s already exists with size %lu", key_id.c_str(), file->capacity);
+            throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
+        }
+        _files.emplace(key_id, file);
+    };
+
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        load_existing(fd);
+        return;
+    }
+
+    // the file is created and allocated in full under a unique temporary name and linked to its final name when complete, so a crash
+    // never leaves a partial file and concurrent creators never touch each other's temporary file
+    std::string tmp_path = path + ".XXXXXX";
+    fd = mkstemp(&tmp_path[0]);
+    if (fd < 0)
+    {
+        LOG_ERROR("failed to create preprocessed data file %s, error %d", tmp_path.c_str(), errno);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+
+    uint64_t total_size = file_size(size);
+    file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_FORMAT_VERSION;
+    header.record_size = CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE;
+    header.capacity = size;
+
+    // lock the file before writing it and before it's visible, so no other process can map it before us
+    bool ok = fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+    ok = ok && flock(fd, LOCK_EX | LOCK_NB) == 0;
+    ok = ok && ftruncate(fd, total_size) == 0;
+#ifdef __linux__
+    // reserve the blocks now, otherwise writing to the mapping of a sparse file on a full disk raises SIGBUS
+    ok = ok && posix_fallocate(fd, 0, total_size) == 0;
+#endif
+    ok = ok && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    ok = ok && fsync(fd) == 0;
+    // unlike rename, link never replaces a file created concurrently by another creator
+    bool exists = false;
+    if (ok && link(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        exists = errno == EEXIST;
+        ok = false;
+    }
+    int err = errno;
+    unlink(tmp_path.c_str());
+    if (!ok)
+    {
+        close(fd);
+        if (exists)
+        {
+            LOG_WARN("preprocessed data file %s was created concurrently", path.c_str());
+            fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd < 0)
+            {
+                LOG_ERROR("failed to open preprocessed data file %s, error %d", path.c_str(), errno);
+                throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            }
+            load_existing(fd);
+            return;
+        }
+        LOG_ERROR("failed to allocate preprocessed data file %s, error %d", path.c_str(), err);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+
+    int dir_fd = open(_directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dir_fd >= 0)
+    {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    _files.emplace(key_id, map_file(path, fd));
+}
+
+void mmap_preprocessed_data_store::store_preprocessed_data(const std::string& key_id, uint64_t index, const cmp_signature_preprocessed_data& data)
+{
+    auto file = get_file(key_id);
+    std::lock_guard<std::mutex> lg(file->lock);
+    if (index >= file->capacity)
+    {
+        LOG_ERROR("index %lu is out of range, key %s has %lu slots", index, key_id.c_str(), file->capacity);
+        throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
+    }
+
+    // when overriding a slot it's invalidated first, so a crash during the write never leaves a valid slot with a torn record
+    if (file->is_set(index))
+    {
+        file->set(index, false);
+        --file->count;
+    }
+    uint8_t* record = file->record(index);
+    serialize_signature_preprocessed_data(data, record, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE);
+    file->sync(record, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE, MS_SYNC);
+    file->set(index, true);
+    ++file->count;
+}
+
+void mmap_preprocessed_data_store::load_preprocessed_data(const std::string& key_id, uint64_t index, cmp_signature_preprocessed_data& data)
+{
+    auto file = get_file(key_id);
+    std::lock_guard<std::mutex> lg(file->lock);
+    if (index >= file->capacity || !file->is_set(index))
+    {
+        LOG_ERROR("no preprocessed data found for key %s at index %lu", key_id.c_str(), index);
+        throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
+    }
+
+    uint8_t* record = file->record(index);
+    deserialize_signature_preprocessed_data(record, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE, data);
+    // the slot must be durably cleared before the data is used
+    file->set(index, false);
+    --file->count;
+    OPENSSL_cleanse(record, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE);
+    file->sync(record, CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE, MS_ASYNC);
+}
+
+void mmap_preprocessed_data_store::delete_preprocessed_data(const std::string& key_id)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    _files.erase(key_id);
+    std::string path = file_path(key_id);
+    if (unlink(path.c_str()) != 0 && errno != ENOENT)
+    {
+        LOG_ERROR("failed to delete preprocessed data file %s, error %d", path.c_str(), errno);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+}
+
+uint64_t mmap_preprocessed_data_store::count(const std::string& key_id)
+{
+    auto file = get_file(key_id);
+    std::lock_guard<std::mutex> lg(file->lock);
+    return file->count;
+}
+
+std::shared_ptr<mmap_preprocessed_data_store::mapped_file> mmap_preprocessed_data_store::get_file(const std::string& key_id)
+{
+    std::lock_guard<std::mutex> lg(_lock);
+    auto it = _files.find(key_id);
+    if (it != _files.end())
+        return it->second;
+
+    std::string path = file_path(key_id);
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR("no preprocessed data found for key %s", key_id.c_str());
+        throw cosigner_exception(cosigner_exception::BAD_KEY);
+    }
+    auto file = map_file(path, fd);
+    _files.emplace(key_id, file);
+    return file;
+}
+
+std::string mmap_preprocessed_data_store::file_path(const std::string& key_id) const
+{
+    static const char HEX[] = "0123456789abcdef";
+    // the key id is hex encoded so any key id maps to a valid file name
+    std::string path = _directory + "/";
+    path.reserve(path.size() + key_id.size() * 2 + sizeof(FILE_SUFFIX));
+    for (auto c : key_id)
+    {
+        path.push_back(HEX[(uint8_t)c >> 4]);
+        path.push_back(HEX[(uint8_t)c & 0xf]);
+    }
+    path.append(FILE_SUFFIX);
+    return path;
+}
+
+std::shared_ptr<mmap_preprocessed_data_store::mapped_file> mmap_preprocessed_data_store::map_file(const std::string& path, int fd)
+{
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        LOG_ERROR("preprocessed data file %s is used by another process", path.c_str());
+        close(fd);
+        throw cosigner_exception(cosigner_exception::BUSY);
+    }
+
+    file_header header;
+    struct stat st;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header) || fstat(fd, &st) != 0)
+    {
+        LOG_ERROR("failed to read preprocessed data file %s, error %d", path.c_str(), errno);
+        close(fd);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+
+    if (memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_FORMAT_VERSION ||
+        header.record_size != CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE || !header.capacity ||
+        header.capacity > (UINT64_MAX / 2) / CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE || (uint64_t)st.st_size != file_size(header.capacity))
+    {
+        LOG_ERROR("preprocessed data file %s is corrupted", path.c_str());
+        close(fd);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+
+    void* base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        LOG_ERROR("failed to map preprocessed data file %s, error %d", path.c_str(), errno);
+        close(fd);
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+    }
+    return std::make_shared<mapped_file>(fd, (uint8_t*)base, st.st_size, header.capacity);
+}
+
+}
+}
+}
@@ -1,6 +1,8 @@
 #include "mta.h"
+#include "utils.h"
 #include "cosigner/cmp_key_persistency.h"
 #include "cosigner/cosigner_exception.h"
+#include "cosigner/player_map.h"
 #include "crypto/zero_knowledge_proof/range_proofs.h"
 #include "crypto/drng/drng.h"
 #include "../crypto/paillier/paillier_internal.h"
@@ -14,6 +16,7 @@
 #include <openssl/bn.h>
 #include <openssl/rand.h>
 #include <openssl/err.h>
+#include <openssl/crypto.h>
 
 #include <assert.h>
 #include <inttypes.h>
@@ -73,13 +76,18 @@ struct mta_range_zkp
     }
 };
 
-static inline void genarate_mta_range_zkp_seed(const cmp_mta_message& response, const mta_range_zkp& proof, const std::vector<uint8_t>& aad, uint8_t *seed)
+static inline void init_mta_range_zkp_seed(SHA256_CTX& ctx, const std::vector<uint8_t>& aad)
 {
-    SHA256_CTX ctx;
-    
     SHA256_Init(&ctx);
     SHA256_Update(&ctx, MTA_ZKP_SALT, sizeof(MTA_ZKP_SALT));
     SHA256_Update(&ctx, aad.data(), aad.size());
+}
+
+// seed_prefix is the context created by init_mta_range_zkp_seed, it can be shared by all the proofs using the same aad
+static inline void genarate_mta_range_zkp_seed(const SHA256_CTX& seed_prefix, const cmp_mta_message& response, const mta_range_zkp& proof, uint8_t *seed)
+{
+    SHA256_CTX ctx = seed_prefix;
+    
     SHA256_Update(&ctx, response.message.data(), response.message.size());
     SHA256_Update(&ctx, response.commitment.data(), response.commitment.size());
     uint32_t max_size = std::max(BN_num_bytes(proof.A), BN_num_bytes(proof.By)); // we assome the the paillier n is larger then ring pedersen n
@@ -102,6 +110,13 @@ static inline void genarate_mta_range_zkp_seed(const cmp_mta_message& response,
     SHA256_Final(seed, &ctx);
 }
 
+static inline void genarate_mta_range_zkp_seed(const cmp_mta_message& response, const mta_range_zkp& proof, const std::vector<uint8_t>& aad, uint8_t *seed)
+{
+    SHA256_CTX ctx;
+    init_mta_range_zkp_seed(ctx, aad);
+    genarate_mta_range_zkp_seed(ctx, response, proof, seed);
+}
+
 static inline uint32_t exponent_zkpok_serialized_size(const ring_pedersen_public_t* ring_pedersen, const paillier_private_key_t* private_key, const paillier_public_key_t* public_key)
 {
     return 
@@ -223,41 +238,36 @@ static inline void deserialize_mta_range_zkp(std::vector<uint8_t> buff, const ri
 }
 
 static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algebra_ctx_t* algebra, const ring_pedersen_public_t* ring_pedersen, const paillier_private_key_t* private_key, const paillier_public_key_t* public_key, 
-    const std::vector<uint8_t>& aad, const BIGNUM* x, const BIGNUM* y, const BIGNUM* mta_request, const BIGNUM* mta_response_r, const paillier_ciphertext_t* commitment, const cmp_mta_message& response)
+    const SHA256_CTX& seed_prefix, const BIGNUM* x, const BIGNUM* y, const BIGNUM* mta_request, const BIGNUM* mta_response_r, const BIGNUM* commitment_r, const cmp_mta_message& response, BN_CTX* ctx)
 {
-    std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-
-    if (!ctx)
-        throw cosigner_exception(cosigner_exception::NO_MEM);
-    
-    if (is_coprime_fast(mta_response_r, public_key->n, ctx.get()) != 1)
+    if (is_coprime_fast(mta_response_r, public_key->n, ctx) != 1)
     {
         LOG_ERROR("mta response r is not coprime to verifier paillier public key");
         throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
     }
 
-    if (is_coprime_fast(commitment->r, private_key->pub.n, ctx.get()) != 1)
+    if (is_coprime_fast(commitment_r, private_key->pub.n, ctx) != 1)
     {
         LOG_ERROR("commitment r is not coprime to prover paillier public key");
         throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
     }
 
-    bn_ctx_frame ctx_guard(ctx.get());
-    BIGNUM* alpha = BN_CTX_get(ctx.get());
-    BIGNUM* beta = BN_CTX_get(ctx.get());
-    BIGNUM* r = BN_CTX_get(ctx.get());
-    BIGNUM* ry = BN_CTX_get(ctx.get());
-    BIGNUM* gamma = BN_CTX_get(ctx.get());
-    BIGNUM* delta = BN_CTX_get(ctx.get());
-    BIGNUM* mu = BN_CTX_get(ctx.get());
-    BIGNUM* nu = BN_CTX_get(ctx.get());
-    BIGNUM* e = BN_CTX_get(ctx.get());
-    BIGNUM* tmp = BN_CTX_get(ctx.get());
+    bn_ctx_frame ctx_guard(ctx);
+    BIGNUM* alpha = BN_CTX_get(ctx);
+    BIGNUM* beta = BN_CTX_get(ctx);
+    BIGNUM* r = BN_CTX_get(ctx);
+    BIGNUM* ry = BN_CTX_get(ctx);
+    BIGNUM* gamma = BN_CTX_get(ctx);
+    BIGNUM* delta = BN_CTX_get(ctx);
+    BIGNUM* mu = BN_CTX_get(ctx);
+    BIGNUM* nu = BN_CTX_get(ctx);
+    BIGNUM* e = BN_CTX_get(ctx);
+    BIGNUM* tmp = BN_CTX_get(ctx);
     
     if (!alpha || !beta|| !r || !ry || !gamma || !delta || !mu || !nu || !e || !tmp)
         throw cosigner_exception(cosigner_exception::NO_MEM);
 
-    mta_range_zkp proof(ctx.get());
+    mta_range_zkp proof(ctx);
 
     const BIGNUM* q = algebra->order_internal(algebra);
 
@@ -293,7 +303,7 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
             LOG_ERROR("Failed to rand r error %lu", ERR_get_error());
             throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
         }
-        paillier_status = paillier_encrypt_openssl_internal(public_key, proof.A, r, beta, ctx.get());
+        paillier_status = paillier_encrypt_openssl_internal(public_key, proof.A, r, beta, ctx);
     } while (paillier_status == PAILLIER_ERROR_INVALID_RANDOMNESS);
     
     if (paillier_status != PAILLIER_SUCCESS)
@@ -302,7 +312,7 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
 
-    if (!BN_mod_exp(tmp, mta_request, alpha, public_key->n2, ctx.get()) || !BN_mod_mul(proof.A, proof.A, tmp, public_key->n2, ctx.get()))
+    if (!BN_mod_exp_mont(tmp, mta_request, alpha, public_key->n2, ctx, public_key->mont_n2) || !BN_mod_mul(proof.A, proof.A, tmp, public_key->n2, ctx))
     {
         LOG_ERROR("Failed to calc A error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
@@ -315,7 +325,7 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
             LOG_ERROR("Failed to rand ry error %lu", ERR_get_error());
             throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
         }
-        paillier_status = paillier_encrypt_openssl_internal(&private_key->pub, proof.By, ry, beta, ctx.get());
+        paillier_status = paillier_encrypt_openssl_internal(&private_key->pub, proof.By, ry, beta, ctx);
     } while (paillier_status == PAILLIER_ERROR_INVALID_RANDOMNESS);
     
     if (paillier_status != PAILLIER_SUCCESS)
@@ -324,25 +334,25 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
 
-    auto rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, alpha, gamma, proof.E, ctx.get());
+    auto rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, alpha, gamma, proof.E, ctx);
     if (rp_status != RING_PEDERSEN_SUCCESS)
     {
         LOG_ERROR("Failed to create alpha commitment error %d", rp_status);
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, x, mu, proof.S, ctx.get());
+    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, x, mu, proof.S, ctx);
     if (rp_status != RING_PEDERSEN_SUCCESS)
     {
         LOG_ERROR("Failed to create x commitment error %d", rp_status);
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, beta, delta, proof.F, ctx.get());
+    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, beta, delta, proof.F, ctx);
     if (rp_status != RING_PEDERSEN_SUCCESS)
     {
         LOG_ERROR("Failed to create beta commitment error %d", rp_status);
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, y, nu, proof.T, ctx.get());
+    rp_status = ring_pedersen_create_commitment_internal(ring_pedersen, y, nu, proof.T, ctx);
     if (rp_status != RING_PEDERSEN_SUCCESS)
     {
         LOG_ERROR("Failed to create y commitment error %d", rp_status);
@@ -350,7 +360,7 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
     }
     
     elliptic_curve256_scalar_t alpha_bin;
-    if (!BN_mod(tmp, alpha, q, ctx.get()))
+    if (!BN_mod(tmp, alpha, q, ctx))
     {
         LOG_ERROR("Failed to to alpha mod q error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
@@ -366,7 +376,7 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
 
     // sample e
     uint8_t seed[SHA256_DIGEST_LENGTH];
-    genarate_mta_range_zkp_seed(response, proof, aad, seed);
+    genarate_mta_range_zkp_seed(seed_prefix, response, proof, seed);
 
     drng_t* rng = NULL;
     if (drng_new(seed, SHA256_DIGEST_LENGTH, &rng) != DRNG_SUCCESS)
@@ -388,33 +398,33 @@ static std::vector<uint8_t> mta_range_generate_zkp(const elliptic_curve256_algeb
     } while (BN_cmp(e, q) >= 0);
     drng_guard.reset();
 
-    if (!BN_mul(proof.z1, e, x, ctx.get()) || !BN_add(proof.z1, proof.z1, alpha))
+    if (!BN_mul(proof.z1, e, x, ctx) || !BN_add(proof.z1, proof.z1, alpha))
     {
         LOG_ERROR("Failed to calc z1, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    if (!BN_mul(proof.z2, e, y, ctx.get()) || !BN_add(proof.z2, proof.z2, beta))
+    if (!BN_mul(proof.z2, e, y, ctx) || !BN_add(proof.z2, proof.z2, beta))
     {
         LOG_ERROR("Failed to calc z2, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    if (!BN_mul(proof.z3, e, mu, ctx.get()) || !BN_add(proof.z3, proof.z3, gamma))
+    if (!BN_mul(proof.z3, e, mu, ctx) || !BN_add(proof.z3, proof.z3, gamma))
     {
         LOG_ERROR("Failed to calc z3, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    if (!BN_mul(proof.z4, e, nu, ctx.get()) || !BN_add(proof.z4, proof.z4, delta))
+    if (!BN_mul(proof.z4, e, nu, ctx) || !BN_add(proof.z4, proof.z4, delta))
     {
         LOG_ERROR("Failed to calc z4, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
 
-    if (!BN_mod_exp(proof.w, mta_response_r, e, public_key->n, ctx.get()) || !BN_mod_mul(proof.w, proof.w, r, public_key->n, ctx.get()))
+    if (!BN_mod_exp(proof.w, mta_response_r, e, public_key->n, ctx) || !BN_mod_mul(proof.w, proof.w, r, public_key->n, ctx))
     {
         LOG_ERROR("Failed to calc w, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    if (!BN_mod_exp(proof.wy, commitment->r, e, private_key->pub.n, ctx.get()) || !BN_mod_mul(proof.wy, proof.wy, ry, private_key->pub.n, ctx.get()))
+    if (!BN_mod_exp(proof.wy, commitment_r, e, private_key->pub.n, ctx) || !BN_mod_mul(proof.wy, proof.wy, ry, private_key->pub.n, ctx))
     {
         LOG_ERROR("Failed to calc wy, error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
@@ -436,7 +446,8 @@ cmp_mta_message request(const uint64_t my_id,
                         const std::shared_ptr<paillier_public_key_t>& paillier, //from key setup
                         const std::map<uint64_t, cmp_player_info>& players,     //maps all parties (players) ids to parameters from key setup phase
                         std::map<uint64_t, byte_vector_t>& proofs,              //output map all all parties (players) ids to Rddh proof messages
-                        std::map<uint64_t, byte_vector_t>& G_proofs)            //output map all all parties (players) ids to "log" proof messages
+                        std::map<uint64_t, byte_vector_t>& G_proofs,            //output map all all parties (players) ids to "log" proof messages
+                        bool parallel)                                          //generate the proofs concurrently
 {
     cmp_mta_message mta;
     paillier_ciphertext_t *ciphertext = NULL; //will hold paillier encrypted k. Called K in the document
@@ -459,32 +470,67 @@ cmp_mta_message request(const uint64_t my_id,
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
     
+    // the proofs are generated into a flat map of the verifiers, which is fully created before the tasks start so it isn't modified
+    // concurrently (inserting to player_map invalidates the references to its elements), and then moved to the output maps
+    struct verifier_proofs
+    {
+        const ring_pedersen_public_t* ring_pedersen;
+        byte_vector_t proof;
+        byte_vector_t G_proof;
+    };
+    player_map<verifier_proofs> verifiers;
+    verifiers.reserve(players.size());
     for (auto i = players.begin(); i != players.end(); ++i)
     {
-        if (i->first == my_id)
-            continue;
+        if (i->first != my_id)
+            verifiers[i->first].ring_pedersen = i->second.ring_pedersen.get();
+    }
+
+    // task 2 * i generates the rddh proof for the i-th verifier and task 2 * i + 1 generates its log proof
+    auto generate_proof = [&](size_t task)
+    {
+        verifier_proofs& verifier = (verifiers.begin() + task / 2)->second;
+        const ring_pedersen_public_t* ring_pedersen = verifier.ring_pedersen;
         uint32_t len = 0;
-        range_proof_diffie_hellman_zkpok_generate(i->second.ring_pedersen.get(), paillier.get(), algebra, aad.data(), aad.size(), &k.data, &a.data, &b.data, ciphertext, NULL, 0, &len);
-        auto& proof = proofs[i->first];
-        proof.resize(len);
-        auto status = range_proof_diffie_hellman_zkpok_generate(i->second.ring_pedersen.get(), paillier.get(), algebra, aad.data(), aad.size(), &k.data, &a.data, &b.data, ciphertext, proof.data(), proof.size(), &len);
-        if (status != ZKP_SUCCESS)
+        if (task % 2 == 0)
         {
-            LOG_ERROR("Failed to generate rddh zkp status: %d", status);
-            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            range_proof_diffie_hellman_zkpok_generate(ring_pedersen, paillier.get(), algebra, aad.data(), aad.size(), &k.data, &a.data, &b.data, ciphertext, NULL, 0, &len);
+            auto& proof = verifier.proof;
+            proof.resize(len);
+            auto status = range_proof_diffie_hellman_zkpok_generate(ring_pedersen, paillier.get(), algebra, aad.data(), aad.size(), &k.data, &a.data, &b.data, ciphertext, proof.data(), proof.size(), &len);
+            if (status != ZKP_SUCCESS)
+            {
+                LOG_ERROR("Failed to generate rddh zkp status: %d", status);
+                throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            }
         }
-
-        len = 0;
-        range_proof_paillier_exponent_zkpok_generate(i->second.ring_pedersen.get(), paillier.get(), algebra, aad.data(), aad.size(), &gamma.data, commitment, NULL, 0, &len);
-        auto& G_proof = G_proofs[i->first];
-        G_proof.resize(len);
-        status = range_proof_paillier_exponent_zkpok_generate(i->second.ring_pedersen.get(), paillier.get(), algebra, aad.data(), aad.size(), &gamma.data, commitment, G_proof.data(), G_proof.size(), &len);
-        if (status != ZKP_SUCCESS)
+        else
         {
-            LOG_ERROR("Failed to generate log zkp status: %d", status);
-            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            range_proof_paillier_exponent_zkpok_generate(ring_pedersen, paillier.get(), algebra, aad.data(), aad.size(), &gamma.data, commitment, NULL, 0, &len);
+            auto& G_proof = verifier.G_proof;
+            G_proof.resize(len);
+            auto status = range_proof_paillier_exponent_zkpok_generate(ring_pedersen, paillier.get(), algebra, aad.data(), aad.size(), &gamma.data, commitment, G_proof.data(), G_proof.size(), &len);
+            if (status != ZKP_SUCCESS)
+            {
+                LOG_ERROR("Failed to generate log zkp status: %d", status);
+                throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+            }
         }
+    };
+
+    if (parallel)
+        parallel_for(verifiers.size() * 2, generate_proof);
+    else
+    {
+        for (size_t i = 0; i < verifiers.size() * 2; i++)
+            generate_proof(i);
     }
+    for (auto i = verifiers.begin(); i != verifiers.end(); ++i)
+    {
+        proofs[i->first] = std::move(i->second.proof);
+        G_proofs[i->first] = std::move(i->second.G_proof);
+    }
+
     mta.message.resize(BN_num_bytes(ciphertext->ciphertext));
     BN_bn2bin(ciphertext->ciphertext, mta.message.data());
     ciphertext_guard.reset();
@@ -493,67 +539,100 @@ cmp_mta_message request(const uint64_t my_id,
     return mta;
 }
 
-elliptic_curve_scalar answer_mta_request(const elliptic_curve256_algebra_ctx_t* algebra, const cmp_mta_message& request, const uint8_t* secret, uint32_t secret_size, const byte_vector_t& aad, 
-    const std::shared_ptr<paillier_private_key_t>& my_key, const std::shared_ptr<paillier_public_key_t>& paillier, const std::shared_ptr<ring_pedersen_public_t>& ring_pedersen, cmp_mta_message& response)
+// encrypts plaintext using a new random r, r is needed for the range proof
+static void paillier_encrypt_with_new_randomness(const paillier_public_key_t* key, BIGNUM* ciphertext, BIGNUM* r, const BIGNUM* plaintext, BN_CTX* ctx)
 {
-    if (!secret || !secret_size || !my_key || !paillier || !ring_pedersen)
-        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
-    byte_vector_t beta(secret_size * BETA_HIDING_FACTOR);
-    response.message.resize(BN_num_bytes(paillier->n2));
-    if (RAND_bytes(beta.data(), secret_size * BETA_HIDING_FACTOR) != 1)
+    long status;
+    do
     {
-        LOG_ERROR("Failed to rand beta error %lu", ERR_get_error());
-        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
-    }
-    uint32_t len = 0;
-    auto status = paillier_mul(paillier.get(), request.message.data(), request.message.size(), secret, secret_size, response.message.data(), response.message.size(), &len);
+        if (!BN_rand_range(r, key->n))
+        {
+            LOG_ERROR("Failed to rand r error %lu", ERR_get_error());
+            throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+        }
+        status = paillier_encrypt_openssl_internal(key, ciphertext, r, plaintext, ctx);
+    } while (status == PAILLIER_ERROR_INVALID_RANDOMNESS);
+
     if (status != PAILLIER_SUCCESS)
     {
-        LOG_ERROR("Failed to mul ciphertext status: %ld", status);
+        LOG_ERROR("Failed to encrypt beta status: %ld", status);
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    
-    paillier_ciphertext_t* ciphertext = NULL;
-    status = paillier_encrypt_to_ciphertext(paillier.get(), beta.data(), beta.size(), &ciphertext);
-    if (status != PAILLIER_SUCCESS)
+}
+
+// parses the mta request and verifies it's a valid ciphertext, so it can be answered multiple times
+static void parse_mta_request(const paillier_public_key_t* paillier, const cmp_mta_message& request, BIGNUM* req, BN_CTX* ctx)
+{
+    if (request.message.size() > (uint32_t)BN_num_bytes(paillier->n2))
     {
-        LOG_ERROR("Failed to encrypt beta status: %ld", status);
-        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+        LOG_ERROR("Invalid mta request size %lu", request.message.size());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
     }
-    std::unique_ptr<paillier_ciphertext_t, void (*)(paillier_ciphertext_t*)> ciphertext_guard(ciphertext, paillier_free_ciphertext);
-    byte_vector_t tmp(BN_num_bytes(ciphertext->ciphertext));
-    BN_bn2bin(ciphertext->ciphertext, tmp.data());
-    status = paillier_add(paillier.get(), response.message.data(), len, tmp.data(), tmp.size(), response.message.data(), response.message.size(), &len);
-    if (status != PAILLIER_SUCCESS)
+
+    if (!BN_bin2bn(request.message.data(), request.message.size(), req))
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+
+    if (BN_cmp(req, paillier->n2) >= 0 || is_coprime_fast(req, paillier->n, ctx) != 1)
     {
-        LOG_ERROR("Failed to add beta from ciphertext status: %ld", status);
+        LOG_ERROR("Invalid mta request ciphertext");
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    response.message.resize(len);
+}
+
+// answers an mta request already parsed and verified by parse_mta_request
+static elliptic_curve_scalar answer_parsed_mta_request(const elliptic_curve256_algebra_ctx_t* algebra, const BIGNUM* req, const uint8_t* secret, uint32_t secret_size, const SHA256_CTX& seed_prefix, 
+    const paillier_private_key_t* my_key, const paillier_public_key_t* paillier, const ring_pedersen_public_t* ring_pedersen, cmp_mta_message& response, BN_CTX* ctx)
+{
+    if (secret_size > (uint32_t)BN_num_bytes(paillier->n))
+    {
+        LOG_ERROR("Invalid secret size %u", secret_size);
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
 
-    paillier_ciphertext_t* commitment = NULL;
-    status = paillier_encrypt_to_ciphertext(&my_key->pub, beta.data(), beta.size(), &commitment);
-    if (status != PAILLIER_SUCCESS)
+    byte_vector_t beta(secret_size * BETA_HIDING_FACTOR);
+    if (RAND_bytes(beta.data(), secret_size * BETA_HIDING_FACTOR) != 1)
     {
-        LOG_ERROR("Failed to encrypt commitment status: %ld", status);
+        LOG_ERROR("Failed to rand beta error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
     }
-    std::unique_ptr<paillier_ciphertext_t, void (*)(paillier_ciphertext_t*)> commitment_guard(commitment, paillier_free_ciphertext);
-    response.commitment.resize(BN_num_bytes(commitment->ciphertext));
-    BN_bn2bin(commitment->ciphertext, response.commitment.data());
-    
+
+    bn_ctx_frame ctx_guard(ctx);
+    BIGNUM* message = BN_CTX_get(ctx);
+    BIGNUM* encrypted_beta = BN_CTX_get(ctx);
+    BIGNUM* r = BN_CTX_get(ctx);
+    BIGNUM* commitment = BN_CTX_get(ctx);
+    BIGNUM* commitment_r = BN_CTX_get(ctx);
     std::unique_ptr<BIGNUM, void (*)(BIGNUM*)> x(BN_bin2bn(secret, secret_size, NULL), BN_clear_free);
     std::unique_ptr<BIGNUM, void (*)(BIGNUM*)> y(BN_bin2bn(beta.data(), beta.size(), NULL), BN_clear_free);
-    std::unique_ptr<BIGNUM, void (*)(BIGNUM*)> req(BN_bin2bn(request.message.data(), request.message.size(), NULL), BN_free);
-    if (!x || !y || !req)
+    OPENSSL_cleanse(beta.data(), beta.size());
+    if (!message || !encrypted_beta || !r || !commitment || !commitment_r || !x || !y)
         throw cosigner_exception(cosigner_exception::NO_MEM);
+    BN_set_flags(x.get(), BN_FLG_CONSTTIME);
+    
+    // the request was verified by parse_mta_request, so there is no need to use paillier_mul_internal
+    if (!BN_mod_exp_mont(message, req, x.get(), paillier->n2, ctx, paillier->mont_n2))
+    {
+        LOG_ERROR("Failed to mul ciphertext error %lu", ERR_get_error());
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
 
-    response.proof = mta_range_generate_zkp(algebra, ring_pedersen.get(), my_key.get(), paillier.get(), aad, x.get(), y.get(), req.get(), ciphertext->r, commitment, response);
+    paillier_encrypt_with_new_randomness(paillier, encrypted_beta, r, y.get(), ctx);
+    auto status = paillier_add_internal(paillier, message, message, encrypted_beta, ctx);
+    if (status != PAILLIER_SUCCESS)
+    {
+        LOG_ERROR("Failed to add beta from ciphertext status: %ld", status);
+        throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
+    }
+    response.message.resize(BN_num_bytes(message));
+    BN_bn2bin(message, response.message.data());
+
+    paillier_encrypt_with_new_randomness(&my_key->pub, commitment, commitment_r, y.get(), ctx);
+    response.commitment.resize(BN_num_bytes(commitment));
+    BN_bn2bin(commitment, response.commitment.data());
+    
+    response.proof = mta_range_generate_zkp(algebra, ring_pedersen, my_key, paillier, seed_prefix, x.get(), y.get(), req, r, commitment_r, response, ctx);
     const BIGNUM* q = algebra->order_internal(algebra);
-    std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-    if (!ctx)
-        throw cosigner_exception(cosigner_exception::NO_MEM);
-    if (!BN_mod(y.get(), y.get(), q, ctx.get()))
+    if (!BN_mod(y.get(), y.get(), q, ctx))
     {
         LOG_ERROR("Failed to calc beta error %lu", ERR_get_error());
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
@@ -563,6 +642,49 @@ elliptic_curve_scalar answer_mta_request(const elliptic_curve256_algebra_ctx_t*
     return ret;
 }
 
+elliptic_curve_scalar answer_mta_request(const elliptic_curve256_algebra_ctx_t* algebra, const cmp_mta_message& request, const uint8_t* secret, uint32_t secret_size, const byte_vector_t& aad, 
+    const std::shared_ptr<paillier_private_key_t>& my_key, const std::shared_ptr<paillier_public_key_t>& paillier, const std::shared_ptr<ring_pedersen_public_t>& ring_pedersen, cmp_mta_message& response)
+{
+    if (!secret || !secret_size || !my_key || !paillier || !ring_pedersen)
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+
+    // all the paillier operations are done on the parsed BIGNUMs using a single BN_CTX, only the response is serialized
+    std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    if (!ctx)
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+    bn_ctx_frame ctx_guard(ctx.get());
+    BIGNUM* req = BN_CTX_get(ctx.get());
+    if (!req)
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+    parse_mta_request(paillier.get(), request, req, ctx.get());
+
+    SHA256_CTX seed_prefix;
+    init_mta_range_zkp_seed(seed_prefix, aad);
+    return answer_parsed_mta_request(algebra, req, secret, secret_size, seed_prefix, my_key.get(), paillier.get(), ring_pedersen.get(), response, ctx.get());
+}
+
+void answer_mta_requests(const elliptic_curve256_algebra_ctx_t* algebra, const cmp_mta_message& request, const elliptic_curve_scalar* secrets, size_t count, const byte_vector_t& aad, 
+    const std::shared_ptr<paillier_private_key_t>& my_key, const std::shared_ptr<paillier_public_key_t>& paillier, const std::shared_ptr<ring_pedersen_public_t>& ring_pedersen, 
+    cmp_mta_message* responses, elliptic_curve_scalar* betas)
+{
+    if (!secrets || !count || !responses || !betas || !my_key || !paillier || !ring_pedersen)
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+
+    std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    if (!ctx)
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+    bn_ctx_frame ctx_guard(ctx.get());
+    BIGNUM* req = BN_CTX_get(ctx.get());
+    if (!req)
+        throw cosigner_exception(cosigner_exception::NO_MEM);
+    parse_mta_request(paillier.get(), request, req, ctx.get());
+
+    SHA256_CTX seed_prefix;
+    init_mta_range_zkp_seed(seed_prefix, aad);
+    for (size_t i = 0; i < count; i++)
+        betas[i] = answer_parsed_mta_request(algebra, req, secrets[i].data, sizeof(elliptic_curve256_scalar_t), seed_prefix, my_key.get(), paillier.get(), ring_pedersen.get(), responses[i], ctx.get());
+}
+
 elliptic_curve_scalar decrypt_mta_response(uint64_t other_id, const elliptic_curve256_algebra_ctx_t* algebra, byte_vector_t&& response, const std::shared_ptr<paillier_private_key_t>& my_key)
 {
     std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
@@ -1006,13 +1128,6 @@ void batch_response_verifier::process_ring_pedersen(const BIGNUM* e, const mta_r
     gamma[0] &= 0xffffffffff; // 40bits
     gamma[1] &= 0xffffffffff; // 40bits
 
-    auto rp_status = ring_pedersen_init_montgomery(&_my_ring_pedersen->pub, _ctx.get());
-    if (rp_status != RING_PEDERSEN_SUCCESS)
-    {
-        LOG_ERROR("Failed to init ring pedersen motgomery context, error %d", rp_status);
-        throw cosigner_exception(cosigner_exception::NO_MEM);
-    }
-
     // s^z1*t^z3 == E*S^e
     if (!BN_mod_mul(tmp1, _my_ring_pedersen->lamda, proof.z1, _my_ring_pedersen->phi_n, _ctx.get()) || !BN_mod_add(tmp1, tmp1, proof.z3, _my_ring_pedersen->phi_n, _ctx.get()))
     {
@@ -1093,13 +1208,6 @@ void single_response_verifier::process_ring_pedersen(const BIGNUM* e, const mta_
         throw cosigner_exception(cosigner_exception::NO_MEM);
     }
 
-    auto rp_status = ring_pedersen_init_montgomery(&_my_ring_pedersen->pub, _ctx.get());
-    if (rp_status != RING_PEDERSEN_SUCCESS)
-    {
-        LOG_ERROR("Failed to init ring pedersen motgomery context, error %d", rp_status);
-        throw cosigner_exception(cosigner_exception::NO_MEM);
-    }
-
     // s^z1*t^z3 == E*S^e
     // tmp1 = z1* lamda + z3   
     if (!BN_mod_mul(tmp1, _my_ring_pedersen->lamda, proof.z1, _my_ring_pedersen->phi_n, _ctx.get()) || 
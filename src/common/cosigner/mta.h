@@ -34,7 +34,8 @@ cmp_mta_message request(const uint64_t my_id,
                         const std::shared_ptr<paillier_public_key_t>& paillier, 
                         const std::map<uint64_t, cmp_player_info>& players, 
                         std::map<uint64_t, byte_vector_t>& proofs, 
-                        std::map<uint64_t, byte_vector_t>& G_proofs);
+                        std::map<uint64_t, byte_vector_t>& G_proofs, 
+                        bool parallel = false);     // generate the proofs for the other players concurrently, used when latency matters
 
 elliptic_curve_scalar answer_mta_request(const elliptic_curve256_algebra_ctx_t* algebra, 
                                          const cmp_mta_message& request, 
@@ -46,6 +47,19 @@ elliptic_curve_scalar answer_mta_request(const elliptic_curve256_algebra_ctx_t*
                                          const std::shared_ptr<ring_pedersen_public_t>& ring_pedersen, 
                                          cmp_mta_message& response);
 
+// answers count mta requests on the same encrypted request (e.g. k*gamma and k*x), the request is parsed and verified once
+// responses[i] and betas[i] are the response and beta of secrets[i]
+void answer_mta_requests(const elliptic_curve256_algebra_ctx_t* algebra, 
+                         const cmp_mta_message& request, 
+                         const elliptic_curve_scalar* secrets, 
+                         size_t count, 
+                         const byte_vector_t& aad, 
+                         const std::shared_ptr<paillier_private_key_t>& my_key, 
+                         const std::shared_ptr<paillier_public_key_t>& paillier, 
+                         const std::shared_ptr<ring_pedersen_public_t>& ring_pedersen, 
+                         cmp_mta_message* responses, 
+                         elliptic_curve_scalar* betas);
+
 elliptic_curve_scalar decrypt_mta_response(uint64_t other_id, 
                                            const elliptic_curve256_algebra_ctx_t* algebra, 
                                            byte_vector_t&& response, 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "cosigner/cmp_mta_serialization.h"
+#include "cosigner/cosigner_exception.h"
+#include "logging/logging_t.h"
+
+#include <inttypes.h>
+
+namespace fireblocks
+{
+namespace common
+{
+namespace cosigner
+{
+namespace wire_format
+{
+
+// writer and bounds checked reader for the library binary formats, all integers are little endian and every buffer starts with HEADER_SIZE bytes
+// header holding the format version, the buffer type and 2 reserved bytes
+static const size_t HEADER_SIZE = 4;
+
+// size of a length prefixed field
+static inline size_t serialized_size(const byte_vector_t& data)
+{
+    if (data.size() > UINT32_MAX)
+    {
+        LOG_ERROR("field size %lu is too large", data.size());
+        throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+    }
+    return sizeof(uint32_t) + data.size();
+}
+
+class writer
+{
+public:
+    explicit writer(uint8_t* ptr) : _ptr(ptr) {}
+
+    void put_uint32(uint32_t val)
+    {
+        _ptr[0] = val & 0xff;
+        _ptr[1] = (val >> 8) & 0xff;
+        _ptr[2] = (val >> 16) & 0xff;
+        _ptr[3] = (val >> 24) & 0xff;
+        _ptr += sizeof(uint32_t);
+    }
+    void put_uint64(uint64_t val)
+    {
+        put_uint32(val & 0xffffffff);
+        put_uint32(val >> 32);
+    }
+    void put_raw(const void* data, size_t size)
+    {
+        memcpy(_ptr, data, size);
+        _ptr += size;
+    }
+    void put_bytes(const byte_vector_t& data)
+    {
+        put_uint32(data.size());
+        put_raw(data.data(), data.size());
+    }
+    void put_message(const cmp_mta_message& msg)
+    {
+        put_bytes(msg.message);
+        put_bytes(msg.commitment);
+        put_bytes(msg.proof);
+    }
+    void put_header(uint8_t version, uint8_t type)
+    {
+        _ptr[0] = version;
+        _ptr[1] = type;
+        _ptr[2] = 0;
+        _ptr[3] = 0;
+        _ptr += HEADER_SIZE;
+    }
+    uint8_t* ptr() const {return _ptr;}
+
+private:
+    uint8_t* _ptr;
+};
+
+// bounds checked reader, throws cosigner_exception::INVALID_PARAMETERS if the buffer is too short
+class reader
+{
+public:
+    reader(const uint8_t* begin, const uint8_t* end) : _ptr(begin), _end(end) {}
+
+    const uint8_t* take(size_t size)
+    {
+        if ((size_t)(_end - _ptr) < size)
+        {
+            LOG_ERROR("buffer is too short, need %lu bytes but only %ld left", size, (long)(_end - _ptr));
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+        const uint8_t* ret = _ptr;
+        _ptr += size;
+        return ret;
+    }
+    uint32_t get_uint32() {return read_uint32(take(sizeof(uint32_t)));}
+    uint64_t get_uint64() {return read_uint64(take(sizeof(uint64_t)));}
+    const_byte_span get_bytes()
+    {
+        const_byte_span ret;
+        ret.size = get_uint32();
+        ret.data = take(ret.size);
+        return ret;
+    }
+    cmp_mta_message_view get_message()
+    {
+        cmp_mta_message_view ret;
+        ret.message = get_bytes();
+        ret.commitment = get_bytes();
+        ret.proof = get_bytes();
+        return ret;
+    }
+    template<typename T>
+    player_map_view<T> get_map(T (reader::*get_value)())
+    {
+        uint32_t count = get_uint32();
+        const uint8_t* entries = _ptr;
+        uint64_t last_id = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t id = get_uint64();
+            if (i && id <= last_id)
+            {
+                LOG_ERROR("player ids are not sorted, player %" PRIu64 " comes after player %" PRIu64, id, last_id);
+                throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+            }
+            last_id = id;
+            (this->*get_value)();
+        }
+        return player_map_view<T>(entries, count);
+    }
+    void get_header(uint8_t version, uint8_t type)
+    {
+        const uint8_t* header = take(HEADER_SIZE);
+        if (header[0] != version)
+        {
+            LOG_ERROR("unsupported format version %u, expected %u", header[0], version);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+        if (header[1] != type || header[2] || header[3])
+        {
+            LOG_ERROR("got buffer type %u, expected %u", header[1], type);
+            throw cosigner_exception(cosigner_exception::INVALID_PARAMETERS);
+        }
+    }
+    template<typename T>
+    const T* get()
+    {
+        return reinterpret_cast<const T*>(take(sizeof(T)));
+    }
+    size_t remaining() const {return _end - _ptr;}
+
+private:
+    const uint8_t* _ptr;
+    const uint8_t* _end;
+};
+
+}
+}
+}
+}
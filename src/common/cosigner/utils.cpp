@@ -4,6 +4,11 @@
 #include "cosigner/platform_service.h"
 #include "logging/logging_t.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 namespace fireblocks
 {
 namespace common
@@ -21,6 +26,122 @@ void verify_tenant_id(const platform_service& service, const cmp_key_persistency
     }
 }
 
+namespace
+{
+
+// The worker threads of parallel_run. A job lives on its caller stack, the indexes are claimed and completed under the lock, so once all
+// of them completed no worker accesses the job anymore
+class worker_pool
+{
+public:
+    struct job
+    {
+        void (*task)(void*, size_t);
+        void* arg;
+        size_t count;
+        size_t next;
+        size_t completed;
+    };
+
+    ~worker_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lg(_lock);
+            _stop = true;
+        }
+        _work_cv.notify_all();
+        for (auto it = _threads.begin(); it != _threads.end(); ++it)
+            it->join();
+    }
+
+    void run(job& j)
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        start_threads();
+        if (!_threads.empty())
+        {
+            _jobs.push_back(&j);
+            if (j.count > 2)
+                _work_cv.notify_all();
+            else
+                _work_cv.notify_one();
+        }
+
+        // the caller works on its own job as well, so it completes even if all the workers are busy or none could be started
+        bool& in_parallel = in_parallel_for();
+        const bool was_in_parallel = in_parallel;
+        in_parallel = true;
+        while (j.next < j.count)
+            run_one(j, lock);
+        in_parallel = was_in_parallel;
+        _done_cv.wait(lock, [&j]() {return j.completed == j.count;});
+    }
+
+private:
+    // called with the lock held
+    void start_threads()
+    {
+        if (_started)
+            return;
+        _started = true;
+        const unsigned int workers = std::thread::hardware_concurrency();
+        try
+        {
+            for (unsigned int i = 1; i < workers; i++)
+                _threads.emplace_back([this]() {worker();});
+        }
+        catch (...)
+        {
+            // keep the threads already started, the callers run the tasks the workers don't take
+            LOG_WARN("started only %lu of %u parallel_for worker threads", _threads.size(), workers - 1);
+        }
+    }
+
+    // claims the next index of the job and runs it, called with the lock held
+    void run_one(job& j, std::unique_lock<std::mutex>& lock)
+    {
+        const size_t index = j.next++;
+        if (j.next == j.count)
+            _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &j));
+        lock.unlock();
+        j.task(j.arg, index);
+        lock.lock();
+        if (++j.completed == j.count)
+            _done_cv.notify_all();
+    }
+
+    void worker()
+    {
+        in_parallel_for() = true;
+        std::unique_lock<std::mutex> lock(_lock);
+        while (true)
+        {
+            _work_cv.wait(lock, [this]() {return _stop || !_jobs.empty();});
+            if (_stop)
+                return;
+            run_one(*_jobs.front(), lock);
+        }
+    }
+
+    std::mutex _lock;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+    std::deque<job*> _jobs;
+    std::vector<std::thread> _threads;
+    bool _started = false;
+    bool _stop = false;
+};
+
+}
+
+void parallel_run(size_t count, void (*task)(void* arg, size_t index), void* arg)
+{
+    static worker_pool pool;
+    worker_pool::job j = {task, arg, count, 0, 0};
+    if (count)
+        pool.run(j);
+}
+
 }
 }
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <exception>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace fireblocks
 {
@@ -14,6 +18,53 @@ class cmp_key_persistency;
 
 void verify_tenant_id(const platform_service& service, const cmp_key_persistency& key_persistency, const std::string& key_id);
 
+// true while the current thread runs a parallel_for task
+inline bool& in_parallel_for()
+{
+    static thread_local bool value = false;
+    return value;
+}
+
+// Runs task(arg, i) for every i in [0, count) on the calling thread and a process wide pool of up to std::thread::hardware_concurrency() - 1
+// worker threads, which are started on first use and reused by all the later calls. task must not throw. If no worker thread can be
+// started all the tasks run on the calling thread
+void parallel_run(size_t count, void (*task)(void* arg, size_t index), void* arg);
+
+// Runs func(i) for every i in [0, count) using up to std::thread::hardware_concurrency() threads (including the calling one).
+// All the calls complete before it returns, if some of them throw, the exception thrown by the lowest index is rethrown so
+// the reported error doesn't depend on the threads scheduling. A parallel_for called from a parallel_for task runs serially,
+// as the outer one already uses all the cores
+template<typename F>
+void parallel_for(size_t count, F&& func)
+{
+    if (count <= 1 || in_parallel_for() || std::thread::hardware_concurrency() <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(count);
+    auto body = [&](size_t i)
+    {
+        try
+        {
+            func(i);
+        }
+        catch (...)
+        {
+            errors[i] = std::current_exception();
+        }
+    };
+    parallel_run(count, [](void* arg, size_t i) {(*static_cast<decltype(body)*>(arg))(i);}, &body);
+
+    for (auto it = errors.begin(); it != errors.end(); ++it)
+    {
+        if (*it)
+            std::rethrow_exception(*it);
+    }
+}
+
+}
 }
 }
-}
\ No newline at end of file
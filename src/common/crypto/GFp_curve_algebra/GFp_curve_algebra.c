@@ -401,6 +401,62 @@ elliptic_curve_algebra_status GFp_curve_algebra_generator_mul(const GFp_curve_al
     return GFp_curve_algebra_generator_mul_data(ctx, *exp, sizeof(elliptic_curve256_scalar_t), res);
 }
 
+elliptic_curve_algebra_status GFp_curve_algebra_generator_mul_batch(const GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exps, uint32_t count)
+{
+    BN_CTX *bn_ctx = NULL;
+    EC_POINT **points = NULL;
+    BIGNUM *exp = NULL;
+    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+
+    if (!ctx || !res || !exps || !count)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    points = (EC_POINT**)calloc(count, sizeof(EC_POINT*));
+    if (!points)
+        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    bn_ctx = BN_CTX_new();
+    if (!bn_ctx)
+        goto cleanup;
+    BN_CTX_start(bn_ctx);
+    exp = BN_CTX_get(bn_ctx);
+    if (!exp)
+        goto cleanup;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        points[i] = EC_POINT_new(ctx->curve);
+        if (!points[i] || !BN_bin2bn(exps[i], sizeof(elliptic_curve256_scalar_t), exp))
+            goto cleanup;
+        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+        if (!EC_POINT_mul(ctx->curve, points[i], exp, NULL, NULL, bn_ctx))
+            goto cleanup;
+        ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    }
+
+    // the points are in projective coordinates, converting them together costs a single field inversion instead of one per point
+    ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+    if (!EC_POINTs_make_affine(ctx->curve, count, points, bn_ctx))
+        goto cleanup;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        memset(res[i], 0, sizeof(elliptic_curve256_point_t));
+        if (EC_POINT_point2oct(ctx->curve, points[i], POINT_CONVERSION_COMPRESSED, res[i], sizeof(elliptic_curve256_point_t), bn_ctx) <= 0)
+            goto cleanup;
+    }
+    ret = ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+
+cleanup:
+    if (exp)
+        BN_clear(exp);
+    BN_CTX_end(bn_ctx);
+    BN_CTX_free(bn_ctx);
+    for (uint32_t i = 0; i < count; ++i)
+        EC_POINT_clear_free(points[i]);
+    free(points);
+    return ret;
+}
+
 elliptic_curve_algebra_status GFp_curve_algebra_add_points(const GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p1, const elliptic_curve256_point_t *p2)
 {
     BN_CTX *bn_ctx = NULL;
@@ -731,6 +787,122 @@ cleanup:
     return ret;
 }
 
+// Montgomery's trick, all the values are inverted using a single modular inversion of their product and 3 * (count - 1) multiplications.
+// When constant_time is set all the intermediate values (including the prefix products) are BN_FLG_CONSTTIME and the product is blinded
+// with a random value before the inversion. It's used by all the GFp curves, each passes its own order
+static elliptic_curve_algebra_status batch_inverse_mod(const BIGNUM *order, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time)
+{
+    BN_CTX *bn_ctx = NULL;
+    BIGNUM **prefix = NULL;
+    BIGNUM *inv = NULL;
+    BIGNUM *val = NULL;
+    BIGNUM *tmp = NULL;
+    BIGNUM *blinding = NULL;
+    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+
+    bn_ctx = BN_CTX_new();
+    if (!bn_ctx)
+        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+
+    BN_CTX_start(bn_ctx);
+
+    prefix = (BIGNUM**)calloc(count, sizeof(BIGNUM*));
+    if (!prefix)
+        goto cleanup;
+    inv = BN_CTX_get(bn_ctx);
+    val = BN_CTX_get(bn_ctx);
+    tmp = BN_CTX_get(bn_ctx);
+    blinding = BN_CTX_get(bn_ctx);
+    if (!blinding)
+        goto cleanup;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        prefix[i] = BN_CTX_get(bn_ctx);
+        if (!prefix[i])
+            goto cleanup;
+        if (constant_time)
+            BN_set_flags(prefix[i], BN_FLG_CONSTTIME);
+    }
+    if (constant_time)
+    {
+        BN_set_flags(inv, BN_FLG_CONSTTIME);
+        BN_set_flags(val, BN_FLG_CONSTTIME);
+        BN_set_flags(tmp, BN_FLG_CONSTTIME);
+        BN_set_flags(blinding, BN_FLG_CONSTTIME);
+    }
+
+    ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+    // prefix[i] = vals[0] * ... * vals[i]
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!BN_bin2bn(vals[i], sizeof(elliptic_curve256_scalar_t), val))
+            goto cleanup;
+        if (i == 0 ? !BN_nnmod(prefix[0], val, order, bn_ctx) : !BN_mod_mul(prefix[i], prefix[i - 1], val, order, bn_ctx))
+            goto cleanup;
+    }
+
+    if (BN_is_zero(prefix[count - 1]))
+    {
+        ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
+        goto cleanup;
+    }
+
+    if (constant_time)
+    {
+        do
+        {
+            if (!BN_rand_range(blinding, order))
+                goto cleanup;
+        } while (BN_is_zero(blinding));
+        if (!BN_mod_mul(inv, prefix[count - 1], blinding, order, bn_ctx))
+            goto cleanup;
+        if (!BN_mod_inverse(inv, inv, order, bn_ctx))
+            goto cleanup;
+        if (!BN_mod_mul(inv, inv, blinding, order, bn_ctx))
+            goto cleanup;
+    }
+    else if (!BN_mod_inverse(inv, prefix[count - 1], order, bn_ctx))
+        goto cleanup;
+
+    // inv = (vals[0] * ... * vals[i])^-1, so vals[i]^-1 = inv * prefix[i - 1], res may be the same buffer as vals
+    for (uint32_t i = count - 1; i > 0; --i)
+    {
+        if (!BN_bin2bn(vals[i], sizeof(elliptic_curve256_scalar_t), val))
+            goto cleanup;
+        if (!BN_mod_mul(tmp, inv, prefix[i - 1], order, bn_ctx))
+            goto cleanup;
+        if (!BN_mod_mul(inv, inv, val, order, bn_ctx))
+            goto cleanup;
+        if (BN_bn2binpad(tmp, res[i], sizeof(elliptic_curve256_scalar_t)) <= 0)
+            goto cleanup;
+    }
+    if (BN_bn2binpad(inv, res[0], sizeof(elliptic_curve256_scalar_t)) <= 0)
+        goto cleanup;
+    ret = ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+
+cleanup:
+    if (inv)
+        BN_clear(inv);
+    if (tmp)
+        BN_clear(tmp);
+    if (prefix)
+    {
+        for (uint32_t i = 0; i < count && prefix[i]; ++i)
+            BN_clear(prefix[i]);
+        free(prefix);
+    }
+    BN_CTX_end(bn_ctx);
+    BN_CTX_free(bn_ctx);
+    return ret;
+}
+
+elliptic_curve_algebra_status GFp_curve_algebra_batch_inverse(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time)
+{
+    if (!ctx || !res || !vals || !count)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+    return batch_inverse_mod(EC_GROUP_get0_order(ctx->curve), res, vals, count, constant_time);
+}
+
 elliptic_curve_algebra_status GFp_curve_algebra_abs(GFp_curve_algebra_ctx_t *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *val)
 {
     BIGNUM *bn_val = NULL;
@@ -970,6 +1142,14 @@ static elliptic_curve_algebra_status generator_mul(const elliptic_curve256_algeb
     return GFp_curve_algebra_generator_mul(ctx->ctx, res, exp);
 }
 
+static elliptic_curve_algebra_status generator_mul_batch(const elliptic_curve256_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exps, uint32_t count)
+{
+    if (!ctx || (ctx->type != ELLIPTIC_CURVE_SECP256K1 && ctx->type != ELLIPTIC_CURVE_SECP256R1 && ctx->type != ELLIPTIC_CURVE_STARK))
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    return GFp_curve_algebra_generator_mul_batch(ctx->ctx, res, exps, count);
+}
+
 static elliptic_curve_algebra_status add_points(const elliptic_curve256_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p1, const elliptic_curve256_point_t *p2)
 {
     if (!ctx || (ctx->type != ELLIPTIC_CURVE_SECP256K1 && ctx->type != ELLIPTIC_CURVE_SECP256R1 && ctx->type != ELLIPTIC_CURVE_STARK))
@@ -1013,6 +1193,14 @@ static elliptic_curve_algebra_status inverse(const struct elliptic_curve256_alge
     return GFp_curve_algebra_inverse(ctx->ctx, res, val);
 }
 
+static elliptic_curve_algebra_status batch_inverse(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time)
+{
+    if (!ctx || (ctx->type != ELLIPTIC_CURVE_SECP256K1 && ctx->type != ELLIPTIC_CURVE_SECP256R1 && ctx->type != ELLIPTIC_CURVE_STARK))
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    return GFp_curve_algebra_batch_inverse(ctx->ctx, res, vals, count, constant_time);
+}
+
 static elliptic_curve_algebra_status ec_rand(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res)
 {
     if (!ctx || (ctx->type != ELLIPTIC_CURVE_SECP256K1 && ctx->type != ELLIPTIC_CURVE_SECP256R1 && ctx->type != ELLIPTIC_CURVE_STARK))
@@ -1105,6 +1293,8 @@ elliptic_curve256_algebra_ctx_t* elliptic_curve256_new_secp256k1_algebra()
     ctx->rand = ec_rand;
     ctx->reduce = ec_reduce;
     ctx->order_internal = order_internal;
+    ctx->generator_mul_batch = generator_mul_batch;
+    ctx->batch_inverse = batch_inverse;
     return ctx;
 }
 
@@ -1139,6 +1329,8 @@ elliptic_curve256_algebra_ctx_t* elliptic_curve256_new_secp256r1_algebra()
     ctx->rand = ec_rand;
     ctx->reduce = ec_reduce;
     ctx->order_internal = order_internal;
+    ctx->generator_mul_batch = generator_mul_batch;
+    ctx->batch_inverse = batch_inverse;
     return ctx;
 }
 
@@ -1173,5 +1365,7 @@ elliptic_curve256_algebra_ctx_t* elliptic_curve256_new_stark_algebra()
     ctx->rand = ec_rand;
     ctx->reduce = ec_reduce_stark;
     ctx->order_internal = order_internal;
+    ctx->generator_mul_batch = generator_mul_batch;
+    ctx->batch_inverse = batch_inverse;
     return ctx;
 }
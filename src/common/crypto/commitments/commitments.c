@@ -1,5 +1,7 @@
 #include "crypto/commitments/commitments.h"
+#include "crypto/sha256/sha256_batch.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <openssl/sha.h>
 #include <openssl/rand.h>
@@ -44,6 +46,96 @@ commitments_status commitments_verify_commitment(const uint8_t *data, uint32_t d
     return CRYPTO_memcmp(hash, commitment->commitment, sizeof(commitments_sha256_t)) ? COMMITMENTS_INVALID_COMMITMENT : COMMITMENTS_SUCCESS;
 }
 
+// hashes salt || data for each commitment, the caller sets the salts
+static commitments_status hash_commitments_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, const commitments_commitment_t *commitments, sha256_md_t *hashes)
+{
+    sha256_batch_message_t *messages = NULL;
+    sha256_batch_buffer_t *parts = NULL;
+    commitments_status ret = COMMITMENTS_OUT_OF_MEMORY;
+
+    messages = (sha256_batch_message_t*)malloc(count * sizeof(sha256_batch_message_t));
+    parts = (sha256_batch_buffer_t*)malloc(2 * count * sizeof(sha256_batch_buffer_t));
+    if (!messages || !parts)
+        goto cleanup;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        parts[2 * i].data = commitments[i].salt;
+        parts[2 * i].len = sizeof(commitments_sha256_t);
+        parts[2 * i + 1].data = data[i];
+        parts[2 * i + 1].len = data_len[i];
+        messages[i].parts = &parts[2 * i];
+        messages[i].parts_count = 2;
+    }
+    ret = sha256_batch(messages, count, hashes) == SHA256_BATCH_SUCCESS ? COMMITMENTS_SUCCESS : COMMITMENTS_INTERNAL_ERROR;
+
+cleanup:
+    free(messages);
+    free(parts);
+    return ret;
+}
+
+static int valid_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, const commitments_commitment_t *commitments)
+{
+    if (!data || !data_len || !count || !commitments)
+        return 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!data[i] || !data_len[i])
+            return 0;
+    }
+    return 1;
+}
+
+commitments_status commitments_create_commitments_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, commitments_commitment_t *commitments)
+{
+    sha256_md_t *hashes;
+    commitments_status ret;
+    if (!valid_batch(data, data_len, count, commitments))
+        return COMMITMENTS_INVALID_PARAMETER;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!RAND_bytes(commitments[i].salt, sizeof(commitments_sha256_t)))
+            return COMMITMENTS_INTERNAL_ERROR;
+    }
+
+    hashes = (sha256_md_t*)malloc(count * sizeof(sha256_md_t));
+    if (!hashes)
+        return COMMITMENTS_OUT_OF_MEMORY;
+    ret = hash_commitments_batch(data, data_len, count, commitments, hashes);
+    if (ret == COMMITMENTS_SUCCESS)
+    {
+        for (uint32_t i = 0; i < count; i++)
+            memcpy(commitments[i].commitment, hashes[i], sizeof(commitments_sha256_t));
+    }
+    free(hashes);
+    return ret;
+}
+
+commitments_status commitments_verify_commitments_batch(const uint8_t *const *data, const uint32_t *data_len, uint32_t count, const commitments_commitment_t *commitments)
+{
+    sha256_md_t *hashes;
+    commitments_status ret;
+    if (!valid_batch(data, data_len, count, commitments))
+        return COMMITMENTS_INVALID_PARAMETER;
+
+    hashes = (sha256_md_t*)malloc(count * sizeof(sha256_md_t));
+    if (!hashes)
+        return COMMITMENTS_OUT_OF_MEMORY;
+    ret = hash_commitments_batch(data, data_len, count, commitments, hashes);
+    if (ret == COMMITMENTS_SUCCESS)
+    {
+        // all commitments are checked, so the time doesn't depend on which one is invalid
+        uint8_t invalid = 0;
+        for (uint32_t i = 0; i < count; i++)
+            invalid |= CRYPTO_memcmp(hashes[i], commitments[i].commitment, sizeof(commitments_sha256_t)) != 0;
+        ret = invalid ? COMMITMENTS_INVALID_COMMITMENT : COMMITMENTS_SUCCESS;
+    }
+    free(hashes);
+    return ret;
+}
+
 // @audit-ok: RAND_bytes failure properly handled with error propagation
 // ↳ After review: OpenSSL blocks until entropy available, failure indicates system issue
 // ↳ Function correctly returns error on RAND_bytes failure
@@ -16,27 +16,14 @@ typedef struct
   BIGNUM *z[RING_PEDERSEN_STATISTICAL_SECURITY];
 } ring_pedersen_param_proof_t;
 
-// private function to initialize montgomery context implementation
-static inline void ring_pedersen_init_mont(const ring_pedersen_public_t *pub, BN_CTX *ctx)
+ring_pedersen_status ring_pedersen_init_montgomery(ring_pedersen_public_t *pub, BN_CTX *ctx)
 {
+    pub->mont = BN_MONT_CTX_new();
     if (!pub->mont)
-    {
-        ((ring_pedersen_public_t*)pub)->mont = BN_MONT_CTX_new();
-        if (pub->mont)
-        {
-            if (!BN_MONT_CTX_set(pub->mont, pub->n, ctx))
-            {
-                BN_MONT_CTX_free(pub->mont);
-                ((ring_pedersen_public_t*)pub)->mont = NULL;
-            }
-        }
-    }
-}
-
-ring_pedersen_status ring_pedersen_init_montgomery(const ring_pedersen_public_t *pub, BN_CTX *ctx)
-{
-    ring_pedersen_init_mont(pub, ctx);
-    return pub->mont ? RING_PEDERSEN_SUCCESS : RING_PEDERSEN_OUT_OF_MEMORY;
+        return RING_PEDERSEN_OUT_OF_MEMORY;
+    if (!BN_MONT_CTX_set(pub->mont, pub->n, ctx))
+        return RING_PEDERSEN_UNKNOWN_ERROR;
+    return RING_PEDERSEN_SUCCESS;
 }
 
 ring_pedersen_status ring_pedersen_generate_key_pair(uint32_t key_len, ring_pedersen_public_t **pub, ring_pedersen_private_t **priv)
@@ -137,6 +124,14 @@ ring_pedersen_status ring_pedersen_generate_key_pair(uint32_t key_len, ring_pede
         ret = RING_PEDERSEN_OUT_OF_MEMORY;
         goto cleanup;
     }
+
+    // the montgomery contexts are created with the key, as the key may be used concurrently
+    ret = ring_pedersen_init_montgomery(&local_priv->pub, ctx);
+    if (ret != RING_PEDERSEN_SUCCESS)
+        goto cleanup;
+    ret = ring_pedersen_init_montgomery(local_pub, ctx);
+    if (ret != RING_PEDERSEN_SUCCESS)
+        goto cleanup;
     
     *priv = local_priv;
     *pub = local_pub;
@@ -157,7 +152,10 @@ cleanup:
     {
         // handle errors
         if (local_priv)
+        {
+            BN_MONT_CTX_free(local_priv->pub.mont);
             free(local_priv);
+        }
         ring_pedersen_free_public(local_pub); // as the public key uses duplication of p, s and t it's not sefficent just to free it
         BN_free(n);
         BN_free(lamda);
@@ -204,6 +202,8 @@ static uint32_t ring_pedersen_public_deserialize_internal(ring_pedersen_public_t
 {
     uint32_t len = 0;
     const uint8_t *p = buffer;
+    BN_CTX *ctx;
+    ring_pedersen_status status;
 
     pub->mont = NULL;
     if (!buffer || buffer_len < (sizeof(uint32_t) * 3))
@@ -244,6 +244,15 @@ static uint32_t ring_pedersen_public_deserialize_internal(ring_pedersen_public_t
     if (BN_cmp(pub->s, pub->n) > 0 || BN_cmp(pub->t, pub->n) > 0)
         return 0;
 
+    // the montgomery context is created with the key, as the key may be used concurrently
+    ctx = BN_CTX_new();
+    if (!ctx)
+        return 0;
+    status = ring_pedersen_init_montgomery(pub, ctx);
+    BN_CTX_free(ctx);
+    if (status != RING_PEDERSEN_SUCCESS)
+        return 0;
+
     return p - buffer;
 }
 
@@ -533,8 +542,6 @@ zero_knowledge_proof_status ring_pedersen_parameters_zkp_generate(const ring_ped
     
     BN_CTX_start(ctx);
 
-    ring_pedersen_init_mont(&priv->pub, ctx);
-    
     status = init_ring_pedersen_param_zkp(&proof, ctx);
     if (status != ZKP_SUCCESS)
         goto cleanup;
@@ -613,8 +620,6 @@ zero_knowledge_proof_status ring_pedersen_parameters_zkp_verify(const ring_peder
     if (is_coprime_fast(pub->n, pub->t, ctx) != 1)
         goto cleanup;
 
-    ring_pedersen_init_mont(pub, ctx);
-
     if (!deserialize_ring_pedersen_param_zkp(&proof, pub->n, serialized_proof))
         goto cleanup;
     if (!genarate_zkp_seed(pub, &proof, aad, aad_len, seed))
@@ -663,8 +668,6 @@ ring_pedersen_status ring_pedersen_create_commitment_internal(const ring_pederse
     if (!tmp)
         goto cleanup;
 
-    ring_pedersen_init_mont(pub, ctx);
-    
     status = RING_PEDERSEN_UNKNOWN_ERROR;
     if (!BN_mod_exp2_mont(commitment, pub->s, x, pub->t, r, pub->n, ctx, pub->mont))
         goto cleanup;
@@ -740,8 +743,6 @@ static ring_pedersen_status ring_pedersen_verify_commitment_internal(const ring_
     if (!tmp)
         goto cleanup;
 
-    ring_pedersen_init_mont(&priv->pub, ctx);
-    
     status = RING_PEDERSEN_UNKNOWN_ERROR;
     if (!BN_mod_mul(tmp, priv->lamda, x, priv->phi_n, ctx))
         goto cleanup;
@@ -825,7 +826,6 @@ ring_pedersen_status ring_pedersen_verify_batch_commitments_internal(const ring_
         
     BN_one(B);
 
-    ring_pedersen_init_mont(&priv->pub, ctx);
     status = RING_PEDERSEN_UNKNOWN_ERROR;
 
     for (size_t i = 0; i < batch_size; i++)
@@ -895,8 +895,6 @@ ring_pedersen_status ring_pedersen_verify_batch_commitments(const ring_pedersen_
     BN_one(B);
 
     status = RING_PEDERSEN_UNKNOWN_ERROR;
-    ring_pedersen_init_mont(&priv->pub, ctx);
-
     for (size_t i = 0; i < batch_size; i++)
     {
         uint64_t gamma;
@@ -0,0 +1,142 @@
+#include "multi_buffer_hash.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#ifdef MULTI_BUFFER_HASH_X86_64
+#include <cpuid.h>
+#endif
+
+#define MULTI_BUFFER_HASH_CPU_DETECTED (1u << 31)
+
+static unsigned int detect_cpu_features(void)
+{
+    unsigned int features = 0;
+#ifdef MULTI_BUFFER_HASH_X86_64
+    unsigned int eax, ebx, ecx, edx;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        features |= MULTI_BUFFER_HASH_CPU_AVX2;
+    if (__builtin_cpu_supports("avx512f"))
+        features |= MULTI_BUFFER_HASH_CPU_AVX512F;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && ((ebx >> 29) & 1))
+        features |= MULTI_BUFFER_HASH_CPU_SHA_NI;
+#endif
+    return features;
+}
+
+unsigned int multi_buffer_hash_cpu_features(void)
+{
+    // all the threads detect the same features, so a relaxed atomic is enough
+    static atomic_uint cached = 0;
+    unsigned int features = atomic_load_explicit(&cached, memory_order_relaxed);
+    if (!features)
+    {
+        features = detect_cpu_features() | MULTI_BUFFER_HASH_CPU_DETECTED;
+        atomic_store_explicit(&cached, features, memory_order_relaxed);
+    }
+    return features & ~MULTI_BUFFER_HASH_CPU_DETECTED;
+}
+
+typedef struct
+{
+    size_t index;          // index of the message and digest
+    uint64_t length;       // total length of the message parts
+    uint64_t offset;       // bytes of the message already read
+    uint32_t part;
+    size_t part_offset;
+    uint64_t blocks;       // number of blocks including the padding
+    uint64_t block;        // next block to read
+} multi_buffer_hash_lane_t;
+
+static void lane_start(const multi_buffer_hash_t *hash, void *ctx, multi_buffer_hash_lane_t *lane, size_t lane_index, const void *messages, size_t index)
+{
+    const uint32_t parts_count = hash->parts_count(messages, index);
+    lane->index = index;
+    lane->length = 0;
+    for (uint32_t i = 0; i < parts_count; i++)
+        lane->length += hash->part(messages, index, i).len;
+    lane->offset = 0;
+    lane->part = 0;
+    lane->part_offset = 0;
+    lane->blocks = (lane->length + hash->min_padding + hash->block_size - 1) / hash->block_size;
+    lane->block = 0;
+    hash->reset_lane(ctx, lane_index);
+}
+
+static void lane_read_block(const multi_buffer_hash_t *hash, multi_buffer_hash_lane_t *lane, const void *messages, uint8_t *block)
+{
+    const size_t block_size = hash->block_size;
+    const uint64_t pos = lane->block * block_size;
+    size_t filled = 0;
+
+    while (filled < block_size && lane->offset < lane->length)
+    {
+        const multi_buffer_hash_part_t part = hash->part(messages, lane->index, lane->part);
+        size_t n = part.len - lane->part_offset;
+        if (n > block_size - filled)
+            n = block_size - filled;
+        if (n)
+            memcpy(block + filled, part.data + lane->part_offset, n);
+        filled += n;
+        lane->part_offset += n;
+        lane->offset += n;
+        if (lane->part_offset == part.len)
+        {
+            lane->part++;
+            lane->part_offset = 0;
+        }
+    }
+
+    if (filled < block_size)
+    {
+        memset(block + filled, 0, block_size - filled);
+        if (lane->length >= pos && lane->length < pos + block_size)
+            block[lane->length - pos] = hash->pad_byte;
+        if (lane->block == lane->blocks - 1)
+            hash->finish_padding(block, block_size, lane->length);
+    }
+    lane->block++;
+}
+
+void multi_buffer_hash_run(const multi_buffer_hash_t *hash, void *ctx, const void *messages, size_t count)
+{
+    multi_buffer_hash_lane_t lanes[MULTI_BUFFER_HASH_MAX_LANES];
+    uint8_t active[MULTI_BUFFER_HASH_MAX_LANES] = {0};
+    uint8_t block[MULTI_BUFFER_HASH_MAX_BLOCK_SIZE];
+    size_t next = 0;
+
+    for (size_t lane = 0; lane < hash->lanes_count && next < count; lane++, next++)
+    {
+        lane_start(hash, ctx, &lanes[lane], lane, messages, next);
+        active[lane] = 1;
+    }
+
+    while (1)
+    {
+        uint8_t any = 0;
+        for (size_t lane = 0; lane < hash->lanes_count; lane++)
+        {
+            if (!active[lane])
+                continue;
+            lane_read_block(hash, &lanes[lane], messages, block);
+            hash->load_block(ctx, lane, block);
+            any = 1;
+        }
+        if (!any)
+            break;
+
+        hash->compress(ctx);
+
+        for (size_t lane = 0; lane < hash->lanes_count; lane++)
+        {
+            if (!active[lane] || lanes[lane].block < lanes[lane].blocks)
+                continue;
+            hash->store_digest(ctx, lane, lanes[lane].index);
+            if (next < count)
+                lane_start(hash, ctx, &lanes[lane], lane, messages, next++);
+            else
+                active[lane] = 0;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef __MULTI_BUFFER_HASH_H__
+#define __MULTI_BUFFER_HASH_H__
+
+// Internal helpers shared by the multi buffer (several messages per SIMD vector) hash implementations
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MULTI_BUFFER_HASH_X86_64
+#endif
+
+#define MULTI_BUFFER_HASH_MAX_LANES 16
+#define MULTI_BUFFER_HASH_MAX_BLOCK_SIZE 200
+
+#define MULTI_BUFFER_HASH_CPU_AVX2 (1u << 0)
+#define MULTI_BUFFER_HASH_CPU_AVX512F (1u << 1)
+#define MULTI_BUFFER_HASH_CPU_SHA_NI (1u << 2)
+
+// Returns the MULTI_BUFFER_HASH_CPU_* features of this CPU, they are detected once and cached (0 on other architectures)
+unsigned int multi_buffer_hash_cpu_features(void);
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+} multi_buffer_hash_part_t;
+
+// Describes a Merkle-Damgard like hash (sha256 or a keccak sponge with a single squeezed block) to multi_buffer_hash_run.
+// All the callbacks get the ctx passed to multi_buffer_hash_run, which holds the lanes state
+typedef struct
+{
+    size_t lanes_count;         // at most MULTI_BUFFER_HASH_MAX_LANES
+    size_t block_size;          // at most MULTI_BUFFER_HASH_MAX_BLOCK_SIZE
+    uint8_t pad_byte;           // written right after the message
+    size_t min_padding;         // the number of bytes the padding needs in the last block (including pad_byte)
+
+    uint32_t (*parts_count)(const void *messages, size_t index);
+    multi_buffer_hash_part_t (*part)(const void *messages, size_t index, uint32_t part);
+
+    // completes the padding of the last block after pad_byte was written and the rest was zeroed
+    void (*finish_padding)(uint8_t *block, size_t block_size, uint64_t length);
+    // sets the lane to the initial state
+    void (*reset_lane)(void *ctx, size_t lane);
+    // sets the next block of the lane, the blocks of all the lanes are processed together by compress
+    void (*load_block)(void *ctx, size_t lane, const uint8_t *block);
+    void (*compress)(void *ctx);
+    // stores the lane state as the digest of message index
+    void (*store_digest)(void *ctx, size_t lane, size_t index);
+} multi_buffer_hash_t;
+
+// Hashes count messages, each lane runs until its message ends and then starts the next message, so messages of different lengths
+// don't leave lanes idle
+void multi_buffer_hash_run(const multi_buffer_hash_t *hash, void *ctx, const void *messages, size_t count);
+
+#endif // __MULTI_BUFFER_HASH_H__
@@ -2,6 +2,7 @@
 #include "crypto/elliptic_curve_algebra/elliptic_curve256_algebra.h"
 #include "crypto/keccak1600/keccak1600.h"
 #include "curve25519.c"
+#include "ed25519_scalar.h"
 
 #include "crypto/common/byteswap.h"
 
@@ -190,8 +191,9 @@ elliptic_curve_algebra_status ed25519_algebra_verify(const ed25519_algebra_ctx_t
 elliptic_curve_algebra_status ed25519_algebra_verify_linear_combination(const ed25519_algebra_ctx_t *ctx, const ed25519_point_t *sum_point, const ed25519_point_t *proof_points, const ed25519_scalar_t *coefficients,
     uint32_t points_count, uint8_t *result)
 {
-    ge_p3 sum;
+    ed25519_le_scalar_t *exps = NULL;
     ed25519_point_t ecpoint;
+    elliptic_curve_algebra_status ret;
 
     if (!ctx || !sum_point || !proof_points || !coefficients || !points_count || !result)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
@@ -200,56 +202,225 @@ elliptic_curve_algebra_status ed25519_algebra_verify_linear_combination(const ed
     if (!ed25519_is_valid_point(*sum_point))
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT;
 
+    exps = (ed25519_le_scalar_t*)malloc(points_count * sizeof(ed25519_le_scalar_t));
+    if (!exps)
+        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+
+    ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT;
     for (uint32_t i = 0; i < points_count; ++i)
     {
-        ed25519_scalar_t exp;
-        ed25519_point_t p;
         if (!ed25519_is_valid_point(proof_points[i]))
-            return ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT;
+            goto cleanup;
+    }
+    ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
+    for (uint32_t i = 0; i < points_count; ++i)
+    {
+        if (!ed25519_to_scalar(coefficients[i], exps[i]))
+            goto cleanup;
+    }
 
-        if (!ed25519_to_scalar(coefficients[i], exp))
-            return ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
+    // all the values are public, so the sum is computed with a single variable time multi scalar multiplication
+    ret = ed25519_algebra_multi_point_mul_vartime(ctx, &ecpoint, NULL, proof_points, (const ed25519_le_scalar_t*)exps, points_count);
+    if (ret == ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+        *result = CRYPTO_memcmp(ecpoint, *sum_point, sizeof(ed25519_point_t)) == 0 ? 1 : 0;
 
-        if (!ed25519_scalar_mult(p, exp, proof_points[i]))
-            return ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT;
+cleanup:
+    free(exps);
+    return ret;
+}
+
+elliptic_curve_algebra_status ed25519_algebra_generator_mul(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_scalar_t *exp)
+{
+    ed25519_le_scalar_t local_exp;
+
+    if (!ctx || !res || !exp)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    OPENSSL_cleanse(*res, sizeof(ed25519_point_t));
+
+    if (!ed25519_to_scalar(*exp, local_exp))
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
+    ed25519_algebra_generator_mul_internal(res, &local_exp);
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+}
+
+elliptic_curve_algebra_status ed25519_algebra_generator_mul_batch(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_scalar_t *exps, uint32_t count)
+{
+    ge_p3 *points = NULL;
+    fe *products = NULL;
+    fe inv;
+
+    if (!ctx || !res || !exps || !count)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    points = (ge_p3*)malloc(count * sizeof(ge_p3));
+    products = (fe*)malloc(count * sizeof(fe));
+    if (!points || !products)
+    {
+        free(points);
+        free(products);
+        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint8_t exp[64] = {0};
+        for (size_t j = 0; j < sizeof(ed25519_scalar_t); ++j)
+            exp[j] = exps[i][sizeof(ed25519_scalar_t) - 1 - j];
+        x25519_sc_reduce(exp);
+        ge_scalarmult_base(&points[i], exp);
+        OPENSSL_cleanse(exp, sizeof(exp));
 
         if (i == 0)
+            fe_copy(products[0], points[0].Z);
+        else
+            fe_mul(products[i], products[i - 1], points[i].Z);
+    }
+
+    // Z is never zero in extended coordinates, so all the Z's are inverted using a single inversion of their product
+    fe_invert(inv, products[count - 1]);
+    for (uint32_t i = count; i > 0; --i)
+    {
+        fe recip;
+        fe x;
+        fe y;
+        if (i > 1)
         {
-            if (ge_frombytes_vartime(&sum, p))
-                return ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+            fe_mul(recip, inv, products[i - 2]);
+            fe_mul(inv, inv, points[i - 1].Z);
         }
         else
+            fe_copy(recip, inv);
+        fe_mul(x, points[i - 1].X, recip);
+        fe_mul(y, points[i - 1].Y, recip);
+        fe_tobytes(res[i - 1], y);
+        res[i - 1][31] ^= fe_isnegative(x) << 7;
+    }
+
+    free(points);
+    free(products);
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+}
+
+// Straus (interleaved sliding windows) multi scalar multiplication, shares the doublings between all the points
+static void ge_multi_scalarmult_vartime(ge_p2 *r, const uint8_t *b, const ge_p3 *points, const ed25519_le_scalar_t *exps, uint32_t count, 
+    signed char (*slides)[256], ge_cached (*tables)[8])
+{
+    signed char bslide[256];
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 A2;
+    int i;
+
+    for (uint32_t j = 0; j < count; ++j)
+    {
+        slide(slides[j], exps[j]);
+        ge_p3_to_cached(&tables[j][0], &points[j]);
+        ge_p3_dbl(&t, &points[j]);
+        ge_p1p1_to_p3(&A2, &t);
+        for (i = 1; i < 8; ++i)
         {
-            ge_p3 P;
-            ge_p1p1 tmp;
-            ge_cached cache_p;
-            if (ge_frombytes_vartime(&P, p))
-                return ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-
-            ge_p3_to_cached(&cache_p, &P);
-            ge_add(&tmp, &sum, &cache_p);
-            ge_p1p1_to_p3(&sum, &tmp);
+            ge_add(&t, &A2, &tables[j][i - 1]);
+            ge_p1p1_to_p3(&u, &t);
+            ge_p3_to_cached(&tables[j][i], &u);
         }
     }
+    if (b)
+        slide(bslide, b);
+    else
+        memset(bslide, 0, sizeof(bslide));
 
-    ge_p3_tobytes(ecpoint, &sum);
-    *result = CRYPTO_memcmp(ecpoint, *sum_point, sizeof(ed25519_point_t)) == 0 ? 1 : 0;
-    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+    ge_p2_0(r);
+
+    for (i = 255; i >= 0; --i)
+    {
+        uint32_t j = 0;
+        if (bslide[i])
+            break;
+        while (j < count && !slides[j][i])
+            ++j;
+        if (j < count)
+            break;
+    }
+
+    for (; i >= 0; --i)
+    {
+        ge_p2_dbl(&t, r);
+
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            if (slides[j][i] > 0)
+            {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &tables[j][slides[j][i] / 2]);
+            }
+            else if (slides[j][i] < 0)
+            {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &tables[j][(-slides[j][i]) / 2]);
+            }
+        }
+
+        if (bslide[i] > 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &Bi[bslide[i] / 2]);
+        }
+        else if (bslide[i] < 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &Bi[(-bslide[i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(r, &t);
+    }
 }
 
-elliptic_curve_algebra_status ed25519_algebra_generator_mul(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_scalar_t *exp)
+elliptic_curve_algebra_status ed25519_algebra_multi_point_mul_vartime(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_le_scalar_t *generator_exp, 
+    const ed25519_point_t *points, const ed25519_le_scalar_t *exps, uint32_t count)
 {
-    ed25519_le_scalar_t local_exp;
+    ge_p3 *P = NULL;
+    signed char (*slides)[256] = NULL;
+    ge_cached (*tables)[8] = NULL;
+    ge_p2 r;
+    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
 
-    if (!ctx || !res || !exp)
+    if (!ctx || !res || (count && (!points || !exps)))
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    OPENSSL_cleanse(*res, sizeof(ed25519_point_t));
-
-    if (!ed25519_to_scalar(*exp, local_exp))
+    if (generator_exp && ((*generator_exp)[31] & 0x80))
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
-    ed25519_algebra_generator_mul_internal(res, &local_exp);
-    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (exps[i][31] & 0x80)
+            return ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
+    }
+
+    if (count)
+    {
+        P = (ge_p3*)malloc(count * sizeof(ge_p3));
+        slides = malloc(count * sizeof(*slides));
+        tables = malloc(count * sizeof(*tables));
+        if (!P || !slides || !tables)
+            goto cleanup;
+    }
+
+    ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (ge_frombytes_vartime(&P[i], points[i]))
+            goto cleanup;
+    }
+
+    ge_multi_scalarmult_vartime(&r, generator_exp ? *generator_exp : NULL, P, exps, count, slides, tables);
+    ge_tobytes(*res, &r);
+    ret = ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+
+cleanup:
+    free(P);
+    free(slides);
+    free(tables);
+    return ret;
 }
 
 elliptic_curve_algebra_status ed25519_algebra_add_points(const ed25519_algebra_ctx_t *ctx, ed25519_point_t *res, const ed25519_point_t *p1, const ed25519_point_t *p2)
@@ -294,215 +465,141 @@ elliptic_curve_algebra_status ed25519_algebra_point_mul(const ed25519_algebra_ct
 
 elliptic_curve_algebra_status ed25519_algebra_add_scalars(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len)
 {
-    BN_CTX *bn_ctx = NULL;
-    BIGNUM *bn_a = NULL;
-    BIGNUM *bn_b = NULL;
-    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    ed25519_sc_t sc_a;
+    ed25519_sc_t sc_b;
 
     if (!ctx || !res || !a || !a_len || !b || !b_len)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_ctx = BN_CTX_new();
-    if (!bn_ctx)
-        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
-
-    BN_CTX_start(bn_ctx);
-
-    bn_a = BN_CTX_get(bn_ctx);
-    if (!bn_a || !BN_bin2bn(a, a_len, bn_a))
-        goto cleanup;
-    bn_b = BN_CTX_get(bn_ctx);
-    if (!bn_b || !BN_bin2bn(b, b_len, bn_b))
-        goto cleanup;
-
-    BN_set_flags(bn_a, BN_FLG_CONSTTIME);
-    BN_set_flags(bn_b, BN_FLG_CONSTTIME);
-
-    if (BN_mod_add(bn_a, bn_a, bn_b, ctx->L, bn_ctx))
-    {
-        ret = BN_bn2binpad(bn_a, *res, sizeof(ed25519_scalar_t)) > 0 ? ELLIPTIC_CURVE_ALGEBRA_SUCCESS : ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-    }
-    else
-        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-
-cleanup:
-    if (bn_a)
-        BN_clear(bn_a);
-    if (bn_b)
-        BN_clear(bn_b);
-    BN_CTX_end(bn_ctx);
-    BN_CTX_free(bn_ctx);
-    return ret;
+    ed25519_sc_load_be(&sc_a, a, a_len);
+    ed25519_sc_load_be(&sc_b, b, b_len);
+    ed25519_sc_add(&sc_a, &sc_a, &sc_b);
+    ed25519_sc_store_be(*res, &sc_a);
+    OPENSSL_cleanse(&sc_a, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_b, sizeof(ed25519_sc_t));
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
 }
 
 elliptic_curve_algebra_status ed25519_algebra_sub_scalars(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len)
 {
-    BN_CTX *bn_ctx = NULL;
-    BIGNUM *bn_a = NULL;
-    BIGNUM *bn_b = NULL;
-    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    ed25519_sc_t sc_a;
+    ed25519_sc_t sc_b;
 
     if (!ctx || !res || !a || !a_len || !b || !b_len)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_ctx = BN_CTX_new();
-    if (!bn_ctx)
-        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
-
-    BN_CTX_start(bn_ctx);
-
-    bn_a = BN_CTX_get(bn_ctx);
-    if (!bn_a || !BN_bin2bn(a, a_len, bn_a))
-        goto cleanup;
-    bn_b = BN_CTX_get(bn_ctx);
-    if (!bn_b || !BN_bin2bn(b, b_len, bn_b))
-        goto cleanup;
-
-    BN_set_flags(bn_a, BN_FLG_CONSTTIME);
-    BN_set_flags(bn_b, BN_FLG_CONSTTIME);
-
-    if (BN_mod_sub(bn_a, bn_a, bn_b, ctx->L, bn_ctx))
-    {
-        ret = BN_bn2binpad(bn_a, *res, sizeof(ed25519_scalar_t)) > 0 ? ELLIPTIC_CURVE_ALGEBRA_SUCCESS : ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-    }
-    else
-        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-
-cleanup:
-    if (bn_a)
-        BN_clear(bn_a);
-    if (bn_b)
-        BN_clear(bn_b);
-    BN_CTX_end(bn_ctx);
-    BN_CTX_free(bn_ctx);
-    return ret;
+    ed25519_sc_load_be(&sc_a, a, a_len);
+    ed25519_sc_load_be(&sc_b, b, b_len);
+    ed25519_sc_sub(&sc_a, &sc_a, &sc_b);
+    ed25519_sc_store_be(*res, &sc_a);
+    OPENSSL_cleanse(&sc_a, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_b, sizeof(ed25519_sc_t));
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
 }
 
 elliptic_curve_algebra_status ed25519_algebra_mul_scalars(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const uint8_t *a, uint32_t a_len, const uint8_t *b, uint32_t b_len)
 {
-    BN_CTX *bn_ctx = NULL;
-    BIGNUM *bn_a = NULL;
-    BIGNUM *bn_b = NULL;
-    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    ed25519_sc_t sc_a;
+    ed25519_sc_t sc_b;
 
     if (!ctx || !res || !a || !a_len || !b || !b_len)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_ctx = BN_CTX_new();
-    if (!bn_ctx)
-        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
-
-    BN_CTX_start(bn_ctx);
-
-    bn_a = BN_CTX_get(bn_ctx);
-    if (!bn_a || !BN_bin2bn(a, a_len, bn_a))
-        goto cleanup;
-    bn_b = BN_CTX_get(bn_ctx);
-    if (!bn_b || !BN_bin2bn(b, b_len, bn_b))
-        goto cleanup;
-
-    BN_set_flags(bn_a, BN_FLG_CONSTTIME);
-    BN_set_flags(bn_b, BN_FLG_CONSTTIME);
-
-    if (BN_mod_mul(bn_a, bn_a, bn_b, ctx->L, bn_ctx))
-    {
-        ret = BN_bn2binpad(bn_a, *res, sizeof(ed25519_scalar_t)) > 0 ? ELLIPTIC_CURVE_ALGEBRA_SUCCESS : ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-    }
-    else
-        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-
-cleanup:
-    if (bn_a)
-        BN_clear(bn_a);
-    if (bn_b)
-        BN_clear(bn_b);
-    BN_CTX_end(bn_ctx);
-    BN_CTX_free(bn_ctx);
-    return ret;
+    ed25519_sc_load_be(&sc_a, a, a_len);
+    ed25519_sc_load_be(&sc_b, b, b_len);
+    ed25519_sc_mul(&sc_a, &sc_a, &sc_b);
+    ed25519_sc_store_be(*res, &sc_a);
+    OPENSSL_cleanse(&sc_a, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_b, sizeof(ed25519_sc_t));
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
 }
 
 elliptic_curve_algebra_status ed25519_algebra_add_le_scalars(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *res, const ed25519_le_scalar_t *a, const ed25519_le_scalar_t *b)
 {
-    BN_CTX *bn_ctx = NULL;
-    BIGNUM *bn_a = NULL;
-    BIGNUM *bn_b = NULL;
-    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    ed25519_sc_t sc_a;
+    ed25519_sc_t sc_b;
 
     if (!ctx || !res || !a || !b)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_ctx = BN_CTX_new();
-    if (!bn_ctx)
-        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
-
-    BN_CTX_start(bn_ctx);
+    if (!ed25519_sc_is_reduced_le(*a) || !ed25519_sc_is_reduced_le(*b))
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_a = BN_CTX_get(bn_ctx);
-    if (!bn_a || !BN_lebin2bn(*a, sizeof(ed25519_le_scalar_t), bn_a))
-        goto cleanup;
-    bn_b = BN_CTX_get(bn_ctx);
-    if (!bn_b || !BN_lebin2bn(*b, sizeof(ed25519_le_scalar_t), bn_b))
-        goto cleanup;
+    ed25519_sc_load_le(&sc_a, *a);
+    ed25519_sc_load_le(&sc_b, *b);
+    ed25519_sc_add(&sc_a, &sc_a, &sc_b);
+    ed25519_sc_store_le(*res, &sc_a);
+    OPENSSL_cleanse(&sc_a, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_b, sizeof(ed25519_sc_t));
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+}
 
-    if (BN_cmp(bn_a, ctx->L) >= 0 || BN_cmp(bn_b, ctx->L) >= 0)
-    {
-        ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
-        goto cleanup;
-    }
+elliptic_curve_algebra_status ed25519_algebra_inverse(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const ed25519_scalar_t *val)
+{
+    ed25519_sc_t sc_val;
 
-    BN_set_flags(bn_a, BN_FLG_CONSTTIME);
-    BN_set_flags(bn_b, BN_FLG_CONSTTIME);
+    if (!ctx || !res || !val)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    if (BN_mod_add_quick(bn_a, bn_a, bn_b, ctx->L))
-    {
-        ret = BN_bn2lebinpad(bn_a, *res, sizeof(ed25519_scalar_t)) > 0 ? ELLIPTIC_CURVE_ALGEBRA_SUCCESS : ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
-    }
-    else
-        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+    ed25519_sc_load_be(&sc_val, *val, sizeof(ed25519_scalar_t));
+    if (ed25519_sc_is_zero(&sc_val))
+        return ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR; // like BN_mod_inverse, 0 has no inverse
 
-cleanup:
-    if (bn_a)
-        BN_clear(bn_a);
-    if (bn_b)
-        BN_clear(bn_b);
-    BN_CTX_end(bn_ctx);
-    BN_CTX_free(bn_ctx);
-    return ret;
+    ed25519_sc_inverse(&sc_val, &sc_val);
+    ed25519_sc_store_be(*res, &sc_val);
+    OPENSSL_cleanse(&sc_val, sizeof(ed25519_sc_t));
+    return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
 }
 
-elliptic_curve_algebra_status ed25519_algebra_inverse(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const ed25519_scalar_t *val)
+// Montgomery's trick, all the values are inverted using a single modular inversion of their product and 3 * (count - 1) multiplications.
+// The ed25519_sc_* arithmetic is always constant time, so constant_time doesn't change anything
+elliptic_curve_algebra_status ed25519_algebra_batch_inverse(const ed25519_algebra_ctx_t *ctx, ed25519_scalar_t *res, const ed25519_scalar_t *vals, uint32_t count, uint8_t constant_time)
 {
-    BN_CTX *bn_ctx = NULL;
-    BIGNUM *bn_val = NULL;
-    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
-
-    if (!ctx || !res || !val)
+    ed25519_sc_t *prefix;
+    ed25519_sc_t inv;
+    ed25519_sc_t val;
+    ed25519_sc_t tmp;
+    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+
+    (void)constant_time;
+    if (!ctx || !res || !vals || !count)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    bn_ctx = BN_CTX_new();
-    if (!bn_ctx)
+    prefix = (ed25519_sc_t*)malloc(count * sizeof(ed25519_sc_t));
+    if (!prefix)
         return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
 
-    BN_CTX_start(bn_ctx);
+    // prefix[i] = vals[0] * ... * vals[i]
+    ed25519_sc_load_be(&prefix[0], vals[0], sizeof(ed25519_scalar_t));
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        ed25519_sc_load_be(&val, vals[i], sizeof(ed25519_scalar_t));
+        ed25519_sc_mul(&prefix[i], &prefix[i - 1], &val);
+    }
 
-    bn_val = BN_CTX_get(bn_ctx);
-    if (!bn_val || !BN_bin2bn(*val, sizeof(ed25519_scalar_t), bn_val))
+    if (ed25519_sc_is_zero(&prefix[count - 1]))
+    {
+        ret = ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR;
         goto cleanup;
+    }
+    ed25519_sc_inverse(&inv, &prefix[count - 1]);
 
-    BN_set_flags(bn_val, BN_FLG_CONSTTIME);
-
-    if (BN_mod_inverse(bn_val, bn_val, ctx->L, bn_ctx))
+    // inv = (vals[0] * ... * vals[i])^-1, so vals[i]^-1 = inv * prefix[i - 1], res may be the same buffer as vals
+    for (uint32_t i = count - 1; i > 0; --i)
     {
-        ret = BN_bn2binpad(bn_val, *res, sizeof(ed25519_scalar_t)) > 0 ? ELLIPTIC_CURVE_ALGEBRA_SUCCESS : ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+        ed25519_sc_load_be(&val, vals[i], sizeof(ed25519_scalar_t));
+        ed25519_sc_mul(&tmp, &inv, &prefix[i - 1]);
+        ed25519_sc_mul(&inv, &inv, &val);
+        ed25519_sc_store_be(res[i], &tmp);
     }
-    else
-        ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+    ed25519_sc_store_be(res[0], &inv);
 
 cleanup:
-    if (bn_val)
-        BN_clear(bn_val);
-    BN_CTX_end(bn_ctx);
-    BN_CTX_free(bn_ctx);
+    OPENSSL_cleanse(prefix, count * sizeof(ed25519_sc_t));
+    free(prefix);
+    OPENSSL_cleanse(&inv, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&val, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&tmp, sizeof(ed25519_sc_t));
     return ret;
 }
 
@@ -546,10 +643,25 @@ elliptic_curve_algebra_status ed25519_algebra_reduce(const ed25519_algebra_ctx_t
 
 elliptic_curve_algebra_status ed25519_algebra_mul_add(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *res, const ed25519_le_scalar_t *a, const ed25519_le_scalar_t *b, const ed25519_le_scalar_t *c)
 {
+    ed25519_sc_t sc_a;
+    ed25519_sc_t sc_b;
+    ed25519_sc_t sc_c;
+
     if (!ctx || !res || !a || !b || !c)
         return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
 
-    sc_muladd(*res, *a, *b, *c);
+    // the inputs may be unreduced (e.g. a clamped private key), a is reduced first so a * b < l * R
+    ed25519_sc_load_le(&sc_a, *a);
+    ed25519_sc_load_le(&sc_b, *b);
+    ed25519_sc_load_le(&sc_c, *c);
+    ed25519_sc_reduce(&sc_a, &sc_a);
+    ed25519_sc_reduce(&sc_c, &sc_c);
+    ed25519_sc_mul(&sc_a, &sc_a, &sc_b);
+    ed25519_sc_add(&sc_a, &sc_a, &sc_c);
+    ed25519_sc_store_le(*res, &sc_a);
+    OPENSSL_cleanse(&sc_a, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_b, sizeof(ed25519_sc_t));
+    OPENSSL_cleanse(&sc_c, sizeof(ed25519_sc_t));
     return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
 }
 
@@ -580,6 +692,69 @@ elliptic_curve_algebra_status ed25519_calc_hram(const ed25519_algebra_ctx_t *ctx
     return ed25519_algebra_reduce(ctx, hram, &hash);
 }
 
+elliptic_curve_algebra_status ed25519_calc_hram_batch(const ed25519_algebra_ctx_t *ctx, ed25519_le_scalar_t *hrams, const ed25519_point_t *Rs, const ed25519_point_t *public_keys, const uint8_t **messages, const uint32_t *message_sizes, uint32_t count, uint8_t use_keccak)
+{
+    elliptic_curve_algebra_status ret = ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+    keccak1600_batch_buffer_t *parts = NULL;
+    keccak1600_batch_message_t *batch = NULL;
+    ed25519_le_large_scalar_t *hashes = NULL;
+
+    if (!ctx || !hrams || !Rs || !public_keys || !messages || !message_sizes || !count)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!messages[i] || !message_sizes[i])
+            return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+    }
+
+    // SHA512 has no multi buffer implementation, openssl is already fast for a single message
+    if (!use_keccak)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ret = ed25519_calc_hram(ctx, &hrams[i], &Rs[i], &public_keys[i], messages[i], message_sizes[i], 0);
+            if (ret != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+                return ret;
+        }
+        return ELLIPTIC_CURVE_ALGEBRA_SUCCESS;
+    }
+
+    parts = (keccak1600_batch_buffer_t*)malloc(sizeof(keccak1600_batch_buffer_t) * 3 * count);
+    batch = (keccak1600_batch_message_t*)malloc(sizeof(keccak1600_batch_message_t) * count);
+    hashes = (ed25519_le_large_scalar_t*)malloc(sizeof(ed25519_le_large_scalar_t) * count);
+    if (!parts || !batch || !hashes)
+        goto cleanup;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        parts[3 * i].data = Rs[i];
+        parts[3 * i].len = sizeof(ed25519_point_t);
+        parts[3 * i + 1].data = public_keys[i];
+        parts[3 * i + 1].len = sizeof(ed25519_point_t);
+        parts[3 * i + 2].data = messages[i];
+        parts[3 * i + 2].len = message_sizes[i];
+        batch[i].parts = &parts[3 * i];
+        batch[i].parts_count = 3;
+    }
+
+    ret = ELLIPTIC_CURVE_ALGEBRA_UNKNOWN_ERROR;
+    if (!keccak1600_batch(512, KECCAK256_PAD, batch, count, (unsigned char*)hashes))
+        goto cleanup;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ret = ed25519_algebra_reduce(ctx, &hrams[i], &hashes[i]);
+        if (ret != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+            goto cleanup;
+    }
+
+cleanup:
+    free(parts);
+    free(batch);
+    free(hashes);
+    return ret;
+}
+
 // @audit-ok: Ed25519 signature generation follows RFC 8032
 // ↳ Deterministic nonce via SHA512(private_key || message) is standard
 // ↳ ed25519_algebra_reduce properly reduces hash to scalar field
@@ -791,6 +966,30 @@ static elliptic_curve_algebra_status generator_mul(const elliptic_curve256_algeb
     return ed25519_algebra_generator_mul_data(ctx->ctx, *exp, sizeof(elliptic_curve256_scalar_t), (ed25519_point_t*)res);
 }
 
+static elliptic_curve_algebra_status generator_mul_batch(const elliptic_curve256_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_scalar_t *exps, uint32_t count)
+{
+    ed25519_point_t *points;
+    elliptic_curve_algebra_status status;
+    if (!ctx || !res || !exps || !count || ctx->type != ELLIPTIC_CURVE_ED25519)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+
+    points = calloc(count, sizeof(ed25519_point_t));
+    if (!points)
+        return ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY;
+
+    status = ed25519_algebra_generator_mul_batch(ctx->ctx, points, (const ed25519_scalar_t*)exps, count);
+    if (status == ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            memcpy(res[i], points[i], sizeof(ed25519_point_t));
+            res[i][sizeof(ed25519_point_t)] = 0;
+        }
+    }
+    free(points);
+    return status;
+}
+
 static elliptic_curve_algebra_status add_points(const elliptic_curve256_algebra_ctx_t *ctx, elliptic_curve256_point_t *res, const elliptic_curve256_point_t *p1, const elliptic_curve256_point_t *p2)
 {
     if (!ctx || !res || ctx->type != ELLIPTIC_CURVE_ED25519)
@@ -850,6 +1049,13 @@ static elliptic_curve_algebra_status inverse(const struct elliptic_curve256_alge
     return ed25519_algebra_inverse(ctx->ctx, res, val);
 }
 
+static elliptic_curve_algebra_status batch_inverse(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res, const elliptic_curve256_scalar_t *vals, uint32_t count, uint8_t constant_time)
+{
+    if (!ctx || ctx->type != ELLIPTIC_CURVE_ED25519)
+        return ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER;
+    return ed25519_algebra_batch_inverse(ctx->ctx, res, vals, count, constant_time);
+}
+
 static elliptic_curve_algebra_status ec_rand(const struct elliptic_curve256_algebra_ctx *ctx, elliptic_curve256_scalar_t *res)
 {
     if (!ctx || ctx->type != ELLIPTIC_CURVE_ED25519)
@@ -933,5 +1139,7 @@ elliptic_curve256_algebra_ctx_t* elliptic_curve256_new_ed25519_algebra()
     ctx->rand = ec_rand;
     ctx->reduce = reduce;
     ctx->order_internal = order_internal;
+    ctx->generator_mul_batch = generator_mul_batch;
+    ctx->batch_inverse = batch_inverse;
     return ctx;
 }
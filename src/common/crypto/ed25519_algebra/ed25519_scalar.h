@@ -0,0 +1,228 @@
+#ifndef __ED25519_SCALAR_H__
+#define __ED25519_SCALAR_H__
+
+// Constant time arithmetic modulo the ed25519 group order l = 2^252 + 27742317777372353535851937790883648493 over 4 64bit limbs (little endian),
+// the values are always reduced (< l). Multiplications use montgomery reduction with R = 2^256, all the functions work on stack values only
+
+#include <stdint.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+
+typedef struct
+{
+    uint64_t v[4];
+} ed25519_sc_t;
+
+typedef unsigned __int128 ed25519_sc_uint128_t;
+
+static const ed25519_sc_t ED25519_SC_L = {{0x5812631a5cf5d3edULL, 0x14def9dea2f79cd6ULL, 0x0000000000000000ULL, 0x1000000000000000ULL}};
+// -l^-1 mod 2^64
+static const uint64_t ED25519_SC_N0 = 0xd2b51da312547e1bULL;
+// R mod l
+static const ed25519_sc_t ED25519_SC_R = {{0xd6ec31748d98951dULL, 0xc6ef5bf4737dcf70ULL, 0xfffffffffffffffeULL, 0x0fffffffffffffffULL}};
+// R^2 mod l
+static const ed25519_sc_t ED25519_SC_R2 = {{0xa40611e3449c0f01ULL, 0xd00e1ba768859347ULL, 0xceec73d217f5be65ULL, 0x0399411b7c309a3dULL}};
+// l - 2, the exponent for fermat's inversion
+static const ed25519_sc_t ED25519_SC_L_MINUS_2 = {{0x5812631a5cf5d3ebULL, 0x14def9dea2f79cd6ULL, 0x0000000000000000ULL, 0x1000000000000000ULL}};
+
+// res = t - l if t >= l else t, where t = (hi, t[0..3]) < 2l
+static inline void ed25519_sc_cond_sub_l(ed25519_sc_t *res, const uint64_t t[4], uint64_t hi)
+{
+    uint64_t d[4];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t diff = (ed25519_sc_uint128_t)t[i] - ED25519_SC_L.v[i] - borrow;
+        d[i] = (uint64_t)diff;
+        borrow = (uint64_t)(diff >> 64) & 1;
+    }
+    // keep t if t - l is negative
+    uint64_t mask = 0 - (uint64_t)(borrow > hi);
+    for (int i = 0; i < 4; ++i)
+        res->v[i] = (t[i] & mask) | (d[i] & ~mask);
+}
+
+// res = a * b * R^-1 mod l, requires a * b < l * R (e.g. a < R and b < l)
+static inline void ed25519_sc_montmul(ed25519_sc_t *res, const ed25519_sc_t *a, const ed25519_sc_t *b)
+{
+    uint64_t t[6] = {0};
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t c = 0;
+        for (int j = 0; j < 4; ++j)
+        {
+            c = (ed25519_sc_uint128_t)a->v[j] * b->v[i] + t[j] + (uint64_t)(c >> 64);
+            t[j] = (uint64_t)c;
+        }
+        c = (ed25519_sc_uint128_t)t[4] + (uint64_t)(c >> 64);
+        t[4] = (uint64_t)c;
+        t[5] = (uint64_t)(c >> 64);
+
+        uint64_t m = t[0] * ED25519_SC_N0;
+        c = (ed25519_sc_uint128_t)m * ED25519_SC_L.v[0] + t[0];
+        for (int j = 1; j < 4; ++j)
+        {
+            c = (ed25519_sc_uint128_t)m * ED25519_SC_L.v[j] + t[j] + (uint64_t)(c >> 64);
+            t[j - 1] = (uint64_t)c;
+        }
+        c = (ed25519_sc_uint128_t)t[4] + (uint64_t)(c >> 64);
+        t[3] = (uint64_t)c;
+        t[4] = t[5] + (uint64_t)(c >> 64);
+    }
+    ed25519_sc_cond_sub_l(res, t, t[4]);
+}
+
+static inline void ed25519_sc_add(ed25519_sc_t *res, const ed25519_sc_t *a, const ed25519_sc_t *b)
+{
+    uint64_t t[4];
+    uint64_t carry = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t sum = (ed25519_sc_uint128_t)a->v[i] + b->v[i] + carry;
+        t[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    ed25519_sc_cond_sub_l(res, t, carry);
+}
+
+static inline void ed25519_sc_sub(ed25519_sc_t *res, const ed25519_sc_t *a, const ed25519_sc_t *b)
+{
+    uint64_t t[4];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t diff = (ed25519_sc_uint128_t)a->v[i] - b->v[i] - borrow;
+        t[i] = (uint64_t)diff;
+        borrow = (uint64_t)(diff >> 64) & 1;
+    }
+    // add l back if a < b
+    uint64_t mask = 0 - borrow;
+    uint64_t carry = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t sum = (ed25519_sc_uint128_t)t[i] + (ED25519_SC_L.v[i] & mask) + carry;
+        res->v[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+}
+
+static inline void ed25519_sc_mul(ed25519_sc_t *res, const ed25519_sc_t *a, const ed25519_sc_t *b)
+{
+    ed25519_sc_t tmp;
+    ed25519_sc_montmul(&tmp, a, b);
+    ed25519_sc_montmul(res, &tmp, &ED25519_SC_R2);
+}
+
+// reduces any 256 bit value: x * (R mod l) * R^-1 = x mod l
+static inline void ed25519_sc_reduce(ed25519_sc_t *res, const ed25519_sc_t *x)
+{
+    ed25519_sc_montmul(res, x, &ED25519_SC_R);
+}
+
+// res = a^-1 mod l (0 for a = 0), the exponent is public so the operations sequence doesn't depend on a
+static inline void ed25519_sc_inverse(ed25519_sc_t *res, const ed25519_sc_t *a)
+{
+    ed25519_sc_t table[16];
+    ed25519_sc_t acc;
+
+    // montgomery form, table[i] = a^i * R
+    ed25519_sc_montmul(&table[1], a, &ED25519_SC_R2);
+    table[0] = ED25519_SC_R;
+    for (int i = 2; i < 16; ++i)
+        ed25519_sc_montmul(&table[i], &table[i - 1], &table[1]);
+
+    acc = ED25519_SC_R;
+    for (int i = 63; i >= 0; --i)
+    {
+        uint8_t window = (ED25519_SC_L_MINUS_2.v[i / 16] >> (4 * (i % 16))) & 0xf;
+        for (int j = 0; j < 4; ++j)
+            ed25519_sc_montmul(&acc, &acc, &acc);
+        if (window)
+            ed25519_sc_montmul(&acc, &acc, &table[window]);
+    }
+
+    // back from montgomery form
+    static const ed25519_sc_t ONE = {{1, 0, 0, 0}};
+    ed25519_sc_montmul(res, &acc, &ONE);
+    OPENSSL_cleanse(table, sizeof(table));
+    OPENSSL_cleanse(&acc, sizeof(acc));
+}
+
+static inline int ed25519_sc_is_zero(const ed25519_sc_t *a)
+{
+    return (a->v[0] | a->v[1] | a->v[2] | a->v[3]) == 0;
+}
+
+// loads 32 little endian bytes without reducing them
+static inline void ed25519_sc_load_le(ed25519_sc_t *res, const uint8_t *data)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        res->v[i] = 0;
+        for (int j = 7; j >= 0; --j)
+            res->v[i] = (res->v[i] << 8) | data[8 * i + j];
+    }
+}
+
+static inline void ed25519_sc_store_le(uint8_t *res, const ed25519_sc_t *a)
+{
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            res[8 * i + j] = (uint8_t)(a->v[i] >> (8 * j));
+}
+
+static inline void ed25519_sc_store_be(uint8_t *res, const ed25519_sc_t *a)
+{
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            res[31 - 8 * i - j] = (uint8_t)(a->v[i] >> (8 * j));
+}
+
+// loads a big endian number of any size and reduces it modulo l
+static inline void ed25519_sc_load_be(ed25519_sc_t *res, const uint8_t *data, uint32_t data_len)
+{
+    ed25519_sc_t acc = {{0}};
+    ed25519_sc_t chunk;
+    int first = 1;
+
+    // acc = acc * 2^256 + chunk, starting from the most significant (possibly partial) chunk
+    while (data_len)
+    {
+        uint32_t chunk_len = data_len % 32 ? data_len % 32 : 32;
+        memset(&chunk, 0, sizeof(chunk));
+        for (uint32_t i = 0; i < chunk_len; ++i)
+            chunk.v[i / 8] |= (uint64_t)data[chunk_len - 1 - i] << (8 * (i % 8));
+        ed25519_sc_reduce(&chunk, &chunk);
+        if (first)
+            acc = chunk;
+        else
+        {
+            // acc * R^2 * R^-1 = acc * 2^256
+            ed25519_sc_montmul(&acc, &acc, &ED25519_SC_R2);
+            ed25519_sc_add(&acc, &acc, &chunk);
+        }
+        first = 0;
+        data += chunk_len;
+        data_len -= chunk_len;
+    }
+    *res = acc;
+    OPENSSL_cleanse(&acc, sizeof(acc));
+    OPENSSL_cleanse(&chunk, sizeof(chunk));
+}
+
+// returns 1 if the 32 little endian bytes are smaller than l, in constant time
+static inline int ed25519_sc_is_reduced_le(const uint8_t *data)
+{
+    ed25519_sc_t a;
+    uint64_t borrow = 0;
+    ed25519_sc_load_le(&a, data);
+    for (int i = 0; i < 4; ++i)
+    {
+        ed25519_sc_uint128_t diff = (ed25519_sc_uint128_t)a.v[i] - ED25519_SC_L.v[i] - borrow;
+        borrow = (uint64_t)(diff >> 64) & 1;
+    }
+    return (int)borrow;
+}
+
+#endif // __ED25519_SCALAR_H__
@@ -0,0 +1,295 @@
+#include "crypto/keccak1600/keccak1600.h"
+
+#include "../common/multi_buffer_hash.h"
+
+#include <string.h>
+
+#ifdef MULTI_BUFFER_HASH_X86_64
+#define KECCAK1600_BATCH_HAS_MULTI_BUFFER
+#endif
+
+// below this number of messages most of the lanes are idle and the multi buffer implementations aren't worth it
+#define KECCAK1600_BATCH_MIN_MULTI_BUFFER_COUNT 2
+
+static int keccak1600_batch_scalar(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds)
+{
+    const size_t md_size = md_size_in_bits / 8;
+    for (size_t i = 0; i < count; i++)
+    {
+        KECCAK1600_CTX ctx;
+        if (!keccak1600_init(&ctx, md_size_in_bits, pad))
+            return 0;
+        for (uint32_t j = 0; j < messages[i].parts_count; j++)
+            keccak1600_update(&ctx, messages[i].parts[j].data, messages[i].parts[j].len);
+        keccak1600_final(&ctx, mds + i * md_size);
+    }
+    return 1;
+}
+
+#ifdef KECCAK1600_BATCH_HAS_MULTI_BUFFER
+
+#define KECCAK1600_MAX_LANES 8
+#define KECCAK1600_ROUNDS 24
+
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+typedef uint64_t v8u64 __attribute__((vector_size(64)));
+
+// lane i of state[j] is word j (x + 5 * y) of message i
+typedef uint64_t keccak1600_lanes_state_t[25][KECCAK1600_MAX_LANES];
+typedef void (*keccak1600_permutation_t)(keccak1600_lanes_state_t state);
+
+static const uint64_t KECCAK1600_RC[KECCAK1600_ROUNDS] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+#define ROL64(x, n) ((n) ? (((x) << (n)) | ((x) >> (64 - (n)))) : (x))
+
+// theta, rho, pi, chi and iota on a vector of independent states from A to E, fully unrolled so the rotations are constant
+#define KECCAK1600_ROUND(A, E, TYPE, rc) \
+    do { \
+        TYPE C0 = A[0] ^ A[5] ^ A[10] ^ A[15] ^ A[20], C1 = A[1] ^ A[6] ^ A[11] ^ A[16] ^ A[21], C2 = A[2] ^ A[7] ^ A[12] ^ A[17] ^ A[22]; \
+        TYPE C3 = A[3] ^ A[8] ^ A[13] ^ A[18] ^ A[23], C4 = A[4] ^ A[9] ^ A[14] ^ A[19] ^ A[24]; \
+        TYPE D0 = C4 ^ ROL64(C1, 1), D1 = C0 ^ ROL64(C2, 1), D2 = C1 ^ ROL64(C3, 1), D3 = C2 ^ ROL64(C4, 1), D4 = C3 ^ ROL64(C0, 1); \
+        { \
+            TYPE B0 = ROL64(A[0] ^ D0, 0), B1 = ROL64(A[6] ^ D1, 44), B2 = ROL64(A[12] ^ D2, 43), B3 = ROL64(A[18] ^ D3, 21), B4 = ROL64(A[24] ^ D4, 14); \
+            E[0] = B0 ^ (~B1 & B2); \
+            E[1] = B1 ^ (~B2 & B3); \
+            E[2] = B2 ^ (~B3 & B4); \
+            E[3] = B3 ^ (~B4 & B0); \
+            E[4] = B4 ^ (~B0 & B1); \
+        } \
+        { \
+            TYPE B0 = ROL64(A[3] ^ D3, 28), B1 = ROL64(A[9] ^ D4, 20), B2 = ROL64(A[10] ^ D0, 3), B3 = ROL64(A[16] ^ D1, 45), B4 = ROL64(A[22] ^ D2, 61); \
+            E[5] = B0 ^ (~B1 & B2); \
+            E[6] = B1 ^ (~B2 & B3); \
+            E[7] = B2 ^ (~B3 & B4); \
+            E[8] = B3 ^ (~B4 & B0); \
+            E[9] = B4 ^ (~B0 & B1); \
+        } \
+        { \
+            TYPE B0 = ROL64(A[1] ^ D1, 1), B1 = ROL64(A[7] ^ D2, 6), B2 = ROL64(A[13] ^ D3, 25), B3 = ROL64(A[19] ^ D4, 8), B4 = ROL64(A[20] ^ D0, 18); \
+            E[10] = B0 ^ (~B1 & B2); \
+            E[11] = B1 ^ (~B2 & B3); \
+            E[12] = B2 ^ (~B3 & B4); \
+            E[13] = B3 ^ (~B4 & B0); \
+            E[14] = B4 ^ (~B0 & B1); \
+        } \
+        { \
+            TYPE B0 = ROL64(A[4] ^ D4, 27), B1 = ROL64(A[5] ^ D0, 36), B2 = ROL64(A[11] ^ D1, 10), B3 = ROL64(A[17] ^ D2, 15), B4 = ROL64(A[23] ^ D3, 56); \
+            E[15] = B0 ^ (~B1 & B2); \
+            E[16] = B1 ^ (~B2 & B3); \
+            E[17] = B2 ^ (~B3 & B4); \
+            E[18] = B3 ^ (~B4 & B0); \
+            E[19] = B4 ^ (~B0 & B1); \
+        } \
+        { \
+            TYPE B0 = ROL64(A[2] ^ D2, 62), B1 = ROL64(A[8] ^ D3, 55), B2 = ROL64(A[14] ^ D4, 39), B3 = ROL64(A[15] ^ D0, 41), B4 = ROL64(A[21] ^ D1, 2); \
+            E[20] = B0 ^ (~B1 & B2); \
+            E[21] = B1 ^ (~B2 & B3); \
+            E[22] = B2 ^ (~B3 & B4); \
+            E[23] = B3 ^ (~B4 & B0); \
+            E[24] = B4 ^ (~B0 & B1); \
+        } \
+        E[0] ^= (rc); \
+    } while (0)
+
+#define KECCAK1600_PERMUTE(A, TYPE) \
+    do { \
+        TYPE E[25]; \
+        for (size_t round = 0; round < KECCAK1600_ROUNDS; round += 2) \
+        { \
+            KECCAK1600_ROUND(A, E, TYPE, KECCAK1600_RC[round]); \
+            KECCAK1600_ROUND(E, A, TYPE, KECCAK1600_RC[round + 1]); \
+        } \
+    } while (0)
+
+__attribute__((target("avx2")))
+static void keccak1600_permute_x4(keccak1600_lanes_state_t state)
+{
+    v4u64 A[25];
+    for (size_t i = 0; i < 25; i++)
+        memcpy(&A[i], state[i], sizeof(v4u64));
+    KECCAK1600_PERMUTE(A, v4u64);
+    for (size_t i = 0; i < 25; i++)
+        memcpy(state[i], &A[i], sizeof(v4u64));
+}
+
+__attribute__((target("avx512f")))
+static void keccak1600_permute_x8(keccak1600_lanes_state_t state)
+{
+    v8u64 A[25];
+    for (size_t i = 0; i < 25; i++)
+        memcpy(&A[i], state[i], sizeof(v8u64));
+    KECCAK1600_PERMUTE(A, v8u64);
+    for (size_t i = 0; i < 25; i++)
+        memcpy(state[i], &A[i], sizeof(v8u64));
+}
+
+typedef struct
+{
+    keccak1600_lanes_state_t state;
+    keccak1600_permutation_t permute;
+    size_t block_size;
+    size_t md_size;
+    unsigned char *mds;
+} keccak1600_multi_buffer_ctx_t;
+
+static uint32_t keccak1600_parts_count(const void *messages, size_t index)
+{
+    return ((const keccak1600_batch_message_t*)messages)[index].parts_count;
+}
+
+static multi_buffer_hash_part_t keccak1600_part(const void *messages, size_t index, uint32_t part)
+{
+    const keccak1600_batch_buffer_t *buffer = &((const keccak1600_batch_message_t*)messages)[index].parts[part];
+    multi_buffer_hash_part_t ret = {buffer->data, buffer->len};
+    return ret;
+}
+
+// the final bit of the 10*1 padding, it may be in the same byte as the pad byte
+static void keccak1600_finish_padding(uint8_t *block, size_t block_size, uint64_t length)
+{
+    (void)length;
+    block[block_size - 1] |= 0x80;
+}
+
+static void keccak1600_reset_lane(void *ctx, size_t lane)
+{
+    keccak1600_multi_buffer_ctx_t *keccak_ctx = (keccak1600_multi_buffer_ctx_t*)ctx;
+    for (size_t i = 0; i < 25; i++)
+        keccak_ctx->state[i][lane] = 0;
+}
+
+// the block size is the rate, which is whole words
+static void keccak1600_load_block(void *ctx, size_t lane, const uint8_t *block)
+{
+    keccak1600_multi_buffer_ctx_t *keccak_ctx = (keccak1600_multi_buffer_ctx_t*)ctx;
+    for (size_t i = 0; i < keccak_ctx->block_size / 8; i++)
+    {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 8; j++)
+            word |= (uint64_t)block[8 * i + j] << (8 * j);
+        keccak_ctx->state[i][lane] ^= word;
+    }
+}
+
+static void keccak1600_permute(void *ctx)
+{
+    keccak1600_multi_buffer_ctx_t *keccak_ctx = (keccak1600_multi_buffer_ctx_t*)ctx;
+    keccak_ctx->permute(keccak_ctx->state);
+}
+
+static void keccak1600_store_digest(void *ctx, size_t lane, size_t index)
+{
+    keccak1600_multi_buffer_ctx_t *keccak_ctx = (keccak1600_multi_buffer_ctx_t*)ctx;
+    unsigned char *md = keccak_ctx->mds + index * keccak_ctx->md_size;
+    for (size_t i = 0; i < keccak_ctx->md_size; i++)
+        md[i] = (unsigned char)(keccak_ctx->state[i / 8][lane] >> (8 * (i % 8)));
+}
+
+static int keccak1600_batch_multi_buffer(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds,
+    size_t lanes_count, keccak1600_permutation_t permute)
+{
+    const size_t block_size = (KECCAK1600_WIDTH - md_size_in_bits * 2) / 8;
+    const multi_buffer_hash_t hash = {
+        lanes_count,
+        block_size,
+        pad,
+        1, // there is always room for the padding in the last block
+        keccak1600_parts_count,
+        keccak1600_part,
+        keccak1600_finish_padding,
+        keccak1600_reset_lane,
+        keccak1600_load_block,
+        keccak1600_permute,
+        keccak1600_store_digest
+    };
+    keccak1600_multi_buffer_ctx_t ctx;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.permute = permute;
+    ctx.block_size = block_size;
+    ctx.md_size = md_size_in_bits / 8;
+    ctx.mds = mds;
+    multi_buffer_hash_run(&hash, &ctx, messages, count);
+    return 1;
+}
+
+static int cpu_supports_avx2(void)
+{
+    return (multi_buffer_hash_cpu_features() & MULTI_BUFFER_HASH_CPU_AVX2) != 0;
+}
+
+static int cpu_supports_avx512(void)
+{
+    return (multi_buffer_hash_cpu_features() & MULTI_BUFFER_HASH_CPU_AVX512F) != 0;
+}
+
+#endif // KECCAK1600_BATCH_HAS_MULTI_BUFFER
+
+keccak1600_batch_impl keccak1600_batch_default_impl(void)
+{
+#ifdef KECCAK1600_BATCH_HAS_MULTI_BUFFER
+    return cpu_supports_avx512() ? KECCAK1600_BATCH_IMPL_AVX512 : cpu_supports_avx2() ? KECCAK1600_BATCH_IMPL_AVX2 : KECCAK1600_BATCH_IMPL_SCALAR;
+#else
+    return KECCAK1600_BATCH_IMPL_SCALAR;
+#endif
+}
+
+int keccak1600_batch_with_impl(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds, keccak1600_batch_impl impl)
+{
+    if (!count)
+        return 1;
+    if (!messages || !mds)
+        return 0;
+    // the block must fit KECCAK1600_CTX buffer and be whole words, and the multi buffer implementations squeeze a single block
+    if (md_size_in_bits % 32 || md_size_in_bits * 2 >= KECCAK1600_WIDTH)
+        return 0;
+    const size_t block_size = (KECCAK1600_WIDTH - md_size_in_bits * 2) / 8;
+    if (block_size > sizeof(((KECCAK1600_CTX*)NULL)->buf) || block_size < md_size_in_bits / 8)
+        return 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (messages[i].parts_count && !messages[i].parts)
+            return 0;
+        for (uint32_t j = 0; j < messages[i].parts_count; j++)
+        {
+            if (messages[i].parts[j].len && !messages[i].parts[j].data)
+                return 0;
+        }
+    }
+
+    if (impl == KECCAK1600_BATCH_IMPL_AUTO)
+        impl = count < KECCAK1600_BATCH_MIN_MULTI_BUFFER_COUNT ? KECCAK1600_BATCH_IMPL_SCALAR : keccak1600_batch_default_impl();
+
+    switch (impl)
+    {
+    case KECCAK1600_BATCH_IMPL_SCALAR:
+        return keccak1600_batch_scalar(md_size_in_bits, pad, messages, count, mds);
+    case KECCAK1600_BATCH_IMPL_AVX2:
+#ifdef KECCAK1600_BATCH_HAS_MULTI_BUFFER
+        if (cpu_supports_avx2())
+            return keccak1600_batch_multi_buffer(md_size_in_bits, pad, messages, count, mds, 4, keccak1600_permute_x4);
+#endif
+        return 0;
+    case KECCAK1600_BATCH_IMPL_AVX512:
+#ifdef KECCAK1600_BATCH_HAS_MULTI_BUFFER
+        if (cpu_supports_avx512())
+            return keccak1600_batch_multi_buffer(md_size_in_bits, pad, messages, count, mds, 8, keccak1600_permute_x8);
+#endif
+        return 0;
+    case KECCAK1600_BATCH_IMPL_AUTO:
+    default:
+        return 0;
+    }
+}
+
+int keccak1600_batch(size_t md_size_in_bits, unsigned char pad, const keccak1600_batch_message_t *messages, size_t count, unsigned char *mds)
+{
+    return keccak1600_batch_with_impl(md_size_in_bits, pad, messages, count, mds, KECCAK1600_BATCH_IMPL_AUTO);
+}
@@ -81,6 +81,141 @@ cleanup:
     return ret;
 }
 
+long paillier_private_key_init_crt(paillier_private_key_t *priv, BN_CTX *ctx)
+{
+    priv->p_inv_mod_q = BN_new();
+    priv->mont_p = BN_MONT_CTX_new();
+    priv->mont_q = BN_MONT_CTX_new();
+
+    if (!priv->p_inv_mod_q || !priv->mont_p || !priv->mont_q)
+    {
+        return PAILLIER_ERROR_OUT_OF_MEMORY;
+    }
+
+    BN_set_flags(priv->p_inv_mod_q, BN_FLG_CONSTTIME);
+
+    if (!BN_mod_inverse(priv->p_inv_mod_q, priv->p, priv->q, ctx))
+    {
+        return ERR_get_error() * -1;
+    }
+
+    if (!BN_MONT_CTX_set(priv->mont_p, priv->p, ctx) || !BN_MONT_CTX_set(priv->mont_q, priv->q, ctx))
+    {
+        return ERR_get_error() * -1;
+    }
+    return PAILLIER_SUCCESS;
+}
+
+long paillier_public_key_init_montgomery(paillier_public_key_t *pub, BN_CTX *ctx)
+{
+    pub->mont_n2 = BN_MONT_CTX_new();
+
+    if (!pub->mont_n2)
+    {
+        return PAILLIER_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (!BN_MONT_CTX_set(pub->mont_n2, pub->n2, ctx))
+    {
+        return ERR_get_error() * -1;
+    }
+    return PAILLIER_SUCCESS;
+}
+
+long paillier_mul_internal(const paillier_public_key_t *key, BIGNUM *res, const BIGNUM *ciphertext, const BIGNUM *plaintext, BN_CTX *ctx)
+{
+    if (BN_cmp(ciphertext, key->n2) >= 0 || is_coprime_fast(ciphertext, key->n, ctx) != 1)
+    {
+        return PAILLIER_ERROR_INVALID_CIPHER_TEXT;
+    }
+
+    // BN_mod_exp_mont switches to the constant time implementation when the plaintext has BN_FLG_CONSTTIME set
+    if (!BN_mod_exp_mont(res, ciphertext, plaintext, key->n2, ctx, key->mont_n2))
+    {
+        return ERR_get_error() * -1;
+    }
+    return PAILLIER_SUCCESS;
+}
+
+long paillier_add_internal(const paillier_public_key_t *key, BIGNUM *res, const BIGNUM *a, const BIGNUM *b, BN_CTX *ctx)
+{
+    if (is_coprime_fast(a, key->n, ctx) != 1 || is_coprime_fast(b, key->n, ctx) != 1)
+    {
+        return PAILLIER_ERROR_INVALID_CIPHER_TEXT;
+    }
+
+    if (!BN_mod_mul(res, a, b, key->n2, ctx))
+    {
+        return ERR_get_error() * -1;
+    }
+    return PAILLIER_SUCCESS;
+}
+
+long paillier_crt_mod_exp_internal(const paillier_private_key_t *priv, BIGNUM *res, const BIGNUM *base, const BIGNUM *exp_p, const BIGNUM *exp_q, BN_CTX *ctx)
+{
+    long ret = -1;
+    BIGNUM *res_p = NULL, *res_q = NULL;
+
+    BN_CTX_start(ctx);
+
+    res_p = BN_CTX_get(ctx);
+    res_q = BN_CTX_get(ctx);
+
+    if (!res_p || !res_q)
+    {
+        ret = PAILLIER_ERROR_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+
+    BN_set_flags(res_p, BN_FLG_CONSTTIME);
+    BN_set_flags(res_q, BN_FLG_CONSTTIME);
+
+    if (!BN_nnmod(res_p, base, priv->p, ctx) || !BN_mod_exp_mont_consttime(res_p, res_p, exp_p, priv->p, ctx, priv->mont_p))
+    {
+        goto cleanup;
+    }
+
+    if (!BN_nnmod(res_q, base, priv->q, ctx) || !BN_mod_exp_mont_consttime(res_q, res_q, exp_q, priv->q, ctx, priv->mont_q))
+    {
+        goto cleanup;
+    }
+
+    // Garner's formula res = res_p + p * ((res_q - res_p) * p^(-1) mod q)
+    if (!BN_mod_sub(res_q, res_q, res_p, priv->q, ctx) || !BN_mod_mul(res_q, res_q, priv->p_inv_mod_q, priv->q, ctx))
+    {
+        goto cleanup;
+    }
+
+    if (!BN_mul(res, res_q, priv->p, ctx) || !BN_add(res, res, res_p))
+    {
+        goto cleanup;
+    }
+
+    ret = PAILLIER_SUCCESS;
+
+cleanup:
+    if (ret == -1)
+    {
+        ret = ERR_get_error() * -1;
+        if (!ret)
+        {
+            ret = PAILLIER_ERROR_UNKNOWN;
+        }
+    }
+
+    if (res_p)
+    {
+        BN_clear(res_p);
+    }
+    if (res_q)
+    {
+        BN_clear(res_q);
+    }
+
+    BN_CTX_end(ctx);
+    return ret;
+}
+
 // @audit CRITICAL: Key generation function - most sensitive operation in Paillier cryptosystem
 // @audit-issue: MIN_KEY_LEN_IN_BITS = 256 is too small for production (should be >= 2048)
 // ↳ BN_generate_prime_ex quality depends on OpenSSL RNG - ensure RAND_status() == 1
@@ -226,7 +361,7 @@ long paillier_generate_key_pair(uint32_t key_len, paillier_public_key_t **pub, p
         goto cleanup;
     }
 
-    local_priv = (paillier_private_key_t*)malloc(sizeof(paillier_private_key_t));
+    local_priv = (paillier_private_key_t*)calloc(1, sizeof(paillier_private_key_t));
     if (!local_priv)
     {
         ret = PAILLIER_ERROR_OUT_OF_MEMORY;
@@ -238,8 +373,20 @@ long paillier_generate_key_pair(uint32_t key_len, paillier_public_key_t **pub, p
     local_priv->q = q;
     local_priv->lamda = lamda;
     local_priv->mu = mu;
+
+    ret = paillier_private_key_init_crt(local_priv, ctx);
+    if (ret != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+    ret = paillier_public_key_init_montgomery(&local_priv->pub, ctx);
+    if (ret != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+    ret = -1;
     
-    local_pub = (paillier_public_key_t*)malloc(sizeof(paillier_public_key_t));
+    local_pub = (paillier_public_key_t*)calloc(1, sizeof(paillier_public_key_t));
     if (!local_pub)
     {
         ret = PAILLIER_ERROR_OUT_OF_MEMORY;
@@ -255,6 +402,12 @@ long paillier_generate_key_pair(uint32_t key_len, paillier_public_key_t **pub, p
         goto cleanup;
     }
 
+    ret = paillier_public_key_init_montgomery(local_pub, ctx);
+    if (ret != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+
     *priv = local_priv;
     *pub = local_pub;
 
@@ -276,6 +429,10 @@ cleanup:
         // handle errors
         if (local_priv)
         {
+            BN_clear_free(local_priv->p_inv_mod_q);
+            BN_MONT_CTX_free(local_priv->mont_p);
+            BN_MONT_CTX_free(local_priv->mont_q);
+            BN_MONT_CTX_free(local_priv->pub.mont_n2);
             free(local_priv);
         }
         paillier_free_public_key(local_pub); // as the public key uses duplication of n and n2 it's not sefficent just to free it
@@ -408,6 +565,11 @@ paillier_public_key_t *paillier_public_key_deserialize(const uint8_t *buffer, ui
         goto cleanup;
     }
 
+    if (paillier_public_key_init_montgomery(pub, ctx) != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+
     BN_CTX_free(ctx);
     return pub;
 
@@ -423,6 +585,7 @@ void paillier_free_public_key(paillier_public_key_t *pub)
     {
         BN_free(pub->n);
         BN_free(pub->n2);
+        BN_MONT_CTX_free(pub->mont_n2);
         free(pub);
     }
 }
@@ -588,6 +751,16 @@ paillier_private_key_t *paillier_private_key_deserialize(const uint8_t *buffer,
         goto cleanup;
     }
 
+    if (paillier_private_key_init_crt(priv, ctx) != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+
+    if (paillier_public_key_init_montgomery(&priv->pub, ctx) != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
 
@@ -611,10 +784,14 @@ void paillier_free_private_key(paillier_private_key_t *priv)
     {
         BN_free(priv->pub.n);
         BN_free(priv->pub.n2);
+        BN_MONT_CTX_free(priv->pub.mont_n2);
         BN_clear_free(priv->p);
         BN_clear_free(priv->q);
         BN_clear_free(priv->lamda);
         BN_clear_free(priv->mu);
+        BN_clear_free(priv->p_inv_mod_q);
+        BN_MONT_CTX_free(priv->mont_p);
+        BN_MONT_CTX_free(priv->mont_q);
         free(priv);
     }
 }
@@ -657,7 +834,7 @@ long paillier_encrypt_openssl_internal(const paillier_public_key_t *key, BIGNUM
     {
         goto cleanup;
     }
-    if (!BN_mod_exp(tmp2, r, key->n, key->n2, ctx))
+    if (!BN_mod_exp_mont(tmp2, r, key->n, key->n2, ctx, key->mont_n2))
     {
         goto cleanup;
     }
@@ -1667,7 +1844,7 @@ long paillier_mul(const paillier_public_key_t *key, const uint8_t *a_ciphertext,
         goto cleanup;
     }
     
-    if (!BN_mod_exp(res, bn_a, bn_b, key->n2, ctx))
+    if (!BN_mod_exp_mont(res, bn_a, bn_b, key->n2, ctx, key->mont_n2))
     {
         goto cleanup;
     }
@@ -1761,7 +1938,7 @@ long paillier_mul_integer(const paillier_public_key_t *key, const uint8_t *a_cip
         goto cleanup;
     }
     
-    if (!BN_mod_exp(res, bn_a, bn_b, key->n2, ctx))
+    if (!BN_mod_exp_mont(res, bn_a, bn_b, key->n2, ctx, key->mont_n2))
     {
         goto cleanup;
     }
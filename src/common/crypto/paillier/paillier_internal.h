@@ -19,6 +19,8 @@ struct paillier_public_key
 {
     BIGNUM *n;
     BIGNUM *n2;
+    // montgomery context of n2, set by paillier_public_key_init_montgomery when the key is created
+    BN_MONT_CTX *mont_n2;
 };
 
 struct paillier_private_key 
@@ -28,6 +30,11 @@ struct paillier_private_key
     BIGNUM *q;
     BIGNUM *lamda;
     BIGNUM *mu;
+
+    // CRT precomputation, set by paillier_private_key_init_crt when the key is created
+    BIGNUM *p_inv_mod_q;
+    BN_MONT_CTX *mont_p;
+    BN_MONT_CTX *mont_q;
 };
 
 struct paillier_ciphertext
@@ -39,6 +46,15 @@ struct paillier_ciphertext
 int is_coprime_fast(const BIGNUM *in_a, const BIGNUM *in_b, BN_CTX *ctx);
 long paillier_encrypt_openssl_internal(const paillier_public_key_t *key, BIGNUM *ciphertext, const BIGNUM *r, const BIGNUM *plaintext, BN_CTX *ctx);
 long paillier_decrypt_openssl_internal(const paillier_private_key_t *key, const BIGNUM *ciphertext, BIGNUM *plaintext, BN_CTX *ctx);
+long paillier_private_key_init_crt(paillier_private_key_t *priv, BN_CTX *ctx);
+long paillier_public_key_init_montgomery(paillier_public_key_t *pub, BN_CTX *ctx);
+// homomorphic operations on parsed ciphertexts, res may alias the inputs
+// res = ciphertext^plaintext mod n2, the ciphertext must be smaller then n2 and coprime to n
+long paillier_mul_internal(const paillier_public_key_t *key, BIGNUM *res, const BIGNUM *ciphertext, const BIGNUM *plaintext, BN_CTX *ctx);
+// res = a * b mod n2, the ciphertexts must be coprime to n
+long paillier_add_internal(const paillier_public_key_t *key, BIGNUM *res, const BIGNUM *a, const BIGNUM *b, BN_CTX *ctx);
+// res = base^exp mod n computed mod p and mod q, exp_p and exp_q are exp reduced mod p - 1 and mod q - 1, base must be smaller then n
+long paillier_crt_mod_exp_internal(const paillier_private_key_t *priv, BIGNUM *res, const BIGNUM *base, const BIGNUM *exp_p, const BIGNUM *exp_q, BN_CTX *ctx);
 
 // ring pedersen internal structs
 struct ring_pedersen_public 
@@ -46,6 +62,7 @@ struct ring_pedersen_public
     BIGNUM *n;
     BIGNUM *s;
     BIGNUM *t;
+    // montgomery context of n, set by ring_pedersen_init_montgomery when the key is created
     BN_MONT_CTX *mont;
 };
 
@@ -55,7 +72,7 @@ struct ring_pedersen_private
     BIGNUM *lamda;
     BIGNUM *phi_n;
 };
-ring_pedersen_status ring_pedersen_init_montgomery(const ring_pedersen_public_t *pub, BN_CTX *ctx);
+ring_pedersen_status ring_pedersen_init_montgomery(ring_pedersen_public_t *pub, BN_CTX *ctx);
 ring_pedersen_status ring_pedersen_create_commitment_internal(const ring_pedersen_public_t *pub, const BIGNUM *x, const BIGNUM *r, BIGNUM *commitment, BN_CTX *ctx);
 ring_pedersen_status ring_pedersen_verify_batch_commitments_internal(const ring_pedersen_private_t *priv, uint32_t batch_size, const BIGNUM **x, const BIGNUM **r, const BIGNUM **commitments, BN_CTX *ctx);
 
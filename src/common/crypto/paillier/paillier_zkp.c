@@ -95,8 +95,8 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
                                            uint32_t *y_real_len)
 {
     BN_CTX *ctx = NULL;
-    BN_MONT_CTX *mont = NULL;
     BIGNUM *A = NULL, *r = NULL, *e = NULL, *bn_y = NULL, *z = NULL;
+    BIGNUM *r_mod_p_minus_1 = NULL, *r_mod_q_minus_1 = NULL;
     uint8_t *n = NULL;
     uint8_t *tmp = NULL;
     SHA256_CTX sha256_ctx;
@@ -144,14 +144,10 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
     e = BN_CTX_get(ctx);
     bn_y = BN_CTX_get(ctx);
     z = BN_CTX_get(ctx);
+    r_mod_p_minus_1 = BN_CTX_get(ctx);
+    r_mod_q_minus_1 = BN_CTX_get(ctx);
 
-    if (!A || !r || !e || !bn_y || !z)
-    {
-        goto cleanup;
-    }
-
-    mont = BN_MONT_CTX_new();
-    if (!mont)
+    if (!A || !r || !e || !bn_y || !z || !r_mod_p_minus_1 || !r_mod_q_minus_1)
     {
         goto cleanup;
     }
@@ -177,6 +173,19 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
         goto cleanup;
     }
 
+    // z^r mod n is computed using CRT, so r is reduced mod p - 1 and mod q - 1
+    BN_set_flags(r, BN_FLG_CONSTTIME);
+    BN_set_flags(r_mod_p_minus_1, BN_FLG_CONSTTIME);
+    BN_set_flags(r_mod_q_minus_1, BN_FLG_CONSTTIME);
+    if (!BN_sub(r_mod_p_minus_1, priv->p, BN_value_one()) || !BN_mod(r_mod_p_minus_1, r, r_mod_p_minus_1, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_sub(r_mod_q_minus_1, priv->q, BN_value_one()) || !BN_mod(r_mod_q_minus_1, r, r_mod_q_minus_1, ctx))
+    {
+        goto cleanup;
+    }
+
     n = (uint8_t*)malloc(n_len);
     if (!n)
     {
@@ -210,12 +219,6 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
 
     SHA512_Update(&sha512_ctx, n, n_len);
 
-
-    if (!BN_MONT_CTX_set(mont, priv->pub.n, ctx))
-    {
-        goto cleanup;
-    }
-
     for (size_t i = 0; i < FACTORIZANTION_ZKP_K; ++i)
     {
         do
@@ -228,10 +231,12 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
             goto cleanup;
         }
         SHA512_Update(&sha512_ctx, tmp, BN_num_bytes(z));
-        if (!BN_mod_exp_mont(z, z, r, priv->pub.n, ctx, mont))
+        ret = paillier_crt_mod_exp_internal(priv, z, z, r_mod_p_minus_1, r_mod_q_minus_1, ctx);
+        if (ret != PAILLIER_SUCCESS)
         {
             goto cleanup;
         }
+        ret = -1;
         if (!BN_bn2bin(z, tmp))
         {
             goto cleanup;
@@ -268,13 +273,24 @@ long paillier_generate_factorization_zkpok(const paillier_private_key_t *priv,
     ret = PAILLIER_SUCCESS;
     
 cleanup:
-    if (ret < 0)
+    if (ret == -1)
     {
         ret = ERR_get_error() * -1;
     }
     free(n);
     free(tmp);
-    BN_MONT_CTX_free(mont); //it is OK to call it on NULL
+    if (r)
+    {
+        BN_clear(r); //will be freed with context
+    }
+    if (r_mod_p_minus_1)
+    {
+        BN_clear(r_mod_p_minus_1); //will be freed with context
+    }
+    if (r_mod_q_minus_1)
+    {
+        BN_clear(r_mod_q_minus_1); //will be freed with context
+    }
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
     return ret;
@@ -484,8 +500,7 @@ cleanup:
 long paillier_generate_coprime_zkp(const paillier_private_key_t *priv, const uint8_t *aad, uint32_t aad_len, uint8_t *y, uint32_t y_len, uint32_t *y_real_len)
 {
     BN_CTX *ctx = NULL;
-    BN_MONT_CTX *mont = NULL;
-    BIGNUM *x = NULL, *M = NULL, *tmp = NULL;
+    BIGNUM *x = NULL, *M_p = NULL, *M_q = NULL, *tmp = NULL;
     uint8_t *n = NULL;
     uint8_t *y_ptr = y;
     SHA256_CTX sha256_ctx;
@@ -537,22 +552,23 @@ long paillier_generate_coprime_zkp(const paillier_private_key_t *priv, const uin
     BN_CTX_start(ctx);
     
     x = BN_CTX_get(ctx);
-    M = BN_CTX_get(ctx);
+    M_p = BN_CTX_get(ctx);
+    M_q = BN_CTX_get(ctx);
     tmp = BN_CTX_get(ctx);
 
-    if (!x || !M || !tmp)
+    if (!x || !M_p || !M_q || !tmp)
     {
         goto cleanup;
     }
 
-    mont = BN_MONT_CTX_new();
-    if (!mont)
+    // y = x^(n^(-1) mod phi(n)) mod n is computed using CRT, so the exponent is n^(-1) mod p - 1 and n^(-1) mod q - 1
+    BN_set_flags(M_p, BN_FLG_CONSTTIME);
+    BN_set_flags(M_q, BN_FLG_CONSTTIME);
+    if (!BN_sub(tmp, priv->p, BN_value_one()) || !BN_mod_inverse(M_p, priv->pub.n, tmp, ctx))
     {
         goto cleanup;
     }
-    
-    BN_set_flags(M, BN_FLG_CONSTTIME);
-    if (!BN_mod_inverse(M, priv->pub.n, priv->lamda, ctx))
+    if (!BN_sub(tmp, priv->q, BN_value_one()) || !BN_mod_inverse(M_q, priv->pub.n, tmp, ctx))
     {
         goto cleanup;
     }
@@ -580,12 +596,6 @@ long paillier_generate_coprime_zkp(const paillier_private_key_t *priv, const uin
     free(n);
     n = NULL;
 
-
-    if (!BN_MONT_CTX_set(mont, priv->pub.n, ctx))
-    {
-        goto cleanup;
-    }
-
     for (size_t i = 0; i < COPRIME_ZKP_K; ++i)
     {
         int is_coprime_res;
@@ -600,10 +610,12 @@ long paillier_generate_coprime_zkp(const paillier_private_key_t *priv, const uin
             goto cleanup;
         }
         
-        if (!BN_mod_exp_mont(tmp, x, M, priv->pub.n, ctx, mont))
+        ret = paillier_crt_mod_exp_internal(priv, tmp, x, M_p, M_q, ctx);
+        if (ret != PAILLIER_SUCCESS)
         {
             goto cleanup;
         }
+        ret = -1;
             
         if (BN_bn2binpad(tmp, y_ptr, n_len) < 0)
         {
@@ -616,13 +628,20 @@ long paillier_generate_coprime_zkp(const paillier_private_key_t *priv, const uin
     ret = PAILLIER_SUCCESS;
 
 cleanup:
-    if (ret < 0)
+    if (ret == -1)
     {
         ret = ERR_get_error() * -1;
     }
         
     free(n);
-    BN_MONT_CTX_free(mont);
+    if (M_p)
+    {
+        BN_clear(M_p); //will be freed with context
+    }
+    if (M_q)
+    {
+        BN_clear(M_q); //will be freed with context
+    }
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
     return ret;
@@ -895,22 +914,256 @@ static inline uint8_t get_2bit_number(const uint8_t* array, const uint32_t i)
 
 
 
+typedef struct
+{
+    const paillier_private_key_t *priv;
+    const BIGNUM *p_exp_4th;
+    const BIGNUM *q_exp_4th;
+    const BIGNUM *n_inverse_mod_p_minus_1;
+    const BIGNUM *n_inverse_mod_q_minus_1;
+    const BIGNUM *p_remainder;
+    const BIGNUM *q_remainder;
+    const BIGNUM *correction;
+    const BIGNUM *y[PAILLIER_BLUM_STATISTICAL_SECURITY];
+    const uint8_t *random_bytes;
+    zkp_paillier_blum_modulus_proof_t *proof;
+} paillier_blum_zkp_prover_t;
+
+typedef struct
+{
+    const paillier_blum_zkp_prover_t *prover;
+    long status[PAILLIER_BLUM_STATISTICAL_SECURITY];
+} paillier_blum_zkp_rounds_t;
+
+// computes z[i], x[i], a[i] and b[i], the rounds are independent so they can be computed concurrently
+static long paillier_blum_zkp_prove_round(const paillier_blum_zkp_prover_t *prover, uint32_t i, BN_CTX *ctx)
+{
+    const paillier_private_key_t *priv = prover->priv;
+    zkp_paillier_blum_modulus_proof_t *proof = prover->proof;
+    const BIGNUM *y = prover->y[i];
+    BIGNUM *tmp = NULL, *y_mod_pq = NULL;
+    BIGNUM *p_4th_root = NULL, *q_4th_root = NULL;
+    uint8_t legendre_p;   // 0 is QR, 1 if QNR
+    uint8_t legendre_q;
+    long ret = -1;
+
+    BN_CTX_start(ctx);
+
+    tmp = BN_CTX_get(ctx);
+    y_mod_pq = BN_CTX_get(ctx);
+    p_4th_root = BN_CTX_get(ctx);
+    q_4th_root = BN_CTX_get(ctx);
+
+    if (!tmp || !y_mod_pq || !p_4th_root || !q_4th_root)
+    {
+        ret = PAILLIER_ERROR_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+
+    BN_set_flags(tmp, BN_FLG_CONSTTIME);
+    BN_set_flags(y_mod_pq, BN_FLG_CONSTTIME);
+    BN_set_flags(p_4th_root, BN_FLG_CONSTTIME);
+    BN_set_flags(q_4th_root, BN_FLG_CONSTTIME);
+
+    //while we could do it only once, we still fill all z values for the backward compatibility
+    ret = paillier_crt_mod_exp_internal(priv, proof->z[i], y, prover->n_inverse_mod_p_minus_1, prover->n_inverse_mod_q_minus_1, ctx);
+    if (ret != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
+    }
+    ret = -1;
+
+    // Compute potential 4th root modulo prime, and get legendre symbol 0/1 using 4th power
+    // This gives the 4th root of QR-corrected y (namely 8th root of y^2)
+    if (!BN_mod(y_mod_pq, y, priv->p, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_exp_mont_consttime(p_4th_root, y_mod_pq, prover->p_exp_4th, priv->p, ctx, priv->mont_p))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_sqr(tmp, p_4th_root, priv->p, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_sqr(tmp, tmp, priv->p, ctx))
+    {
+        goto cleanup;
+    }
+    legendre_p = BN_cmp(tmp, y_mod_pq) != 0;
+
+    if (!BN_mod(y_mod_pq, y, priv->q, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_exp_mont_consttime(q_4th_root, y_mod_pq, prover->q_exp_4th, priv->q, ctx, priv->mont_q))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_sqr(tmp, q_4th_root, priv->q, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_sqr(tmp, tmp, priv->q, ctx))
+    {
+        goto cleanup;
+    }
+    legendre_q = BN_cmp(tmp, y_mod_pq) != 0;
+
+    // CRT compute x as 4th root of "QR-corrected" y (include w later)
+    if (!BN_mod_mul(p_4th_root, p_4th_root, prover->q_remainder, priv->pub.n, ctx))
+    {
+        goto cleanup;
+    }
+    if (!BN_mod_mul(q_4th_root, q_4th_root, prover->p_remainder, priv->pub.n, ctx))
+    {
+        goto cleanup;
+    }
+
+    // We'll chose proof.x[i] randomly as  +/- p_4th_root +/-q_4th_root
+    switch (get_2bit_number(prover->random_bytes, i)) 
+    {
+    case 0:
+        // p_4th_root + q_4th_root
+        if (!BN_mod_add_quick(proof->x[i], p_4th_root, q_4th_root, priv->pub.n))
+        {
+            goto cleanup;
+        }
+        break;
+    case 1:
+        // p_4th_root - q_4th_root
+        if (!BN_mod_sub_quick(proof->x[i], p_4th_root, q_4th_root, priv->pub.n))
+        {
+            goto cleanup;
+        }
+        break;
+    case 2:
+        // - p_4th_root + q_4th_root
+        if (!BN_mod_sub_quick(proof->x[i], q_4th_root, p_4th_root, priv->pub.n))
+        {
+            goto cleanup;
+        }
+        break;
+    case 3:
+        // - p_4th_root - q_4th_root
+        if (!BN_mod_add_quick(proof->x[i], p_4th_root, q_4th_root, priv->pub.n) ||
+            !BN_sub(proof->x[i], priv->pub.n, proof->x[i])) //negate x in mod n
+        {
+            goto cleanup;
+        }
+        break;
+    }
+
+    // According to choice of w above with Jacobi symbol of (-1,1) 
+    proof->a[i] = legendre_q;
+    proof->b[i] = legendre_q != legendre_p;
+
+    // Include w in QR-corrected y, namely x^4 = (-1)^a*w^b*y
+    if (proof->b[i])
+    {
+        if (!BN_mod_mul(proof->x[i], proof->x[i], prover->correction, priv->pub.n, ctx))
+        {
+            goto cleanup;
+        }
+    }
+
+    ret = PAILLIER_SUCCESS;
+
+cleanup:
+    // the openssl error queue is per thread so the error must be fetched here
+    if (ret == -1)
+    {
+        ret = ERR_get_error() * -1;
+        if (!ret)
+        {
+            ret = PAILLIER_ERROR_UNKNOWN;
+        }
+    }
+
+    if (tmp)
+    {
+        BN_clear(tmp); //will be freed with context
+    }
+    if (y_mod_pq)
+    {
+        BN_clear(y_mod_pq); //will be freed with context
+    }
+    if (p_4th_root)
+    {
+        BN_clear(p_4th_root); //will be freed with context
+    }
+    if (q_4th_root)
+    {
+        BN_clear(q_4th_root); //will be freed with context
+    }
+
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+static void paillier_blum_zkp_round_task(void *arg, uint32_t i)
+{
+    paillier_blum_zkp_rounds_t *rounds = (paillier_blum_zkp_rounds_t*)arg;
+    BN_CTX *ctx = BN_CTX_new();
+
+    rounds->status[i] = ctx ? paillier_blum_zkp_prove_round(rounds->prover, i, ctx) : PAILLIER_ERROR_OUT_OF_MEMORY;
+    BN_CTX_free(ctx);
+}
+
+// runs the rounds using parallel_for if set, otherwise serially on the calling thread
+static long paillier_blum_zkp_prove_rounds(const paillier_blum_zkp_prover_t *prover, paillier_parallel_for_t parallel_for, void *executor)
+{
+    paillier_blum_zkp_rounds_t rounds;
+
+    rounds.prover = prover;
+    for (uint32_t i = 0; i < PAILLIER_BLUM_STATISTICAL_SECURITY; ++i)
+    {
+        rounds.status[i] = PAILLIER_ERROR_UNKNOWN;
+    }
+
+    if (parallel_for)
+    {
+        parallel_for(executor, PAILLIER_BLUM_STATISTICAL_SECURITY, paillier_blum_zkp_round_task, &rounds);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < PAILLIER_BLUM_STATISTICAL_SECURITY; ++i)
+        {
+            paillier_blum_zkp_round_task(&rounds, i);
+        }
+    }
+
+    for (uint32_t i = 0; i < PAILLIER_BLUM_STATISTICAL_SECURITY; ++i)
+    {
+        if (rounds.status[i] != PAILLIER_SUCCESS)
+        {
+            return rounds.status[i];
+        }
+    }
+    return PAILLIER_SUCCESS;
+}
+
 // @audit-ok: Paillier-Blum ZKP correctly proves n is a Blum integer
 // ↳ Security parameter PAILLIER_BLUM_STATISTICAL_SECURITY = 80 provides 2^-80 soundness
 // ↳ p ≡ 3 mod 8 and q ≡ 7 mod 8 enforced by key generation for efficient 4th roots
 long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, const uint8_t *aad, uint32_t aad_len, uint8_t *serialized_proof, uint32_t proof_len, uint32_t *proof_real_len)
+{
+    return paillier_generate_paillier_blum_zkp_parallel(priv, aad, aad_len, serialized_proof, proof_len, proof_real_len, NULL, NULL);
+}
+
+long paillier_generate_paillier_blum_zkp_parallel(const paillier_private_key_t *priv, const uint8_t *aad, uint32_t aad_len, uint8_t *serialized_proof, uint32_t proof_len, uint32_t *proof_real_len,
+    paillier_parallel_for_t parallel_for, void *executor)
 {
     BN_CTX *ctx = NULL;
     BIGNUM *p_remainder = NULL, *q_remainder = NULL;
-    BIGNUM *n_inverse_mod_phi_n = NULL;
+    BIGNUM *n_inverse_mod_p_minus_1 = NULL, *n_inverse_mod_q_minus_1 = NULL;
     BIGNUM *p_minus_1 = NULL, *q_minus_1 = NULL;
     BIGNUM *p_exp_4th = NULL, *q_exp_4th = NULL;
-    BIGNUM *tmp = NULL, *y_mod_pq = NULL;
     BIGNUM *correction = NULL;
-    BIGNUM *p_4th_root = NULL, *q_4th_root = NULL;
-    BIGNUM *y = NULL;
     BIGNUM *a = NULL, *b = NULL;
     zkp_paillier_blum_modulus_proof_t proof;
+    paillier_blum_zkp_prover_t prover;
     SHA256_CTX sha256_ctx;
     sha256_md_t seed;
     uint32_t n_len;
@@ -973,38 +1226,32 @@ long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, con
     
     p_remainder = BN_CTX_get(ctx);
     q_remainder = BN_CTX_get(ctx);
-    tmp = BN_CTX_get(ctx);
     a = BN_CTX_get(ctx);
     b = BN_CTX_get(ctx);
     correction = BN_CTX_get(ctx);
-    if (!q_remainder || !p_remainder || !tmp || !a || !b || !correction)
+    if (!q_remainder || !p_remainder || !a || !b || !correction)
     {
         ret = PAILLIER_ERROR_OUT_OF_MEMORY;
         goto cleanup;
     }
     
-    n_inverse_mod_phi_n = BN_CTX_get(ctx);
-    if (!n_inverse_mod_phi_n)
-    {
-        ret = PAILLIER_ERROR_OUT_OF_MEMORY;
-        goto cleanup;
-    }
-
-    y_mod_pq = BN_CTX_get(ctx);
-    p_4th_root = BN_CTX_get(ctx);
-    q_4th_root = BN_CTX_get(ctx);
-
-    if (!y_mod_pq || !p_4th_root || !q_4th_root)
+    n_inverse_mod_p_minus_1 = BN_CTX_get(ctx);
+    n_inverse_mod_q_minus_1 = BN_CTX_get(ctx);
+    if (!n_inverse_mod_p_minus_1 || !n_inverse_mod_q_minus_1)
     {
         ret = PAILLIER_ERROR_OUT_OF_MEMORY;
         goto cleanup;
     }
 
-    y = BN_CTX_get(ctx);
-    if (!y)
+    for (uint32_t i = 0; i < PAILLIER_BLUM_STATISTICAL_SECURITY; ++i)
     {
-        ret = PAILLIER_ERROR_OUT_OF_MEMORY;
-        goto cleanup;
+        BIGNUM *y = BN_CTX_get(ctx);
+        if (!y)
+        {
+            ret = PAILLIER_ERROR_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        prover.y[i] = y;
     }
 
     // Generate w with (-1, 1) Jacobi signs wrt (p,q) by Chinese remainder theorem
@@ -1013,7 +1260,7 @@ long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, con
 
     // calculate p_remainder and  q_remainder wich will be used to quickly find value in mod n if we know
     // the value in mod p and mod q using Chinese remainder theorem
-    if (!BN_mod_inverse(p_remainder, priv->p, priv->q, ctx)) // p_remainder = p^(-1) mod q
+    if (!BN_copy(p_remainder, priv->p_inv_mod_q)) // p_remainder = p^(-1) mod q
     {
         goto cleanup;
     }
@@ -1035,15 +1282,6 @@ long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, con
         goto cleanup;
     }
 
-
-    if (!BN_mod_inverse(n_inverse_mod_phi_n, priv->pub.n, priv->lamda, ctx))    // To compute z[i]
-    {
-        goto cleanup;
-    }
-
-    //since n_inverse_mod_phi_n is secret, it requires const time calculations
-    BN_set_flags(n_inverse_mod_phi_n, BN_FLG_CONSTTIME);
-
     // Taking each y[i] 4th root (by exponentation with p_exp_4th = ((p-1)/2)^2 mod (p -1) - double sqrt
     // Checking result^4 = y[i] or -y[i], which defines the legendre symbol
     p_minus_1 = BN_dup(priv->p);
@@ -1065,6 +1303,15 @@ long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, con
     BN_set_flags(p_minus_1, BN_FLG_CONSTTIME);
     BN_set_flags(q_minus_1, BN_FLG_CONSTTIME);
 
+    // z[i] = y[i]^(n^(-1) mod phi(n)) mod n is computed using CRT, so the exponent is reduced mod p - 1 and mod q - 1
+    BN_set_flags(n_inverse_mod_p_minus_1, BN_FLG_CONSTTIME);
+    BN_set_flags(n_inverse_mod_q_minus_1, BN_FLG_CONSTTIME);
+    if (!BN_mod_inverse(n_inverse_mod_p_minus_1, priv->pub.n, p_minus_1, ctx) ||
+        !BN_mod_inverse(n_inverse_mod_q_minus_1, priv->pub.n, q_minus_1, ctx))
+    {
+        goto cleanup;
+    }
+
     p_exp_4th = BN_dup(priv->p);
     q_exp_4th = BN_dup(priv->q);
     if (!p_exp_4th || !q_exp_4th)
@@ -1186,124 +1433,37 @@ long paillier_generate_paillier_blum_zkp(const paillier_private_key_t *priv, con
         goto cleanup;
     }    
     
+    // the y values are a hash chain, so they are generated first and the rounds are computed afterwards
     for (uint32_t i = 0; i < PAILLIER_BLUM_STATISTICAL_SECURITY; ++i)
     {
-
-        uint8_t legendre_p;   // 0 is QR, 1 if QNR
-        uint8_t legendre_q;
-
         do
         {
-            deterministic_rand(seed, n_len, y, &seed);
-        } while (BN_cmp(y, priv->pub.n) >= 0);
-
-        //while we could do it only once, we still fill all z values for the backward compatibility
-        if (!BN_mod_exp(proof.z[i], y, n_inverse_mod_phi_n, priv->pub.n, ctx))
-        {
-            goto cleanup;
-        }
-        
-        // Compute potential 4th root modulo prime, and get legendre symbol 0/1 using 4th power
-        // This gives the 4th root of QR-corrected y (namely 8th root of y^2)
-        if (!BN_mod(y_mod_pq, y, priv->p, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_exp(p_4th_root, y_mod_pq, p_exp_4th, priv->p, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_sqr(tmp, p_4th_root, priv->p, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_sqr(tmp, tmp, priv->p, ctx))
-        {
-            goto cleanup;
-        }
-        legendre_p = BN_cmp(tmp, y_mod_pq) != 0;
-
-        if (!BN_mod(y_mod_pq, y, priv->q, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_exp(q_4th_root, y_mod_pq, q_exp_4th, priv->q, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_sqr(tmp, q_4th_root, priv->q, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_sqr(tmp, tmp, priv->q, ctx))
-        {
-            goto cleanup;
-        }
-        legendre_q = BN_cmp(tmp, y_mod_pq) != 0;
-
-        // CRT compute x as 4th root of "QR-corrected" y (include w later)
-        if (!BN_mod_mul(p_4th_root, p_4th_root, q_remainder, priv->pub.n, ctx))
-        {
-            goto cleanup;
-        }
-        if (!BN_mod_mul(q_4th_root, q_4th_root, p_remainder, priv->pub.n, ctx))
-        {
-            goto cleanup;
-        }
-        
-        // We'll chose proof.x[i] randomly as  +/- p_4th_root +/-q_4th_root
-        switch (get_2bit_number(random_bytes, i)) 
-        {
-        case 0:
-            // p_4th_root + q_4th_root
-        if (!BN_mod_add_quick(proof.x[i], p_4th_root, q_4th_root, priv->pub.n))
-            {
-                goto cleanup;
-            }
-            break;
-        case 1:
-            // p_4th_root - q_4th_root
-            if (!BN_mod_sub_quick(proof.x[i], p_4th_root, q_4th_root, priv->pub.n))
-            {
-            goto cleanup;
-            }
-            break;
-        case 2:
-            // - p_4th_root + q_4th_root
-            if (!BN_mod_sub_quick(proof.x[i], q_4th_root, p_4th_root, priv->pub.n))
-            {
-                goto cleanup;
-            }
-            break;
-        case 3:
-            // - p_4th_root - q_4th_root
-            if (!BN_mod_add_quick(proof.x[i], p_4th_root, q_4th_root, priv->pub.n) ||
-                !BN_sub(proof.x[i], priv->pub.n, proof.x[i])) //negate x in mod n
-            {
-                goto cleanup;
-            }
-            break;
-        }
-
-        // According to choice of w above with Jacobi symbol of (-1,1) 
-        proof.a[i] = legendre_q;                   
-        proof.b[i] = legendre_q != legendre_p;
-
-        // Include w in QR-corrected y, namely x^4 = (-1)^a*w^b*y
-        if (proof.b[i])
-        {
-            if (!BN_mod_mul(proof.x[i], proof.x[i], correction, priv->pub.n, ctx))
-            {
-                goto cleanup;
-        }
-    }
+            deterministic_rand(seed, n_len, (BIGNUM*)prover.y[i], &seed);
+        } while (BN_cmp(prover.y[i], priv->pub.n) >= 0);
+    }
+
+    prover.priv = priv;
+    prover.p_exp_4th = p_exp_4th;
+    prover.q_exp_4th = q_exp_4th;
+    prover.n_inverse_mod_p_minus_1 = n_inverse_mod_p_minus_1;
+    prover.n_inverse_mod_q_minus_1 = n_inverse_mod_q_minus_1;
+    prover.p_remainder = p_remainder;
+    prover.q_remainder = q_remainder;
+    prover.correction = correction;
+    prover.random_bytes = random_bytes;
+    prover.proof = &proof;
+
+    ret = paillier_blum_zkp_prove_rounds(&prover, parallel_for, executor);
+    if (ret != PAILLIER_SUCCESS)
+    {
+        goto cleanup;
     }
 
     serialize_paillier_blum_zkp(&proof, n_len, serialized_proof);
 
     ret = PAILLIER_SUCCESS;
 cleanup:
-    if (ret < 0)
+    if (ret == -1)
     {
         ret = ERR_get_error() * -1;
     }
@@ -1322,9 +1482,13 @@ cleanup:
     {
         BN_clear(q_remainder); //will be freed with context
     }
-    if (n_inverse_mod_phi_n)
+    if (n_inverse_mod_p_minus_1)
     {
-        BN_clear(n_inverse_mod_phi_n); //will be freed with context
+        BN_clear(n_inverse_mod_p_minus_1); //will be freed with context
+    }
+    if (n_inverse_mod_q_minus_1)
+    {
+        BN_clear(n_inverse_mod_q_minus_1); //will be freed with context
     }
     if (a)
     {
@@ -1338,26 +1502,7 @@ cleanup:
     {
         BN_clear(correction); //will be freed with context
     }
-    if (tmp)
-    {
-        BN_clear(tmp); //will be freed with context
-    }
-    if (y_mod_pq)
-    {
-        BN_clear(y_mod_pq); //will be freed with context
-    }
-    if (p_4th_root)
-    {
-        BN_clear(p_4th_root); //will be freed with context
-    }
-    if (q_4th_root)
-    {
-        BN_clear(q_4th_root); //will be freed with context
-    }
-    if (y)
-    {
-        BN_clear(y); //will be freed with context
-    }
+    OPENSSL_cleanse(random_bytes, sizeof(random_bytes));
 
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
@@ -1371,12 +1516,14 @@ cleanup:
 long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const uint8_t *aad, uint32_t aad_len, const uint8_t *serialized_proof, uint32_t proof_len)
 {
     BN_CTX *ctx = NULL;
+    BN_MONT_CTX *mont = NULL;
     zkp_paillier_blum_modulus_proof_t proof;
     SHA256_CTX sha256_ctx;
     sha256_md_t seed;
     uint32_t n_len;
     BIGNUM *y = NULL;
     BIGNUM *tmp = NULL;
+    BIGNUM *product = NULL;
 
     long ret = -1;
 
@@ -1417,12 +1564,25 @@ long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const u
     
     y = BN_CTX_get(ctx);
     tmp = BN_CTX_get(ctx);
-    if (!y || !tmp)
+    product = BN_CTX_get(ctx);
+    if (!y || !tmp || !product)
     {
         goto cleanup;
     }
 
-    if (BN_is_prime_ex(pub->n, 256, ctx, NULL))
+    mont = BN_MONT_CTX_new();
+    if (!mont || !BN_MONT_CTX_set(mont, pub->n, ctx))
+    {
+        goto cleanup;
+    }
+
+    // n must not be a prime. every prime passes the fermat test so a single test is enough for soundness,
+    // more rounds (or miller rabin) only lower the chance of rejecting an honest modulus which is negligible anyway
+    if (!BN_sub(tmp, pub->n, BN_value_one()) || !BN_mod_exp_mont_word(tmp, 2, tmp, pub->n, ctx, mont))
+    {
+        goto cleanup;
+    }
+    if (BN_is_one(tmp))
     {
         ret = PAILLIER_ERROR_INVALID_KEY;
         goto cleanup;
@@ -1464,15 +1624,15 @@ long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const u
 
     ret = -1; //reset return value so goto cleanup could be used
 
-    if (is_coprime_fast(proof.w, pub->n, ctx) != 1)
+    // w and all y values must be coprime to n, which is true iff their product mod n is coprime to n,
+    // so the product is accumulated and checked once at the end instead of running a gcd per value
+    if (!BN_nnmod(product, proof.w, pub->n, ctx))
     {
-        ret = PAILLIER_ERROR_INVALID_PROOF;
         goto cleanup;
     }
 
-
     //prepare tmp for the 1st iteration to verify z
-    if (!BN_mod_exp(tmp, proof.z[0], pub->n, pub->n, ctx))
+    if (!BN_mod_exp_mont(tmp, proof.z[0], pub->n, pub->n, ctx, mont))
     {
         goto cleanup;
     }
@@ -1486,9 +1646,8 @@ long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const u
             deterministic_rand(seed, n_len, y, &seed);
         } while (BN_cmp(y, pub->n) >= 0);
         
-        if (is_coprime_fast(y, pub->n, ctx) != 1)
+        if (!BN_mod_mul(product, product, y, pub->n, ctx))
         {
-            ret = PAILLIER_ERROR_INVALID_PROOF;
             goto cleanup;
         }
 
@@ -1552,6 +1711,12 @@ long paillier_verify_paillier_blum_zkp(const paillier_public_key_t *pub, const u
         }
     }
 
+    if (is_coprime_fast(product, pub->n, ctx) != 1)
+    {
+        ret = PAILLIER_ERROR_INVALID_PROOF;
+        goto cleanup;
+    }
+
     ret = PAILLIER_SUCCESS;
 
 cleanup:
@@ -1560,7 +1725,7 @@ cleanup:
         ret = ERR_get_error() * -1;
     }
         
-    
+    BN_MONT_CTX_free(mont);
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
     return ret;
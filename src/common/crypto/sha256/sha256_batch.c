@@ -0,0 +1,270 @@
+#include "crypto/sha256/sha256_batch.h"
+
+#include "../common/multi_buffer_hash.h"
+
+#include <string.h>
+#include <openssl/sha.h>
+
+#ifdef MULTI_BUFFER_HASH_X86_64
+#define SHA256_BATCH_HAS_MULTI_BUFFER
+#endif
+
+// below this number of messages most of the lanes are idle and the multi buffer implementation isn't worth it
+#define SHA256_BATCH_MIN_MULTI_BUFFER_COUNT 4
+
+static sha256_batch_status sha256_batch_openssl(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        SHA256_CTX ctx;
+        SHA256_Init(&ctx);
+        for (uint32_t j = 0; j < messages[i].parts_count; j++)
+        {
+            if (messages[i].parts[j].len)
+                SHA256_Update(&ctx, messages[i].parts[j].data, messages[i].parts[j].len);
+        }
+        SHA256_Final(digests[i], &ctx);
+    }
+    return SHA256_BATCH_SUCCESS;
+}
+
+#ifdef SHA256_BATCH_HAS_MULTI_BUFFER
+
+#define SHA256_BATCH_MAX_LANES 16
+#define SHA256_BLOCK_SIZE 64
+
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+typedef uint32_t v16u32 __attribute__((vector_size(64)));
+
+// lane i of state[j] is word j of message i
+typedef uint32_t sha256_lanes_state_t[8][SHA256_BATCH_MAX_LANES];
+typedef uint8_t sha256_lanes_blocks_t[SHA256_BATCH_MAX_LANES][SHA256_BLOCK_SIZE];
+typedef void (*sha256_compression_t)(sha256_lanes_state_t state, const sha256_lanes_blocks_t blocks);
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t SHA256_IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define BIG_SIGMA0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define BIG_SIGMA1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SMALL_SIGMA0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SMALL_SIGMA1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+
+#define SHA256_COMPRESS(state, blocks, TYPE, LANES) \
+    do { \
+        TYPE w[16], S[8]; \
+        for (size_t i = 0; i < 8; i++) \
+            memcpy(&S[i], state[i], sizeof(TYPE)); \
+        TYPE a = S[0], b = S[1], c = S[2], d = S[3], e = S[4], f = S[5], g = S[6], h = S[7]; \
+        for (size_t t = 0; t < 16; t++) \
+        { \
+            for (size_t lane = 0; lane < (LANES); lane++) \
+            { \
+                const uint8_t *p = blocks[lane] + 4 * t; \
+                w[t][lane] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; \
+            } \
+        } \
+        for (size_t t = 0; t < 64; t++) \
+        { \
+            if (t >= 16) \
+                w[t & 15] += SMALL_SIGMA1(w[(t + 14) & 15]) + w[(t + 9) & 15] + SMALL_SIGMA0(w[(t + 1) & 15]); \
+            TYPE t1 = h + BIG_SIGMA1(e) + CH(e, f, g) + SHA256_K[t] + w[t & 15]; \
+            TYPE t2 = BIG_SIGMA0(a) + MAJ(a, b, c); \
+            h = g; \
+            g = f; \
+            f = e; \
+            e = d + t1; \
+            d = c; \
+            c = b; \
+            b = a; \
+            a = t1 + t2; \
+        } \
+        S[0] += a; \
+        S[1] += b; \
+        S[2] += c; \
+        S[3] += d; \
+        S[4] += e; \
+        S[5] += f; \
+        S[6] += g; \
+        S[7] += h; \
+        for (size_t i = 0; i < 8; i++) \
+            memcpy(state[i], &S[i], sizeof(TYPE)); \
+    } while (0)
+
+__attribute__((target("avx2")))
+static void sha256_compress_x8(sha256_lanes_state_t state, const sha256_lanes_blocks_t blocks)
+{
+    SHA256_COMPRESS(state, blocks, v8u32, 8);
+}
+
+__attribute__((target("avx512f")))
+static void sha256_compress_x16(sha256_lanes_state_t state, const sha256_lanes_blocks_t blocks)
+{
+    SHA256_COMPRESS(state, blocks, v16u32, 16);
+}
+
+typedef struct
+{
+    sha256_lanes_state_t state;
+    sha256_lanes_blocks_t blocks;
+    sha256_compression_t compress;
+    sha256_md_t *digests;
+} sha256_multi_buffer_ctx_t;
+
+static uint32_t sha256_parts_count(const void *messages, size_t index)
+{
+    return ((const sha256_batch_message_t*)messages)[index].parts_count;
+}
+
+static multi_buffer_hash_part_t sha256_part(const void *messages, size_t index, uint32_t part)
+{
+    const sha256_batch_buffer_t *buffer = &((const sha256_batch_message_t*)messages)[index].parts[part];
+    multi_buffer_hash_part_t ret = {buffer->data, buffer->len};
+    return ret;
+}
+
+static void sha256_finish_padding(uint8_t *block, size_t block_size, uint64_t length)
+{
+    const uint64_t bits = length * 8;
+    for (size_t i = 0; i < 8; i++)
+        block[block_size - 1 - i] = (uint8_t)(bits >> (8 * i));
+}
+
+static void sha256_reset_lane(void *ctx, size_t lane)
+{
+    sha256_multi_buffer_ctx_t *sha_ctx = (sha256_multi_buffer_ctx_t*)ctx;
+    for (size_t i = 0; i < 8; i++)
+        sha_ctx->state[i][lane] = SHA256_IV[i];
+}
+
+static void sha256_load_block(void *ctx, size_t lane, const uint8_t *block)
+{
+    memcpy(((sha256_multi_buffer_ctx_t*)ctx)->blocks[lane], block, SHA256_BLOCK_SIZE);
+}
+
+static void sha256_compress(void *ctx)
+{
+    sha256_multi_buffer_ctx_t *sha_ctx = (sha256_multi_buffer_ctx_t*)ctx;
+    sha_ctx->compress(sha_ctx->state, (const uint8_t (*)[SHA256_BLOCK_SIZE])sha_ctx->blocks);
+}
+
+static void sha256_store_digest(void *ctx, size_t lane, size_t index)
+{
+    sha256_multi_buffer_ctx_t *sha_ctx = (sha256_multi_buffer_ctx_t*)ctx;
+    uint8_t *md = sha_ctx->digests[index];
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint32_t word = sha_ctx->state[i][lane];
+        md[4 * i] = (uint8_t)(word >> 24);
+        md[4 * i + 1] = (uint8_t)(word >> 16);
+        md[4 * i + 2] = (uint8_t)(word >> 8);
+        md[4 * i + 3] = (uint8_t)word;
+    }
+}
+
+static sha256_batch_status sha256_batch_multi_buffer(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests,
+    size_t lanes_count, sha256_compression_t compress)
+{
+    const multi_buffer_hash_t hash = {
+        lanes_count,
+        SHA256_BLOCK_SIZE,
+        0x80,
+        9, // 0x80 and the 64 bit length
+        sha256_parts_count,
+        sha256_part,
+        sha256_finish_padding,
+        sha256_reset_lane,
+        sha256_load_block,
+        sha256_compress,
+        sha256_store_digest
+    };
+    sha256_multi_buffer_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.compress = compress;
+    ctx.digests = digests;
+    multi_buffer_hash_run(&hash, &ctx, messages, count);
+    return SHA256_BATCH_SUCCESS;
+}
+
+static int cpu_supports_avx2(void)
+{
+    return (multi_buffer_hash_cpu_features() & MULTI_BUFFER_HASH_CPU_AVX2) != 0;
+}
+
+static int cpu_supports_avx512(void)
+{
+    return (multi_buffer_hash_cpu_features() & MULTI_BUFFER_HASH_CPU_AVX512F) != 0;
+}
+
+#endif // SHA256_BATCH_HAS_MULTI_BUFFER
+
+sha256_batch_impl sha256_batch_default_impl(void)
+{
+#ifdef SHA256_BATCH_HAS_MULTI_BUFFER
+    const unsigned int features = multi_buffer_hash_cpu_features();
+    if (features & MULTI_BUFFER_HASH_CPU_SHA_NI)
+        return SHA256_BATCH_IMPL_OPENSSL;
+    return cpu_supports_avx512() ? SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512 : cpu_supports_avx2() ? SHA256_BATCH_IMPL_MULTI_BUFFER : SHA256_BATCH_IMPL_OPENSSL;
+#else
+    return SHA256_BATCH_IMPL_OPENSSL;
+#endif
+}
+
+sha256_batch_status sha256_batch_with_impl(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests, sha256_batch_impl impl)
+{
+    if (!count)
+        return SHA256_BATCH_SUCCESS;
+    if (!messages || !digests)
+        return SHA256_BATCH_INVALID_PARAMETER;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (messages[i].parts_count && !messages[i].parts)
+            return SHA256_BATCH_INVALID_PARAMETER;
+        for (uint32_t j = 0; j < messages[i].parts_count; j++)
+        {
+            if (messages[i].parts[j].len && !messages[i].parts[j].data)
+                return SHA256_BATCH_INVALID_PARAMETER;
+        }
+    }
+
+    if (impl == SHA256_BATCH_IMPL_AUTO)
+        impl = count < SHA256_BATCH_MIN_MULTI_BUFFER_COUNT ? SHA256_BATCH_IMPL_OPENSSL : sha256_batch_default_impl();
+
+    switch (impl)
+    {
+    case SHA256_BATCH_IMPL_OPENSSL:
+        return sha256_batch_openssl(messages, count, digests);
+    case SHA256_BATCH_IMPL_MULTI_BUFFER:
+#ifdef SHA256_BATCH_HAS_MULTI_BUFFER
+        if (cpu_supports_avx2())
+            return sha256_batch_multi_buffer(messages, count, digests, 8, sha256_compress_x8);
+#endif
+        return SHA256_BATCH_NOT_SUPPORTED;
+    case SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512:
+#ifdef SHA256_BATCH_HAS_MULTI_BUFFER
+        if (cpu_supports_avx512())
+            return sha256_batch_multi_buffer(messages, count, digests, 16, sha256_compress_x16);
+#endif
+        return SHA256_BATCH_NOT_SUPPORTED;
+    case SHA256_BATCH_IMPL_AUTO:
+    default:
+        return SHA256_BATCH_INVALID_PARAMETER;
+    }
+}
+
+sha256_batch_status sha256_batch(const sha256_batch_message_t *messages, uint32_t count, sha256_md_t *digests)
+{
+    return sha256_batch_with_impl(messages, count, digests, SHA256_BATCH_IMPL_AUTO);
+}
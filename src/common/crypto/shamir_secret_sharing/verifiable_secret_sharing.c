@@ -2,8 +2,27 @@
 
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
 
 #include <openssl/bn.h>
+#include <openssl/rand.h>
+
+// the signers of a t of n key repeat across signings, so the lagrange coefficients of the recently used ids sets are kept
+#define LAGRANGE_CACHE_SIZE 64
+
+typedef struct
+{
+    elliptic_curve256_type_t type;
+    uint8_t count; // 0 for an unused entry
+    uint64_t *ids; // sorted
+    elliptic_curve256_scalar_t *coefficients; // coefficients[i] is the coefficient of ids[i]
+    uint64_t last_used;
+} lagrange_cache_entry_t;
+
+static lagrange_cache_entry_t lagrange_cache[LAGRANGE_CACHE_SIZE];
+static uint64_t lagrange_cache_clock = 0;
+static pthread_mutex_t lagrange_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
 struct verifiable_secret_sharing 
 {
@@ -34,11 +53,14 @@ static verifiable_secret_sharing_status from_commitments_status(commitments_stat
 // ↳ Threshold validation t <= n enforced by caller functions
 // ↳ Secret range validation handled by BN_mod operations
 // ↳ Uses secure polynomial evaluation over finite field
-static verifiable_secret_sharing_status create_shares(const elliptic_curve256_algebra_ctx_t *algebra, const BIGNUM *secret, uint8_t t, uint8_t n, const BIGNUM **mat, verifiable_secret_sharing_t *shares, BN_CTX *ctx, const BIGNUM *prime)
+static verifiable_secret_sharing_status create_shares(const elliptic_curve256_algebra_ctx_t *algebra, const BIGNUM *secret, uint8_t t, uint8_t n, const uint64_t *ids, verifiable_secret_sharing_t *shares, BN_CTX *ctx, const BIGNUM *prime)
 {
     verifiable_secret_sharing_status ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
-    elliptic_curve256_scalar_t coefficient;
-    BIGNUM *tmp = NULL;
+    elliptic_curve_algebra_status status;
+    elliptic_curve256_scalar_t *scalars = NULL;
+    elliptic_curve256_point_t *points = NULL;
+    BN_MONT_CTX *mont = NULL;
+    BIGNUM *x = NULL;
     BIGNUM *share = NULL;
     BIGNUM **polynom = (BIGNUM**)calloc(t, sizeof(BIGNUM*));
     
@@ -77,65 +99,76 @@ static verifiable_secret_sharing_status create_shares(const elliptic_curve256_al
     shares->coefficient_proofs = calloc(t, sizeof(elliptic_curve256_point_t));
     if (!shares->coefficient_proofs)
         goto cleanup;
-    
+
+    // the coefficients and then the shares, so all the proofs are computed in a single batch
+    scalars = calloc(t + n, sizeof(elliptic_curve256_scalar_t));
+    if (!scalars)
+        goto cleanup;
+    points = calloc(t + n, sizeof(elliptic_curve256_point_t));
+    if (!points)
+        goto cleanup;
+
     for (size_t i = 0; i < t; ++i)
     {
-        elliptic_curve_algebra_status status;
-        if (BN_bn2binpad(polynom[i], coefficient, sizeof(elliptic_curve256_scalar_t)) <= 0)
-            goto cleanup;
-        status = shares->algebra->generator_mul(shares->algebra, &shares->coefficient_proofs[i], &coefficient);
-        if (status != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
-        {
-            ret = (status == ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY) ? VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY : VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+        if (BN_bn2binpad(polynom[i], scalars[i], sizeof(elliptic_curve256_scalar_t)) <= 0)
             goto cleanup;
-        }
     }
-    // @audit-ok: Secure cleanup of sensitive coefficient data
-    OPENSSL_cleanse(coefficient, sizeof(elliptic_curve256_scalar_t));
-    
-    tmp = BN_CTX_get(ctx);
-    if (!tmp)
-        goto cleanup;
 
+    x = BN_CTX_get(ctx);
     share = BN_CTX_get(ctx);
-    if (!share)
+    if (!x || !share)
+        goto cleanup;
+    mont = BN_MONT_CTX_new();
+    if (!mont || !BN_MONT_CTX_set(mont, prime, ctx))
         goto cleanup;
 
-
-    // multiply the access matrix and the coefficient vector to get the sharws
+    // evaluate the polynom at each id using horner's rule, x is kept in montgomery form so each step is a single montgomery multiplication
     for (size_t i = 0; i < n; ++i)
     {
-        elliptic_curve_algebra_status status;
-        
-        if (!share)
+        if (!BN_set_word(x, ids[i]) || !BN_to_montgomery(x, x, mont, ctx))
             goto cleanup;
-        BN_zero_ex(share);
-
-        for (size_t j = 0; j < t; j++)
+        if (!BN_copy(share, polynom[t - 1]))
+            goto cleanup;
+        
+        for (size_t j = t - 1; j > 0; --j)
         {
-            if (!BN_mod_mul(tmp, mat[i * t + j], polynom[j], prime, ctx))
+            if (!BN_mod_mul_montgomery(share, share, x, mont, ctx))
                 goto cleanup;
-            if (!BN_mod_add_quick(share, share, tmp, prime))
+            if (!BN_mod_add_quick(share, share, polynom[j - 1], prime))
                 goto cleanup;
         }
         if (BN_bn2binpad(share, shares->shares[i], sizeof(shamir_secret_sharing_scalar_t)) <= 0)
             goto cleanup;
-        status = shares->algebra->generator_mul(shares->algebra, &shares->proofs[i], &shares->shares[i]);
-        if (status != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
-        {
-            ret = (status == ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY) ? VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY : VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
-            goto cleanup;
-        }
+        memcpy(scalars[t + i], shares->shares[i], sizeof(elliptic_curve256_scalar_t));
     }
+
+    status = algebra->generator_mul_batch(algebra, points, (const elliptic_curve256_scalar_t*)scalars, t + n);
+    if (status != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+    {
+        ret = (status == ELLIPTIC_CURVE_ALGEBRA_OUT_OF_MEMORY) ? VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY : VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+        goto cleanup;
+    }
+    memcpy(shares->coefficient_proofs, points, t * sizeof(elliptic_curve256_point_t));
+    memcpy(shares->proofs, points + t, n * sizeof(elliptic_curve256_point_t));
     ret = VERIFIABLE_SECRET_SHARING_SUCCESS;
 
 cleanup:
+    if (share)
+        BN_clear(share);
+    BN_MONT_CTX_free(mont);
     BN_CTX_end(ctx);
     free(polynom);
+    if (scalars)
+    {
+        // @audit-ok: Secure cleanup of sensitive coefficient data
+        OPENSSL_cleanse(scalars, (t + n) * sizeof(elliptic_curve256_scalar_t));
+        free(scalars);
+    }
+    free(points);
     return ret;
 }
 
-static verifiable_secret_sharing_status verifiable_secret_sharing_split_impl(const elliptic_curve256_algebra_ctx_t *algebra, const uint8_t *secret, uint32_t secret_len, uint8_t t, uint8_t n, BIGNUM **access_mat, 
+static verifiable_secret_sharing_status verifiable_secret_sharing_split_impl(const elliptic_curve256_algebra_ctx_t *algebra, const uint8_t *secret, uint32_t secret_len, uint8_t t, uint8_t n, 
     verifiable_secret_sharing_t **shares, uint64_t *ids, BN_CTX *ctx)
 {
     BIGNUM *bn_secret = NULL;
@@ -161,12 +194,9 @@ static verifiable_secret_sharing_status verifiable_secret_sharing_split_impl(con
         goto cleanup;
     }
 
-    for (size_t i = 0; i < t*n; ++i)
-        BN_mod(access_mat[i], access_mat[i], bn_prime, ctx);
-    
     shares_local->ids = ids;
     
-    if (create_shares(algebra, bn_secret, t, n, (const BIGNUM**)access_mat, shares_local, ctx, bn_prime) == 0)
+    if (create_shares(algebra, bn_secret, t, n, ids, shares_local, ctx, bn_prime) == 0)
     {
         *shares = shares_local;
         ret = VERIFIABLE_SECRET_SHARING_SUCCESS;
@@ -197,8 +227,6 @@ cleanup:
 verifiable_secret_sharing_status verifiable_secret_sharing_split(const elliptic_curve256_algebra_ctx_t *algebra, const uint8_t *secret, uint32_t secret_len, uint8_t t, uint8_t n, verifiable_secret_sharing_t **shares)
 {
     BN_CTX *ctx = NULL;
-    BIGNUM **mat = NULL;
-    BIGNUM *one = NULL;
     uint64_t *ids = NULL;
     verifiable_secret_sharing_status ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     
@@ -209,55 +237,17 @@ verifiable_secret_sharing_status verifiable_secret_sharing_split(const elliptic_
     {
         return VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     }
-    BN_CTX_start(ctx);
-    
-    mat = (BIGNUM**)calloc(n * t, sizeof(BIGNUM*));
-    if (!mat)
-        goto cleanup;   
-    one = BN_CTX_get(ctx);
-    if (!one)
-        goto cleanup;
-    BN_one(one);
 
     ids = (uint64_t*)calloc(n, sizeof(uint64_t));
     if (!ids)
         goto cleanup;
-    ids[0] = 1;
 
-    // init first row to one
-    for (size_t i = 0; i < t; ++i)
-        mat[i] = one;
-
-    for (size_t i = 1; i < n; ++i)
-    {
-        BIGNUM *prev = one;
+    for (size_t i = 0; i < n; ++i)
         ids[i] = i + 1;
-
-        // init first cal to one
-        mat[i * t] = one;
-        for (size_t j = 1; j < t; ++j)
-        {
-            BIGNUM *cur = BN_CTX_get(ctx);
-            if (!cur)
-                goto cleanup;
-            if (!BN_copy(cur, prev))
-                goto cleanup;
-            if (!BN_mul_word(cur, i + 1))
-                goto cleanup;
-            mat[i * t + j] = cur;
-            prev = cur;
-        }
-    }
-    ret = verifiable_secret_sharing_split_impl(algebra, secret, secret_len, t, n, mat, shares, ids, ctx);
+    ret = verifiable_secret_sharing_split_impl(algebra, secret, secret_len, t, n, shares, ids, ctx);
 
 cleanup:
-    if (ctx)
-    {
-        BN_CTX_end(ctx);
-        BN_CTX_free(ctx);
-    }
-    if (mat)
-        free(mat);
+    BN_CTX_free(ctx);
     if (ret != VERIFIABLE_SECRET_SHARING_SUCCESS)
         free(ids);
     return ret;
@@ -267,8 +257,6 @@ verifiable_secret_sharing_status verifiable_secret_sharing_split_with_custom_ids
     verifiable_secret_sharing_t **shares)
 {
     BN_CTX *ctx = NULL;
-    BIGNUM **mat = NULL;
-    BIGNUM *one = NULL;
     uint64_t *local_ids = NULL;
     verifiable_secret_sharing_status ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     
@@ -280,15 +268,6 @@ verifiable_secret_sharing_status verifiable_secret_sharing_split_with_custom_ids
     {
         return VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     }
-    BN_CTX_start(ctx);
-    
-    mat = (BIGNUM**)calloc(n * t, sizeof(BIGNUM*));
-    if (!mat)
-        goto cleanup;   
-    one = BN_CTX_get(ctx);
-    if (!one)
-        goto cleanup;
-    BN_one(one);
 
     local_ids = (uint64_t*)calloc(n, sizeof(uint64_t));
     if (!local_ids)
@@ -311,36 +290,10 @@ verifiable_secret_sharing_status verifiable_secret_sharing_split_with_custom_ids
             }
         }
     }
-    
-    for (size_t i = 0; i < n; ++i)
-    {
-        BIGNUM *prev = one;
-
-        // init first cal to one
-        mat[i * t] = one;
-        for (size_t j = 1; j < t; ++j)
-        {
-            BIGNUM *cur = BN_CTX_get(ctx);
-            if (!cur)
-                goto cleanup;
-            if (!BN_copy(cur, prev))
-                goto cleanup;
-            if (!BN_mul_word(cur, local_ids[i]))
-                goto cleanup;
-            mat[i * t + j] = cur;
-            prev = cur;
-        }
-    }
-    ret = verifiable_secret_sharing_split_impl(algebra, secret, secret_len, t, n, mat, shares, local_ids, ctx);
+    ret = verifiable_secret_sharing_split_impl(algebra, secret, secret_len, t, n, shares, local_ids, ctx);
 
 cleanup:
-    if (ctx)
-    {
-        BN_CTX_end(ctx);
-        BN_CTX_free(ctx);
-    }
-    if (mat)
-        free(mat);
+    BN_CTX_free(ctx);
     if (ret != VERIFIABLE_SECRET_SHARING_SUCCESS)
         free(local_ids);
     return ret;
@@ -429,48 +382,193 @@ verifiable_secret_sharing_status verifiable_secret_sharing_get_polynom_commitmen
     return status;
 }
 
-static int lagrange_interpolate(const shamir_secret_share_t *shares, uint8_t shares_count, uint8_t index, BIGNUM *p, const BIGNUM *field, BN_CTX *ctx)
+static int compare_ids(const void *a, const void *b)
+{
+    uint64_t id_a = *(const uint64_t*)a;
+    uint64_t id_b = *(const uint64_t*)b;
+    return id_a < id_b ? -1 : id_a > id_b ? 1 : 0;
+}
+
+// lambda[i] = prod(x[j]) / (x[i] * prod(x[j] - x[i])) for j != i, all the denominators are inverted together using batch_inverse
+static verifiable_secret_sharing_status compute_lagrange_coefficients(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, uint8_t count, elliptic_curve256_scalar_t *coefficients)
 {
-    int ret = 0;
+    BN_CTX *ctx = NULL;
+    BIGNUM *numerator = NULL;
+    BIGNUM *denominator = NULL;
     BIGNUM *x = NULL;
-    BIGNUM *other_x = NULL;
     BIGNUM *tmp = NULL;
+    const BIGNUM *field = algebra->order_internal(algebra);
+    verifiable_secret_sharing_status ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+
+    if (!field)
+        return VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
 
+    ctx = BN_CTX_new();
+    if (!ctx)
+        return VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     BN_CTX_start(ctx);
+
+    numerator = BN_CTX_get(ctx);
+    denominator = BN_CTX_get(ctx);
     x = BN_CTX_get(ctx);
-    other_x = BN_CTX_get(ctx);
     tmp = BN_CTX_get(ctx);
-
-    if (!x || !other_x || !tmp)
-        goto cleanup;
-    
-    if (!BN_set_word(x, shares[index].id))
-        goto cleanup;
-    if (!BN_one(p))
+    if (!tmp)
         goto cleanup;
 
-    for (uint8_t i = 0; i < shares_count; ++i)
+    ret = VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+    if (!BN_one(numerator))
+        goto cleanup;
+    for (uint8_t i = 0; i < count; ++i)
     {
-        if (i == index)
-            continue;
-        if (!BN_set_word(other_x, shares[i].id))
+        if (!BN_set_word(x, ids[i]) || !BN_copy(denominator, x))
             goto cleanup;
-        if (!BN_mod_sub_quick(tmp, other_x, x, field))
+        if (!BN_mod_mul(numerator, numerator, x, field, ctx))
             goto cleanup;
-        if (!BN_mod_inverse(tmp, tmp, field, ctx))
+        for (uint8_t j = 0; j < count; ++j)
+        {
+            if (j == i)
+                continue;
+            if (!BN_set_word(tmp, ids[j]) || !BN_mod_sub_quick(tmp, tmp, x, field))
+                goto cleanup;
+            if (!BN_mod_mul(denominator, denominator, tmp, field, ctx))
+                goto cleanup;
+        }
+        if (BN_bn2binpad(denominator, coefficients[i], sizeof(elliptic_curve256_scalar_t)) <= 0)
             goto cleanup;
-        if (!BN_mod_mul(tmp, tmp, other_x, field, ctx))
+    }
+
+    // the ids are public, so there is no need for the constant time inversion
+    if (algebra->batch_inverse(algebra, coefficients, coefficients, count, 0) != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+        goto cleanup;
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        if (!BN_bin2bn(coefficients[i], sizeof(elliptic_curve256_scalar_t), tmp))
+            goto cleanup;
+        if (!BN_mod_mul(tmp, tmp, numerator, field, ctx))
             goto cleanup;
-        if (!BN_mod_mul(p, p, tmp, field, ctx))
+        if (BN_bn2binpad(tmp, coefficients[i], sizeof(elliptic_curve256_scalar_t)) <= 0)
             goto cleanup;
     }
-    ret = 1;
+    ret = VERIFIABLE_SECRET_SHARING_SUCCESS;
 
 cleanup:
     BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
     return ret;
 }
 
+static const lagrange_cache_entry_t *lagrange_cache_find(elliptic_curve256_type_t type, const uint64_t *sorted_ids, uint8_t count)
+{
+    for (size_t i = 0; i < LAGRANGE_CACHE_SIZE; ++i)
+    {
+        lagrange_cache_entry_t *entry = &lagrange_cache[i];
+        if (entry->count == count && entry->type == type && memcmp(entry->ids, sorted_ids, count * sizeof(uint64_t)) == 0)
+        {
+            entry->last_used = ++lagrange_cache_clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// takes ownership over ids and coefficients, replaces the least recently used entry
+static void lagrange_cache_insert(elliptic_curve256_type_t type, uint64_t *sorted_ids, uint8_t count, elliptic_curve256_scalar_t *coefficients)
+{
+    lagrange_cache_entry_t *entry = &lagrange_cache[0];
+    for (size_t i = 1; i < LAGRANGE_CACHE_SIZE && entry->count; ++i)
+    {
+        if (!lagrange_cache[i].count || lagrange_cache[i].last_used < entry->last_used)
+            entry = &lagrange_cache[i];
+    }
+    free(entry->ids);
+    free(entry->coefficients);
+    entry->type = type;
+    entry->count = count;
+    entry->ids = sorted_ids;
+    entry->coefficients = coefficients;
+    entry->last_used = ++lagrange_cache_clock;
+}
+
+verifiable_secret_sharing_status verifiable_secret_sharing_get_lagrange_coefficients(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, uint8_t ids_count, elliptic_curve256_scalar_t *coefficients)
+{
+    const lagrange_cache_entry_t *entry;
+    uint64_t *sorted_ids = NULL;
+    elliptic_curve256_scalar_t *sorted_coefficients = NULL;
+    verifiable_secret_sharing_status ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+
+    if (!algebra || !ids || !ids_count || !coefficients)
+        return VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER;
+
+    sorted_ids = (uint64_t*)malloc(ids_count * sizeof(uint64_t));
+    if (!sorted_ids)
+        return VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+    memcpy(sorted_ids, ids, ids_count * sizeof(uint64_t));
+    qsort(sorted_ids, ids_count, sizeof(uint64_t), compare_ids);
+    for (uint8_t i = 0; i < ids_count; ++i)
+    {
+        if (!sorted_ids[i] || (i && sorted_ids[i] == sorted_ids[i - 1]))
+        {
+            free(sorted_ids);
+            return VERIFIABLE_SECRET_SHARING_INVALID_SHARE_ID;
+        }
+    }
+
+    pthread_mutex_lock(&lagrange_cache_lock);
+    entry = lagrange_cache_find(algebra->type, sorted_ids, ids_count);
+    if (entry)
+    {
+        for (uint8_t i = 0; i < ids_count; ++i)
+        {
+            const uint64_t *pos = (const uint64_t*)bsearch(&ids[i], entry->ids, ids_count, sizeof(uint64_t), compare_ids);
+            memcpy(coefficients[i], entry->coefficients[pos - entry->ids], sizeof(elliptic_curve256_scalar_t));
+        }
+        pthread_mutex_unlock(&lagrange_cache_lock);
+        free(sorted_ids);
+        return VERIFIABLE_SECRET_SHARING_SUCCESS;
+    }
+    pthread_mutex_unlock(&lagrange_cache_lock);
+
+    sorted_coefficients = (elliptic_curve256_scalar_t*)malloc(ids_count * sizeof(elliptic_curve256_scalar_t));
+    if (!sorted_coefficients)
+        goto cleanup;
+    ret = compute_lagrange_coefficients(algebra, sorted_ids, ids_count, sorted_coefficients);
+    if (ret != VERIFIABLE_SECRET_SHARING_SUCCESS)
+        goto cleanup;
+    for (uint8_t i = 0; i < ids_count; ++i)
+    {
+        const uint64_t *pos = (const uint64_t*)bsearch(&ids[i], sorted_ids, ids_count, sizeof(uint64_t), compare_ids);
+        memcpy(coefficients[i], sorted_coefficients[pos - sorted_ids], sizeof(elliptic_curve256_scalar_t));
+    }
+
+    pthread_mutex_lock(&lagrange_cache_lock);
+    // another thread may have added the same ids meanwhile
+    if (!lagrange_cache_find(algebra->type, sorted_ids, ids_count))
+    {
+        lagrange_cache_insert(algebra->type, sorted_ids, ids_count, sorted_coefficients);
+        sorted_ids = NULL;
+        sorted_coefficients = NULL;
+    }
+    pthread_mutex_unlock(&lagrange_cache_lock);
+
+cleanup:
+    free(sorted_ids);
+    free(sorted_coefficients);
+    return ret;
+}
+
+void verifiable_secret_sharing_clear_lagrange_cache(void)
+{
+    pthread_mutex_lock(&lagrange_cache_lock);
+    for (size_t i = 0; i < LAGRANGE_CACHE_SIZE; ++i)
+    {
+        free(lagrange_cache[i].ids);
+        free(lagrange_cache[i].coefficients);
+        memset(&lagrange_cache[i], 0, sizeof(lagrange_cache_entry_t));
+    }
+    pthread_mutex_unlock(&lagrange_cache_lock);
+}
+
 // @audit-ok: Properly validates share uniqueness before reconstruction
 // ↳ Lines 482-489: Ensures all share IDs are non-zero and unique
 // ↳ Prevents duplicate share attacks in Lagrange interpolation
@@ -483,6 +581,8 @@ verifiable_secret_sharing_status verifiable_secret_sharing_reconstruct(const ell
     BIGNUM *tmp = NULL;
     BIGNUM *y_value = NULL;
     const BIGNUM *bn_prime = NULL;
+    uint64_t *ids = NULL;
+    elliptic_curve256_scalar_t *coefficients = NULL;
     int ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
 
     if (!algebra || !shares || !shares_count || (!secret && secret_len))
@@ -497,9 +597,20 @@ verifiable_secret_sharing_status verifiable_secret_sharing_reconstruct(const ell
                 return VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER;
     }
 
+    ids = (uint64_t*)malloc(shares_count * sizeof(uint64_t));
+    coefficients = (elliptic_curve256_scalar_t*)malloc(shares_count * sizeof(elliptic_curve256_scalar_t));
+    if (!ids || !coefficients)
+    {
+        free(ids);
+        free(coefficients);
+        return ret;
+    }
+    for (uint8_t i = 0; i < shares_count; ++i)
+        ids[i] = shares[i].id;
+
     ctx = BN_CTX_new();
     if (!ctx)
-        return ret;
+        goto cleanup;
     BN_CTX_start(ctx);
     
     bn_prime = algebra->order_internal(algebra);
@@ -517,12 +628,17 @@ verifiable_secret_sharing_status verifiable_secret_sharing_reconstruct(const ell
     y_value = BN_CTX_get(ctx);
     if (!y_value)
         goto cleanup;
+
+    ret = verifiable_secret_sharing_get_lagrange_coefficients(algebra, ids, shares_count, coefficients);
+    if (ret != VERIFIABLE_SECRET_SHARING_SUCCESS)
+        goto cleanup;
+    ret = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
     
     for (uint8_t i = 0; i < shares_count; ++i)
     {
         if (!BN_bin2bn(shares[i].data, sizeof(shamir_secret_sharing_scalar_t), y_value))
             goto cleanup;
-        if (!lagrange_interpolate(shares, shares_count, i, tmp, bn_prime, ctx))
+        if (!BN_bin2bn(coefficients[i], sizeof(elliptic_curve256_scalar_t), tmp))
             goto cleanup;
         if (!BN_mod_mul(tmp, y_value, tmp, bn_prime, ctx))
             goto cleanup;
@@ -538,8 +654,14 @@ verifiable_secret_sharing_status verifiable_secret_sharing_reconstruct(const ell
         ret = BN_bn2bin(sum, secret) > 0 ? VERIFIABLE_SECRET_SHARING_SUCCESS : VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
 
 cleanup:
+    if (y_value)
+        BN_clear(y_value);
+    if (sum)
+        BN_clear(sum);
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
+    free(ids);
+    free(coefficients);
     return ret;
 }
 
@@ -610,6 +732,164 @@ cleanup:
     return status;
 }
 
+// checks that sum(z[k] * (sum(x[k]^j * coefficient_proofs[k][j]) - share_proofs[k])) is the identity for random z[k], z[begin] is 1 so share_proofs[begin] is used as the sum point.
+// shares of the same dealer (equal coefficient proofs) are merged so each coefficient proof is multiplied once
+static verifiable_secret_sharing_status verify_shares_linear_combination(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, const elliptic_curve256_point_t *share_proofs, uint32_t begin, uint32_t end, 
+    uint8_t threshold, const elliptic_curve256_point_t *coefficient_proofs, BN_CTX *ctx)
+{
+    const uint32_t count = end - begin;
+    uint32_t dealers = 0;
+    uint32_t points_count;
+    elliptic_curve256_point_t *points = NULL;
+    elliptic_curve256_scalar_t *coefficients = NULL;
+    BIGNUM **sums = NULL;
+    const BIGNUM *field = algebra->order_internal(algebra);
+    BIGNUM *x = NULL;
+    BIGNUM *z = NULL;
+    BIGNUM *tmp = NULL;
+    uint8_t res = 0;
+    verifiable_secret_sharing_status status = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+
+    if (!field)
+        return VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+
+    BN_CTX_start(ctx);
+    x = BN_CTX_get(ctx);
+    z = BN_CTX_get(ctx);
+    tmp = BN_CTX_get(ctx);
+    if (!tmp)
+        goto cleanup;
+    // the dealers coefficient proofs followed by the share proofs (except the first one)
+    points = (elliptic_curve256_point_t*)malloc((count * threshold + count - 1) * sizeof(elliptic_curve256_point_t));
+    coefficients = (elliptic_curve256_scalar_t*)malloc((count * threshold + count - 1) * sizeof(elliptic_curve256_scalar_t));
+    sums = (BIGNUM**)calloc(count * threshold, sizeof(BIGNUM*));
+    if (!points || !coefficients || !sums)
+        goto cleanup;
+
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        const elliptic_curve256_point_t *polynom = coefficient_proofs + (size_t)(begin + k) * threshold;
+        uint32_t dealer = 0;
+
+        while (dealer < dealers && memcmp(points + dealer * threshold, polynom, threshold * sizeof(elliptic_curve256_point_t)))
+            ++dealer;
+        if (dealer == dealers)
+        {
+            memcpy(points + dealer * threshold, polynom, threshold * sizeof(elliptic_curve256_point_t));
+            for (uint8_t j = 0; j < threshold; ++j)
+            {
+                sums[dealer * threshold + j] = BN_CTX_get(ctx);
+                if (!sums[dealer * threshold + j])
+                    goto cleanup;
+                BN_zero(sums[dealer * threshold + j]);
+            }
+            ++dealers;
+        }
+
+        status = VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+        if (!BN_set_word(x, ids[begin + k]))
+            goto cleanup;
+        if (k == 0)
+        {
+            if (!BN_one(z))
+                goto cleanup;
+        }
+        else
+        {
+            // 128 bit random coefficients are enough to make a forged share pass with probability 2^-128
+            uint8_t random[16];
+            if (!RAND_bytes(random, sizeof(random)) || !BN_bin2bn(random, sizeof(random), z))
+                goto cleanup;
+        }
+
+        if (!BN_copy(tmp, z))
+            goto cleanup;
+        for (uint8_t j = 0; j < threshold; ++j)
+        {
+            if (j && !BN_mod_mul(tmp, tmp, x, field, ctx))
+                goto cleanup;
+            if (!BN_mod_add_quick(sums[dealer * threshold + j], sums[dealer * threshold + j], tmp, field))
+                goto cleanup;
+        }
+        
+        // the share proofs are stored after the end of the dealers coefficient proofs and moved down later
+        if (k && (!BN_sub(tmp, field, z) || BN_bn2binpad(tmp, coefficients[count * threshold + k - 1], sizeof(elliptic_curve256_scalar_t)) < 0))
+            goto cleanup;
+        if (k)
+            memcpy(points[count * threshold + k - 1], share_proofs[begin + k], sizeof(elliptic_curve256_point_t));
+        status = VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+    }
+
+    status = VERIFIABLE_SECRET_SHARING_UNKNOWN_ERROR;
+    for (uint32_t i = 0; i < dealers * threshold; ++i)
+    {
+        if (BN_bn2binpad(sums[i], coefficients[i], sizeof(elliptic_curve256_scalar_t)) < 0)
+            goto cleanup;
+    }
+    points_count = dealers * threshold + count - 1;
+    if (dealers < count)
+    {
+        memmove(points + dealers * threshold, points + count * threshold, (count - 1) * sizeof(elliptic_curve256_point_t));
+        memmove(coefficients + dealers * threshold, coefficients + count * threshold, (count - 1) * sizeof(elliptic_curve256_scalar_t));
+    }
+
+    if (algebra->verify_linear_combination(algebra, &share_proofs[begin], points, coefficients, points_count, &res) != ELLIPTIC_CURVE_ALGEBRA_SUCCESS)
+        goto cleanup;
+    status = res ? VERIFIABLE_SECRET_SHARING_SUCCESS : VERIFIABLE_SECRET_SHARING_INVALID_SHARE;
+
+cleanup:
+    BN_CTX_end(ctx);
+    free(points);
+    free(coefficients);
+    free(sums);
+    return status;
+}
+
+static verifiable_secret_sharing_status verify_shares_range(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, const elliptic_curve256_point_t *share_proofs, uint32_t begin, uint32_t end, 
+    uint8_t threshold, const elliptic_curve256_point_t *coefficient_proofs, BN_CTX *ctx, uint32_t *invalid_index)
+{
+    verifiable_secret_sharing_status status;
+    uint32_t middle;
+
+    if (end - begin == 1)
+        status = verifiable_secret_sharing_verify_share(algebra, ids[begin], &share_proofs[begin], threshold, coefficient_proofs + (size_t)begin * threshold);
+    else
+        status = verify_shares_linear_combination(algebra, ids, share_proofs, begin, end, threshold, coefficient_proofs, ctx);
+    
+    if (status != VERIFIABLE_SECRET_SHARING_INVALID_SHARE)
+        return status;
+    if (end - begin == 1)
+    {
+        if (invalid_index)
+            *invalid_index = begin;
+        return status;
+    }
+
+    // a valid share can't fail the check, so at least one of the halves has an invalid share
+    middle = begin + (end - begin) / 2;
+    status = verify_shares_range(algebra, ids, share_proofs, begin, middle, threshold, coefficient_proofs, ctx, invalid_index);
+    if (status != VERIFIABLE_SECRET_SHARING_SUCCESS)
+        return status;
+    return verify_shares_range(algebra, ids, share_proofs, middle, end, threshold, coefficient_proofs, ctx, invalid_index);
+}
+
+verifiable_secret_sharing_status verifiable_secret_sharing_verify_shares_batch(const elliptic_curve256_algebra_ctx_t *algebra, const uint64_t *ids, const elliptic_curve256_point_t *share_proofs, uint32_t count, 
+    uint8_t threshold, const elliptic_curve256_point_t *coefficient_proofs, uint32_t *invalid_index)
+{
+    BN_CTX *ctx = NULL;
+    verifiable_secret_sharing_status status;
+
+    if (!algebra || !ids || !share_proofs || !count || !threshold || !coefficient_proofs)
+        return VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER;
+    
+    ctx = BN_CTX_new();
+    if (!ctx)
+        return VERIFIABLE_SECRET_SHARING_OUT_OF_MEMORY;
+    status = verify_shares_range(algebra, ids, share_proofs, 0, count, threshold, coefficient_proofs, ctx, invalid_index);
+    BN_CTX_free(ctx);
+    return status;
+}
+
 verifiable_secret_sharing_status verifiable_secret_sharing_verify_commitment(const elliptic_curve256_point_t *proofs, uint8_t proofs_count, const commitments_commitment_t *commitment)
 {
     return from_commitments_status(commitments_verify_commitment((uint8_t*)proofs, proofs_count * sizeof(elliptic_curve256_point_t), commitment));
@@ -1,9 +1,16 @@
 #include "logging/logging_t.h"
 
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 #define MAX_LOG_SIZE 4096
+#define ASYNC_IDLE_SLEEP_NS 1000000
 
 static void default_log_callback(int level, const char* file, int line, const char* func, const char* message, void* userp)
 {
@@ -21,20 +28,234 @@ static void default_log_callback(int level, const char* file, int line, const ch
 static cosigner_log_callback log_callback = default_log_callback;
 static void* log_callback_user_data_pointer = NULL;
 
+int cosigner_log_min_level = 0;
+
+// A bounded multi producer single consumer queue, each slot has a sequence number telling whether it's free for the producer
+// writing position pos (seq == pos) or ready for the consumer reading position pos (seq == pos + 1)
+typedef struct
+{
+    atomic_size_t seq;
+    int level;
+    const char* file;
+    int line;
+    const char* func;
+    char message[MAX_LOG_SIZE];
+} log_slot_t;
+
+typedef struct
+{
+    log_slot_t* slots;
+    size_t mask;
+    atomic_size_t enqueue_pos;
+    size_t dequeue_pos;
+    atomic_size_t dropped;
+    atomic_int stop;
+    pthread_t thread;
+} log_queue_t;
+
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic(log_queue_t*) async_queue = NULL;
+// number of threads that may be writing to async_queue, the queue is freed only when there are none
+static atomic_size_t async_producers = 0;
+
 void cosigner_log_init(cosigner_log_callback cb, void* userp)
 {
     log_callback = cb;
     log_callback_user_data_pointer = userp;
 }
 
+void cosigner_log_set_min_level(int level)
+{
+    __atomic_store_n(&cosigner_log_min_level, level, __ATOMIC_RELAXED);
+}
+
+int cosigner_log_get_min_level(void)
+{
+    return __atomic_load_n(&cosigner_log_min_level, __ATOMIC_RELAXED);
+}
+
+static int log_queue_push(log_queue_t* queue, int level, const char* file, int line, const char* func, const char* message, va_list args)
+{
+    log_slot_t* slot;
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+    while (1)
+    {
+        slot = &queue->slots[pos & queue->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return 0; // full
+        else
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+
+    slot->level = level;
+    slot->file = file;
+    slot->line = line;
+    slot->func = func;
+    slot->message[0] = '\0';
+    if (message != NULL)
+        vsnprintf(slot->message, MAX_LOG_SIZE, message, args);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+static void log_queue_report_dropped(log_queue_t* queue)
+{
+    size_t dropped = atomic_exchange_explicit(&queue->dropped, 0, memory_order_relaxed);
+    cosigner_log_callback cb = log_callback;
+    if (dropped && cb)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%zu log messages were dropped", dropped);
+        cb(COSIGNER_LOG_LEVEL_WARN, __FILE__, __LINE__, __func__, buffer, log_callback_user_data_pointer);
+    }
+}
+
+// returns the number of delivered messages
+static size_t log_queue_deliver(log_queue_t* queue)
+{
+    size_t count = 0;
+    while (1)
+    {
+        log_queue_report_dropped(queue);
+        log_slot_t* slot = &queue->slots[queue->dequeue_pos & queue->mask];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != queue->dequeue_pos + 1)
+            break;
+
+        cosigner_log_callback cb = log_callback;
+        if (cb)
+            cb(slot->level, slot->file, slot->line, slot->func, slot->message, log_callback_user_data_pointer);
+
+        atomic_store_explicit(&slot->seq, queue->dequeue_pos + queue->mask + 1, memory_order_release);
+        queue->dequeue_pos++;
+        count++;
+    }
+    return count;
+}
+
+static void* log_queue_thread(void* arg)
+{
+    log_queue_t* queue = (log_queue_t*)arg;
+    const struct timespec idle = {0, ASYNC_IDLE_SLEEP_NS};
+
+    while (!atomic_load_explicit(&queue->stop, memory_order_acquire))
+    {
+        if (!log_queue_deliver(queue))
+            nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+int cosigner_log_async_start(unsigned int slots_count)
+{
+    log_queue_t* queue;
+
+    if (!slots_count || (slots_count & (slots_count - 1)))
+        return -1;
+
+    pthread_mutex_lock(&async_lock);
+    if (atomic_load(&async_queue))
+    {
+        pthread_mutex_unlock(&async_lock);
+        return -1;
+    }
+
+    queue = (log_queue_t*)calloc(1, sizeof(log_queue_t));
+    if (queue)
+        queue->slots = (log_slot_t*)malloc(sizeof(log_slot_t) * slots_count);
+    if (!queue || !queue->slots)
+    {
+        free(queue);
+        pthread_mutex_unlock(&async_lock);
+        return -1;
+    }
+
+    for (size_t i = 0; i < slots_count; i++)
+        atomic_init(&queue->slots[i].seq, i);
+    queue->mask = slots_count - 1;
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dropped, 0);
+    atomic_init(&queue->stop, 0);
+
+    if (pthread_create(&queue->thread, NULL, log_queue_thread, queue) != 0)
+    {
+        free(queue->slots);
+        free(queue);
+        pthread_mutex_unlock(&async_lock);
+        return -1;
+    }
+
+    atomic_store(&async_queue, queue);
+    pthread_mutex_unlock(&async_lock);
+    return 0;
+}
+
+void cosigner_log_async_stop(void)
+{
+    log_queue_t* queue;
+
+    pthread_mutex_lock(&async_lock);
+    queue = atomic_exchange(&async_queue, NULL);
+    if (!queue)
+    {
+        pthread_mutex_unlock(&async_lock);
+        return;
+    }
+
+    // wait for the threads that already got the queue to finish writing their messages
+    while (atomic_load(&async_producers))
+        sched_yield();
+
+    atomic_store_explicit(&queue->stop, 1, memory_order_release);
+    pthread_join(queue->thread, NULL);
+    log_queue_deliver(queue);
+    pthread_mutex_unlock(&async_lock);
+
+    free(queue->slots);
+    free(queue);
+}
+
 void cosigner_log_msg(int level, const char* file, int line, const char* func, const char* message, ...)
 {
     va_list args;
-    char buffer[MAX_LOG_SIZE] = { '\0' };
+    char buffer[MAX_LOG_SIZE];
+    log_queue_t* queue;
 
     if (log_callback == NULL)
         return;
 
+    // the producers are counted only in async mode, so synchronous logging doesn't write any shared memory
+    queue = atomic_load_explicit(&async_queue, memory_order_acquire);
+    if (queue)
+    {
+        int done = 0;
+        atomic_fetch_add(&async_producers, 1);
+        // the queue may have been stopped and freed before this thread was counted, so it's used only if it's still the active one
+        if (atomic_load(&async_queue) == queue)
+        {
+            va_start(args, message);
+            done = log_queue_push(queue, level, file, line, func, message, args);
+            va_end(args);
+            // errors are never dropped, when the queue is full they are delivered synchronously (possibly before older queued messages)
+            if (!done && level < COSIGNER_LOG_LEVEL_ERROR)
+            {
+                atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+                done = 1;
+            }
+        }
+        atomic_fetch_sub(&async_producers, 1);
+        if (done)
+            return;
+    }
+
+    buffer[0] = '\0';
     if (message != NULL)
     {
         va_start(args, message);
@@ -1,10 +1,15 @@
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 #include <tests/catch.hpp>
 
 #include "cosigner/cmp_ecdsa_offline_signing_service.h"
+#include "cosigner/cmp_ecdsa_preprocessing_pipeline.h"
+#include "cosigner/cmp_mta_serialization.h"
+#include "cosigner/cmp_signing_data_serialization.h"
 #include "cosigner/cosigner_exception.h"
 #include "cosigner/cmp_signature_preprocessed_data.h"
 #include "cosigner/cmp_offline_refresh_service.h"
@@ -81,6 +86,15 @@ class key_refresh_persistency;
 
 class preprocessing_persistency : public cmp_ecdsa_offline_signing_service::preprocessing_persistency
 {
+public:
+    // simulates presigning data stored before the R info was added
+    void clear_r_info(const std::string& key_id, uint64_t index)
+    {
+        std::unique_lock lock(_mutex);
+        _preprocessed_data.at(key_id).at(index).r_info = cmp_signature_r_info();
+    }
+
+private:
     void store_preprocessing_metadata(const std::string& request_id, const preprocessing_metadata& data, bool override) override
     {
         std::unique_lock lock(_mutex);
@@ -100,8 +114,10 @@ class preprocessing_persistency : public cmp_ecdsa_offline_signing_service::prep
 
     void store_preprocessing_data(const std::string& request_id, uint64_t index, const ecdsa_signing_data& data) override
     {
+        byte_vector_t buffer;
+        serialize_ecdsa_signing_data(data, buffer);
         std::unique_lock lock(_mutex);
-        _signing_data[request_id][index] = data;
+        _signing_data[request_id][index] = std::move(buffer);
     }
 
     void load_preprocessing_data(const std::string& request_id, uint64_t index, ecdsa_signing_data& data) const override
@@ -113,7 +129,7 @@ class preprocessing_persistency : public cmp_ecdsa_offline_signing_service::prep
         auto index_it = it->second.find(index);
         if (index_it == it->second.end())
             throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
-        data = index_it->second;
+        deserialize_ecdsa_signing_data(index_it->second.data(), index_it->second.size(), data);
     }
 
     void delete_preprocessing_data(const std::string& request_id) override
@@ -144,7 +160,10 @@ class preprocessing_persistency : public cmp_ecdsa_offline_signing_service::prep
             throw cosigner_exception(cosigner_exception::INVALID_TRANSACTION);
         if (index >= it->second.size())
             throw cosigner_exception(cosigner_exception::INVALID_PRESIGNING_INDEX);
-        it->second[index] = data;
+        // store the data through the persistence format
+        uint8_t buffer[CMP_SIGNATURE_PREPROCESSED_DATA_SERIALIZED_SIZE];
+        serialize_signature_preprocessed_data(data, buffer, sizeof(buffer));
+        deserialize_signature_preprocessed_data(buffer, sizeof(buffer), it->second[index]);
     }
 
     void load_preprocessed_data(const std::string& key_id, uint64_t index, cmp_signature_preprocessed_data& data) override
@@ -167,7 +186,7 @@ class preprocessing_persistency : public cmp_ecdsa_offline_signing_service::prep
 
     mutable std::shared_mutex _mutex;
     std::map<std::string, preprocessing_metadata> _metadata;
-    std::map<std::string, std::map<uint64_t, ecdsa_signing_data>> _signing_data;
+    std::map<std::string, std::map<uint64_t, byte_vector_t>> _signing_data;
     std::map<std::string, std::vector<cmp_signature_preprocessed_data>> _preprocessed_data;
     friend class key_refresh_persistency;
 };
@@ -291,6 +310,20 @@ static void ecdsa_preprocess(std::map<uint64_t, std::unique_ptr<offline_siging_i
         REQUIRE_THROWS_AS(i->second->signing_service.start_ecdsa_signature_preprocessing(TENANT_ID, keyid, request, start, count, total, players_ids, repeat_mta_requests), cosigner_exception);
     }
 
+    // pass all messages through the wire format
+    for (auto i = mta_requests.begin(); i != mta_requests.end(); ++i)
+    {
+        byte_vector_t buffer;
+        serialize_mta_requests(i->second, buffer);
+        REQUIRE_THROWS_AS(cmp_mta_requests_view(buffer.data(), buffer.size() - 1), cosigner_exception);
+        cmp_mta_requests_view view(buffer.data(), buffer.size());
+        REQUIRE(view.size() == count);
+        const_byte_span proof;
+        REQUIRE(view[0].mta_proofs.find(i->second[0].mta_proofs.begin()->first, proof));
+        REQUIRE(proof.to_vector() == i->second[0].mta_proofs.begin()->second);
+        view.to_struct(i->second);
+    }
+
     std::map<uint64_t, cmp_mta_responses> mta_responses;
     for (auto i = services.begin(); i != services.end(); ++i)
     {
@@ -302,6 +335,15 @@ static void ecdsa_preprocess(std::map<uint64_t, std::unique_ptr<offline_siging_i
     }
     mta_requests.clear();
 
+    for (auto i = mta_responses.begin(); i != mta_responses.end(); ++i)
+    {
+        byte_vector_t buffer;
+        serialize_mta_responses(i->second, buffer);
+        cmp_mta_responses_view view(buffer.data(), buffer.size());
+        REQUIRE(memcmp(view.ack(), i->second.ack, sizeof(commitments_sha256_t)) == 0);
+        view.to_struct(i->second);
+    }
+
     std::map<uint64_t, std::vector<cmp_mta_deltas>> deltas;
     for (auto i = services.begin(); i != services.end(); ++i)
     {
@@ -313,6 +355,15 @@ static void ecdsa_preprocess(std::map<uint64_t, std::unique_ptr<offline_siging_i
     }
     mta_responses.clear();
 
+    for (auto i = deltas.begin(); i != deltas.end(); ++i)
+    {
+        byte_vector_t buffer;
+        serialize_mta_deltas(i->second, buffer);
+        cmp_mta_deltas_batch_view view(buffer.data(), buffer.size());
+        REQUIRE(view.size() == count);
+        view.to_struct(i->second);
+    }
+
     std::map<uint64_t, std::vector<elliptic_curve_scalar>> sis;
     for (auto i = services.begin(); i != services.end(); ++i)
     {
@@ -326,6 +377,80 @@ static void ecdsa_preprocess(std::map<uint64_t, std::unique_ptr<offline_siging_i
     }
 }
 
+typedef std::map<uint64_t, std::unique_ptr<cmp_ecdsa_preprocessing_pipeline>> preprocessing_pipelines;
+
+// runs a single request through the pipelines of all players, each round waits for the messages of all players (as if sent over the wire)
+// Catch assertions aren't thread safe, so errors are reported by the thrown exception
+static void ecdsa_preprocess_pipelined(preprocessing_pipelines& pipelines, const std::string& keyid, uint32_t start, uint32_t count, uint32_t total)
+{
+    uuid_t uid;
+    char request[37] = {0};
+    uuid_generate_random(uid);
+    uuid_unparse(uid, request);
+
+    std::set<uint64_t> players_ids;
+    for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+        players_ids.insert(i->first);
+
+    std::map<uint64_t, std::future<std::vector<cmp_mta_request>>> request_futures;
+    for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+        request_futures[i->first] = i->second->start_ecdsa_signature_preprocessing(TENANT_ID, keyid, request, start, count, total, players_ids);
+    std::map<uint64_t, std::vector<cmp_mta_request>> mta_requests;
+    for (auto i = request_futures.begin(); i != request_futures.end(); ++i)
+        mta_requests[i->first] = i->second.get();
+
+    std::map<uint64_t, std::future<cmp_mta_responses>> response_futures;
+    for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+        response_futures[i->first] = i->second->offline_mta_response(request, mta_requests);
+    std::map<uint64_t, cmp_mta_responses> mta_responses;
+    for (auto i = response_futures.begin(); i != response_futures.end(); ++i)
+        mta_responses[i->first] = i->second.get();
+
+    std::map<uint64_t, std::future<std::vector<cmp_mta_deltas>>> delta_futures;
+    for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+        delta_futures[i->first] = i->second->offline_mta_verify(request, mta_responses);
+    std::map<uint64_t, std::vector<cmp_mta_deltas>> deltas;
+    for (auto i = delta_futures.begin(); i != delta_futures.end(); ++i)
+        deltas[i->first] = i->second.get();
+
+    std::map<uint64_t, std::future<std::string>> store_futures;
+    for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+        store_futures[i->first] = i->second->store_presigning_data(request, deltas);
+    for (auto i = store_futures.begin(); i != store_futures.end(); ++i)
+    {
+        if (i->second.get() != keyid)
+            throw std::runtime_error("preprocessing stored for the wrong key");
+    }
+}
+
+// runs count requests of block_size presignatures concurrently through the pipelines, returns the number of failed requests
+static uint32_t ecdsa_preprocess_pipelined_concurrently(preprocessing_pipelines& pipelines, const std::string& keyid, uint32_t count, uint32_t block_size)
+{
+    std::atomic<uint32_t> failures(0);
+    std::vector<std::thread> threads;
+    auto before = Clock::now();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            try
+            {
+                ecdsa_preprocess_pipelined(pipelines, keyid, i * block_size, block_size, count * block_size);
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "pipelined preprocessing failed, error " << e.what() << std::endl;
+                ++failures;
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    auto after = Clock::now();
+    std::cout << "ECDSA pipelined preprocessing took: " << std::chrono::duration_cast<std::chrono::milliseconds>(after - before).count() << " ms" << std::endl;
+    return failures;
+}
+
 static void ecdsa_sign(std::map<uint64_t, std::unique_ptr<offline_siging_info>>& services, cosigner_sign_algorithm type, const std::string& keyid, uint32_t start_index, uint32_t count, const elliptic_curve256_point_t& pubkey, 
     const byte_vector_t& chaincode, const std::vector<std::vector<uint32_t>>& paths, bool positive_r = false)
 {
@@ -594,6 +719,97 @@ TEST_CASE("cmp_offline_ecdsa") {
         ecdsa_sign(services, ECDSA_SECP256K1, keyid, 0, derivation_paths.size(), pubkey, chaincode, derivation_paths);
     }
 
+    SECTION("pipeline") {
+        uuid_t uid;
+        uuid_generate_random(uid);
+        uuid_unparse(uid, keyid);
+        players.clear();
+        players[1];
+        players[2];
+        create_secret(players, ECDSA_SECP256K1, keyid, pubkey);
+
+        std::map<uint64_t, std::unique_ptr<offline_siging_info>> services;
+        for (auto i = players.begin(); i != players.end(); ++i)
+        {
+            auto info = std::make_unique<offline_siging_info>(i->first, i->second);
+            services.emplace(i->first, std::move(info));
+        }
+
+        const uint32_t REQUESTS = 4;
+        preprocessing_pipelines pipelines;
+        for (auto i = services.begin(); i != services.end(); ++i)
+            pipelines.emplace(i->first, std::make_unique<cmp_ecdsa_preprocessing_pipeline>(i->second->signing_service, REQUESTS, 2));
+
+        REQUIRE(ecdsa_preprocess_pipelined_concurrently(pipelines, keyid, REQUESTS, BLOCK_SIZE) == 0);
+        for (auto i = pipelines.begin(); i != pipelines.end(); ++i)
+            REQUIRE(i->second->in_flight() == 0);
+
+        std::vector<uint32_t> derivation_path = {44, 0, 0, 0, 0};
+        std::vector<std::vector<uint32_t>> derivation_paths;
+        for (size_t i = 0; i < 4; i++)
+        {
+            derivation_paths.push_back(derivation_path);
+            ++derivation_path[2];
+        }
+        ecdsa_sign(services, ECDSA_SECP256K1, keyid, BLOCK_SIZE - 2, derivation_paths.size(), pubkey, chaincode, derivation_paths);
+        ecdsa_sign(services, ECDSA_SECP256K1, keyid, (REQUESTS - 1) * BLOCK_SIZE, 1, pubkey, chaincode, {path});
+
+        // the number of requests in flight is bounded
+        cmp_ecdsa_preprocessing_pipeline bounded(services.at(1)->signing_service, 1, 1);
+        std::set<uint64_t> players_ids = {1, 2};
+        auto first = bounded.start_ecdsa_signature_preprocessing(TENANT_ID, keyid, "bounded-1", 0, 1, REQUESTS * BLOCK_SIZE, players_ids);
+        REQUIRE_THROWS_MATCHES(bounded.start_ecdsa_signature_preprocessing(TENANT_ID, keyid, "bounded-2", 1, 1, REQUESTS * BLOCK_SIZE, players_ids), cosigner_exception,
+            Catch::Matchers::Predicate<cosigner_exception>([](const cosigner_exception& e) {return e.error_code() == cosigner_exception::BUSY;}));
+        REQUIRE(first.get().size() == 1);
+        REQUIRE(bounded.in_flight() == 1);
+        bounded.cancel_preprocessing("bounded-1");
+        REQUIRE(bounded.in_flight() == 0);
+
+        // rounds of requests which aren't in flight are rejected
+        REQUIRE_THROWS_MATCHES(bounded.offline_mta_response("bounded-1", std::map<uint64_t, std::vector<cmp_mta_request>>()), cosigner_exception,
+            Catch::Matchers::Predicate<cosigner_exception>([](const cosigner_exception& e) {return e.error_code() == cosigner_exception::INVALID_TRANSACTION;}));
+        REQUIRE_THROWS_MATCHES(bounded.offline_mta_verify("unknown", std::map<uint64_t, cmp_mta_responses>()), cosigner_exception,
+            Catch::Matchers::Predicate<cosigner_exception>([](const cosigner_exception& e) {return e.error_code() == cosigner_exception::INVALID_TRANSACTION;}));
+        REQUIRE(bounded.in_flight() == 0);
+
+        // a failed round ends the request
+        auto second = bounded.start_ecdsa_signature_preprocessing(TENANT_ID, keyid, "bounded-2", 1, 1, REQUESTS * BLOCK_SIZE, players_ids);
+        REQUIRE(second.get().size() == 1);
+        auto response = bounded.offline_mta_response("bounded-2", std::map<uint64_t, std::vector<cmp_mta_request>>());
+        REQUIRE_THROWS_AS(response.get(), cosigner_exception);
+        REQUIRE(bounded.in_flight() == 0);
+        auto wrong_tenant = bounded.start_ecdsa_signature_preprocessing("other tenant", keyid, "bounded-3", 0, 1, REQUESTS * BLOCK_SIZE, players_ids);
+        REQUIRE_THROWS_AS(wrong_tenant.get(), cosigner_exception);
+        REQUIRE(bounded.in_flight() == 0);
+    }
+
+    SECTION("pipeline shared keys") {
+        uuid_t uid;
+        uuid_generate_random(uid);
+        uuid_unparse(uid, keyid);
+        players.clear();
+        players[1];
+        players[2];
+        create_secret(players, ECDSA_SECP256K1, keyid, pubkey);
+
+        // all the requests share the same deserialized public keys, so their first use happens concurrently on the pipelines workers
+        std::map<uint64_t, std::unique_ptr<offline_siging_info>> services;
+        for (auto i = players.begin(); i != players.end(); ++i)
+        {
+            i->second.cache_public_keys(true);
+            auto info = std::make_unique<offline_siging_info>(i->first, i->second);
+            services.emplace(i->first, std::move(info));
+        }
+
+        const uint32_t REQUESTS = 4;
+        preprocessing_pipelines pipelines;
+        for (auto i = services.begin(); i != services.end(); ++i)
+            pipelines.emplace(i->first, std::make_unique<cmp_ecdsa_preprocessing_pipeline>(i->second->signing_service, REQUESTS, 4));
+        REQUIRE(ecdsa_preprocess_pipelined_concurrently(pipelines, keyid, REQUESTS, 1) == 0);
+        ecdsa_sign(services, ECDSA_SECP256K1, keyid, 0, 1, pubkey, chaincode, {path});
+        ecdsa_sign(services, ECDSA_SECP256K1, keyid, REQUESTS - 1, 1, pubkey, chaincode, {path});
+    }
+
     SECTION("secp256r1") {
         uuid_t uid;
         uuid_generate_random(uid);
@@ -649,5 +865,10 @@ TEST_CASE("cmp_offline_ecdsa") {
     
         ecdsa_preprocess(services, keyid, 0, BLOCK_SIZE, BLOCK_SIZE);
         ecdsa_sign(services, ECDSA_STARK, keyid, 0, 1, pubkey, chaincode, {path});
+        ecdsa_sign(services, ECDSA_STARK, keyid, 1, 1, pubkey, chaincode, {path}, true);
+
+        for (auto i = services.begin(); i != services.end(); ++i)
+            i->second->persistency.clear_r_info(keyid, 2);
+        ecdsa_sign(services, ECDSA_STARK, keyid, 2, 1, pubkey, chaincode, {path}, true);
     }
 }
@@ -244,7 +244,7 @@ static void ecdsa_preprocess(std::map<uint64_t, std::unique_ptr<server_info>>& s
 }
 
 static void eddsa_sign(std::map<uint64_t, std::unique_ptr<server_info>>& servers, client_info& client, const std::string& keyid, uint32_t start_index, uint32_t count, const elliptic_curve256_point_t& pubkey, 
-    const byte_vector_t& chaincode, const std::vector<std::vector<uint32_t>>& paths, bool use_keccak = false)
+    const byte_vector_t& chaincode, const std::vector<std::vector<uint32_t>>& paths, bool use_keccak = false, int corrupted_block = -1)
 {
     uuid_t uid;
     char txid[37] = {0};
@@ -337,6 +337,19 @@ static void eddsa_sign(std::map<uint64_t, std::unique_ptr<server_info>>& servers
     std::vector<eddsa_signature> repeat_partial_sigs;
     REQUIRE_THROWS_AS(client.service.eddsa_sign_offline(keyid, txid, data, "", players_str, players_ids, start_index, server_Rs, repeat_partial_sigs), cosigner_exception);
 
+    if (corrupted_block >= 0)
+    {
+        partial_sigs[corrupted_block].s[sizeof(ed25519_scalar_t) - 1] ^= 1;
+        for (auto i = servers.begin(); i != servers.end(); ++i)
+        {
+            std::vector<eddsa_signature> sig;
+            std::set<uint64_t> send_to;
+            bool final_signature;
+            REQUIRE_THROWS_AS(i->second->service.broadcast_si(txid, CLIENT_ID, MPC_PROTOCOL_VERSION, partial_sigs, sig, send_to, final_signature), cosigner_exception);
+        }
+        return;
+    }
+
     std::set<uint64_t> send_to;
     std::map<uint64_t, std::vector<eddsa_signature>> sigs;
     for (auto i = servers.begin(); i != servers.end(); ++i)
@@ -419,6 +432,8 @@ TEST_CASE("asymmetric_eddsa") {
         ecdsa_preprocess(services, client, keyid, 0, 1000, 1000);  
         eddsa_sign(services, client, keyid, 0, 1, pubkey, chaincode, {path});
         eddsa_sign(services, client, keyid, 1, 1, pubkey, chaincode, {path}, true);
+        eddsa_sign(services, client, keyid, 2, 4, pubkey, chaincode, {path, path, {44, 0, 0, 0, 1}, path});
+        eddsa_sign(services, client, keyid, 6, 4, pubkey, chaincode, {path, path, path, path}, false, 2);
     }
 
     SECTION("3/3") {
@@ -441,5 +456,7 @@ TEST_CASE("asymmetric_eddsa") {
         ecdsa_preprocess(services, client, keyid, 0, 1000, 1000);  
         eddsa_sign(services, client, keyid, 0, 1, pubkey, chaincode, {path});
         eddsa_sign(services, client, keyid, 1, 1, pubkey, chaincode, {path}, true);
+        eddsa_sign(services, client, keyid, 2, 3, pubkey, chaincode, {path, {44, 0, 0, 0, 1}, path}, true);
+        eddsa_sign(services, client, keyid, 5, 3, pubkey, chaincode, {path, path, path}, false, 0);
     }
 }
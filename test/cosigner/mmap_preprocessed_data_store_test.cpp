@@ -0,0 +1,231 @@
+#include <chrono>
+#include <iostream>
+#include <tests/catch.hpp>
+
+#include "cosigner/mmap_preprocessed_data_store.h"
+#include "cosigner/cmp_signature_preprocessed_data.h"
+#include "cosigner/cosigner_exception.h"
+
+#include <dirent.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <openssl/rand.h>
+
+using namespace fireblocks::common::cosigner;
+
+using Clock = std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock,
+        std::chrono::steady_clock>::type;
+
+static std::string create_temp_dir()
+{
+    char path[] = "/tmp/mpc_presig_XXXXXX";
+    REQUIRE(mkdtemp(path));
+    return path;
+}
+
+static int remove_entry(const char* path, const struct stat* /*st*/, int /*type*/, struct FTW* /*ftw*/)
+{
+    return remove(path);
+}
+
+static void remove_temp_dir(const std::string& dir)
+{
+    REQUIRE(nftw(dir.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS) == 0);
+}
+
+static std::vector<std::string> list_dir(const std::string& dir)
+{
+    std::vector<std::string> files;
+    DIR* d = opendir(dir.c_str());
+    REQUIRE(d);
+    while (struct dirent* entry = readdir(d))
+    {
+        if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+            files.push_back(dir + "/" + entry->d_name);
+    }
+    closedir(d);
+    return files;
+}
+
+static void random_data(cmp_signature_preprocessed_data& data)
+{
+    RAND_bytes(data.k.data, sizeof(data.k.data));
+    RAND_bytes(data.chi.data, sizeof(data.chi.data));
+    RAND_bytes(data.R.data, sizeof(data.R.data));
+    RAND_bytes(data.r_info.r, sizeof(data.r_info.r));
+    RAND_bytes(data.r_info.positive_r, sizeof(data.r_info.positive_r));
+    data.r_info.v = 1;
+    data.r_info.positive_v = 0;
+    data.r_info.positive_r_multiplier = 3;
+}
+
+static bool equal(const cmp_signature_preprocessed_data& a, const cmp_signature_preprocessed_data& b)
+{
+    return memcmp(a.k.data, b.k.data, sizeof(a.k.data)) == 0 && memcmp(a.chi.data, b.chi.data, sizeof(a.chi.data)) == 0 &&
+        memcmp(a.R.data, b.R.data, sizeof(a.R.data)) == 0 && memcmp(a.r_info.r, b.r_info.r, sizeof(a.r_info.r)) == 0 &&
+        memcmp(a.r_info.positive_r, b.r_info.positive_r, sizeof(a.r_info.positive_r)) == 0 && a.r_info.v == b.r_info.v &&
+        a.r_info.positive_v == b.r_info.positive_v && a.r_info.positive_r_multiplier == b.r_info.positive_r_multiplier;
+}
+
+TEST_CASE("mmap_preprocessed_data_store") {
+    std::string dir = create_temp_dir();
+    const std::string key_id = "8d2b7fc6-5c47-4a3c-9b9e-1a3f2f1d6e0a";
+
+    SECTION("consume once") {
+        mmap_preprocessed_data_store store(dir);
+        store.create_preprocessed_data(key_id, 100);
+        REQUIRE(store.count(key_id) == 0);
+
+        cmp_signature_preprocessed_data data[3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            random_data(data[i]);
+            store.store_preprocessed_data(key_id, i * 40 + 1, data[i]);
+        }
+        REQUIRE(store.count(key_id) == 3);
+
+        cmp_signature_preprocessed_data loaded;
+        store.load_preprocessed_data(key_id, 41, loaded);
+        REQUIRE(equal(loaded, data[1]));
+        REQUIRE(store.count(key_id) == 2);
+        REQUIRE_THROWS_AS(store.load_preprocessed_data(key_id, 41, loaded), cosigner_exception);
+        REQUIRE_THROWS_AS(store.load_preprocessed_data(key_id, 2, loaded), cosigner_exception);
+        REQUIRE_THROWS_AS(store.load_preprocessed_data(key_id, 100, loaded), cosigner_exception);
+        REQUIRE_THROWS_AS(store.store_preprocessed_data(key_id, 100, data[0]), cosigner_exception);
+
+        // override
+        store.store_preprocessed_data(key_id, 1, data[2]);
+        REQUIRE(store.count(key_id) == 2);
+        store.load_preprocessed_data(key_id, 1, loaded);
+        REQUIRE(equal(loaded, data[2]));
+    }
+
+    SECTION("create") {
+        mmap_preprocessed_data_store store(dir);
+        REQUIRE_THROWS_AS(store.create_preprocessed_data(key_id, 0), cosigner_exception);
+        REQUIRE_THROWS_AS(store.count(key_id), cosigner_exception);
+        store.create_preprocessed_data(key_id, 10);
+        REQUIRE_NOTHROW(store.create_preprocessed_data(key_id, 10));
+        REQUIRE_THROWS_AS(store.create_preprocessed_data(key_id, 11), cosigner_exception);
+        REQUIRE(access((dir + "/" + key_id).c_str(), F_OK) != 0); // file name is encoded
+
+        store.delete_preprocessed_data(key_id);
+        REQUIRE_THROWS_AS(store.count(key_id), cosigner_exception);
+        store.create_preprocessed_data(key_id, 11);
+        REQUIRE(store.count(key_id) == 0);
+        REQUIRE_THROWS_AS(mmap_preprocessed_data_store(dir + "/no_such_dir"), cosigner_exception);
+    }
+
+    SECTION("concurrent create") {
+        // every store stands for a different process, as the file lock is held per open file, exactly one of them owns the file
+        const size_t THREADS = 8;
+        std::vector<std::unique_ptr<mmap_preprocessed_data_store>> stores;
+        for (size_t i = 0; i < THREADS; i++)
+            stores.emplace_back(new mmap_preprocessed_data_store(dir));
+        std::atomic<size_t> created(0);
+        std::atomic<size_t> busy(0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREADS; i++)
+        {
+            threads.emplace_back([&, i]()
+            {
+                try
+                {
+                    stores[i]->create_preprocessed_data(key_id, 10);
+                    ++created;
+                }
+                catch (const cosigner_exception& e)
+                {
+                    if (e.error_code() == cosigner_exception::BUSY)
+                        ++busy;
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        REQUIRE(created == 1);
+        REQUIRE(busy == THREADS - 1);
+        // no temporary files are left behind
+        REQUIRE(list_dir(dir).size() == 1);
+
+        stores.clear();
+        mmap_preprocessed_data_store store(dir);
+        REQUIRE(store.count(key_id) == 0);
+    }
+
+    SECTION("reopen") {
+        cmp_signature_preprocessed_data data[2];
+        {
+            mmap_preprocessed_data_store store(dir);
+            store.create_preprocessed_data(key_id, 1000);
+            for (size_t i = 0; i < 2; i++)
+            {
+                random_data(data[i]);
+                store.store_preprocessed_data(key_id, 998 + i, data[i]);
+            }
+            cmp_signature_preprocessed_data loaded;
+            store.load_preprocessed_data(key_id, 998, loaded);
+
+            // the file is locked while in use
+            mmap_preprocessed_data_store other(dir);
+            REQUIRE_THROWS_AS(other.count(key_id), cosigner_exception);
+        }
+
+        mmap_preprocessed_data_store store(dir);
+        REQUIRE_THROWS_AS(store.create_preprocessed_data(key_id, 10), cosigner_exception);
+        REQUIRE(store.count(key_id) == 1);
+        cmp_signature_preprocessed_data loaded;
+        REQUIRE_THROWS_AS(store.load_preprocessed_data(key_id, 998, loaded), cosigner_exception);
+        store.load_preprocessed_data(key_id, 999, loaded);
+        REQUIRE(equal(loaded, data[1]));
+    }
+
+    SECTION("corrupted") {
+        {
+            mmap_preprocessed_data_store store(dir);
+            store.create_preprocessed_data(key_id, 10);
+        }
+        auto files = list_dir(dir);
+        REQUIRE(files.size() == 1);
+        REQUIRE(truncate(files[0].c_str(), 100) == 0);
+        mmap_preprocessed_data_store store(dir);
+        REQUIRE_THROWS_AS(store.count(key_id), cosigner_exception);
+    }
+
+    SECTION("performance") {
+        const size_t COUNT = 1000;
+        mmap_preprocessed_data_store store(dir);
+        auto before = Clock::now();
+        store.create_preprocessed_data(key_id, COUNT);
+        auto after = Clock::now();
+        std::cout << "creating " << COUNT << " slots took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+
+        cmp_signature_preprocessed_data data;
+        random_data(data);
+        before = Clock::now();
+        for (size_t i = 0; i < COUNT; i++)
+            store.store_preprocessed_data(key_id, i, data);
+        after = Clock::now();
+        std::cout << "storing " << COUNT << " records took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+
+        cmp_signature_preprocessed_data loaded;
+        before = Clock::now();
+        for (size_t i = 0; i < COUNT; i++)
+            store.load_preprocessed_data(key_id, i, loaded);
+        after = Clock::now();
+        std::cout << "loading " << COUNT << " records took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+        REQUIRE(equal(loaded, data));
+        REQUIRE(store.count(key_id) == 0);
+    }
+
+    remove_temp_dir(dir);
+}
@@ -0,0 +1,167 @@
+#include <tests/catch.hpp>
+
+#include "cosigner/player_map.h"
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace fireblocks::common::cosigner;
+
+TEST_CASE("player_map") {
+    SECTION("ordering") {
+        player_map<std::string> players;
+        players[5] = "five";
+        players[1] = "one";
+        CHECK(players.emplace(3, "three").second);
+        players[1000000000000ULL] = "big";
+        players[0] = "zero";
+
+        REQUIRE(players.size() == 5);
+        std::vector<uint64_t> ids;
+        for (auto it = players.begin(); it != players.end(); ++it)
+            ids.push_back(it->first);
+        CHECK(ids == std::vector<uint64_t>({0, 1, 3, 5, 1000000000000ULL}));
+        CHECK(players.at(3) == "three");
+        CHECK(players.at(1000000000000ULL) == "big");
+    }
+
+    SECTION("unique keys") {
+        player_map<std::string> players;
+        players[7] = "seven";
+        players[7] = "SEVEN";
+        REQUIRE(players.size() == 1);
+        CHECK(players.at(7) == "SEVEN");
+
+        auto res = players.emplace(7, "other");
+        CHECK_FALSE(res.second);
+        CHECK(res.first->first == 7);
+        CHECK(res.first->second == "SEVEN");
+
+        res = players.insert(std::make_pair(7ULL, std::string("other")));
+        CHECK_FALSE(res.second);
+        CHECK(players.at(7) == "SEVEN");
+        CHECK(players.size() == 1);
+
+        // operator[] on an existing id returns it without inserting
+        std::string& ref = players[7];
+        CHECK(&ref == &players.at(7));
+        CHECK(players.size() == 1);
+
+        player_map<int> init = {{2, 20}, {1, 10}, {2, 30}};
+        REQUIRE(init.size() == 2);
+        CHECK(init.begin()->first == 1);
+        CHECK(init.at(2) == 20);
+    }
+
+    SECTION("missing ids") {
+        player_map<int> players = {{1, 10}, {3, 30}};
+        const player_map<int>& const_players = players;
+
+        CHECK(players.find(2) == players.end());
+        CHECK(players.find(0) == players.end());
+        CHECK(players.find(4) == players.end());
+        CHECK(const_players.find(2) == const_players.end());
+        CHECK(players.count(2) == 0);
+        CHECK(players.count(3) == 1);
+        CHECK_THROWS_AS(players.at(2), std::out_of_range);
+        CHECK_THROWS_AS(const_players.at(4), std::out_of_range);
+        CHECK(players.size() == 2);
+
+        player_map<int> empty;
+        CHECK(empty.find(1) == empty.end());
+        CHECK_THROWS_AS(empty.at(1), std::out_of_range);
+    }
+
+    SECTION("erase") {
+        player_map<int> players = {{1, 10}, {2, 20}, {3, 30}, {4, 40}};
+        CHECK(players.erase(5) == 0);
+        CHECK(players.erase(2) == 1);
+        CHECK(players.erase(2) == 0);
+        REQUIRE(players.size() == 3);
+        CHECK(players.find(2) == players.end());
+
+        auto next = players.erase(players.find(1));
+        REQUIRE(next != players.end());
+        CHECK(next->first == 3);
+        next = players.erase(players.find(4));
+        CHECK(next == players.end());
+        REQUIRE(players.size() == 1);
+        CHECK(players.at(3) == 30);
+
+        players.clear();
+        CHECK(players.empty());
+    }
+
+    SECTION("invalidation") {
+        player_map<int> players;
+        players.reserve(4);
+        players[2] = 20;
+        players[4] = 40;
+
+        // inserting a smaller id shifts the elements, so iterators and references keep their address but now refer to another player
+        int& ref = players.at(2);
+        auto it = players.find(2);
+        players[1] = 10;
+        CHECK(&ref == &players.begin()->second);
+        CHECK(ref == 10);
+        CHECK(it->first == 1);
+        CHECK(&players.at(2) != &ref);
+
+        // once all the entries exist, lookups don't modify the map, so the references stay valid (mta::request relies on this)
+        int* addresses[3] = {&players.at(1), &players.at(2), &players.at(4)};
+        players[2] = 21;
+        players.at(4) = 41;
+        players.emplace(1, 11);
+        players.insert(std::make_pair(4ULL, 42));
+        CHECK(players.find(3) == players.end());
+        CHECK(&players.at(1) == addresses[0]);
+        CHECK(&players.at(2) == addresses[1]);
+        CHECK(&players.at(4) == addresses[2]);
+        CHECK(*addresses[0] == 10);
+        CHECK(*addresses[1] == 21);
+        CHECK(*addresses[2] == 41);
+    }
+
+    SECTION("std::map order") {
+        std::mt19937_64 rng(1234);
+        for (size_t round = 0; round < 50; round++)
+        {
+            player_map<uint64_t> players;
+            std::map<uint64_t, uint64_t> reference;
+            for (size_t i = 0; i < 20; i++)
+            {
+                // use a small range to get duplicates
+                uint64_t id = rng() % 32;
+                uint64_t val = rng();
+                CHECK(players.emplace(id, val).second == reference.emplace(id, val).second);
+                if (rng() % 4 == 0)
+                {
+                    uint64_t erased = rng() % 32;
+                    CHECK(players.erase(erased) == reference.erase(erased));
+                }
+            }
+
+            REQUIRE(players.size() == reference.size());
+            auto it = players.begin();
+            for (auto ref_it = reference.begin(); ref_it != reference.end(); ++ref_it, ++it)
+            {
+                CHECK(it->first == ref_it->first);
+                CHECK(it->second == ref_it->second);
+            }
+            CHECK(it == players.end());
+        }
+    }
+
+    SECTION("equality") {
+        player_map<int> a = {{1, 10}, {2, 20}};
+        player_map<int> b;
+        b[2] = 20;
+        b[1] = 10;
+        CHECK(a == b);
+        b[2] = 21;
+        CHECK(a != b);
+    }
+}
@@ -0,0 +1,219 @@
+#include <tests/catch.hpp>
+
+#include "cosigner/cmp_presignature_inventory.h"
+#include "cosigner/cosigner_exception.h"
+#include "cosigner/platform_service.h"
+
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace fireblocks::common::cosigner;
+
+class clock_platform : public platform_service
+{
+public:
+    clock_platform() : _now(0) {}
+
+    void gen_random(size_t len, uint8_t* random_data) const override {throw std::runtime_error("not implemented");}
+    const std::string get_current_tenantid() const override {return "tenant";}
+    uint64_t get_id_from_keyid(const std::string& key_id) const override {return 1;}
+    void derive_initial_share(const share_derivation_args& derive_from, cosigner_sign_algorithm algorithm, elliptic_curve256_scalar_t* key) const override {throw std::runtime_error("not implemented");}
+    byte_vector_t encrypt_for_player(uint64_t id, const byte_vector_t& data) const override {return data;}
+    byte_vector_t decrypt_message(const byte_vector_t& encrypted_data) const override {return encrypted_data;}
+    bool backup_key(const std::string& key_id, cosigner_sign_algorithm algorithm, const elliptic_curve256_scalar_t& private_key, const cmp_key_metadata& metadata, const auxiliary_keys& aux) override {return true;}
+    void start_signing(const std::string& key_id, const std::string& txid, const signing_data& data, const std::string& metadata_json, const std::set<std::string>& players) override {}
+    void fill_signing_info_from_metadata(const std::string& metadata, std::vector<uint32_t>& flags) const override {}
+    bool is_client_id(uint64_t player_id) const override {return false;}
+    uint64_t now_msec() const override {return _now;}
+
+    uint64_t _now;
+};
+
+TEST_CASE("presignature_inventory") {
+    const std::string key_id = "6b1a1b4e-3a6b-4d0e-8f1e-8f0c3a0f3b7e";
+    clock_platform platform;
+    std::vector<cmp_presignature_inventory::replenishment_request> requests;
+    cmp_presignature_inventory inventory(platform, [&requests](const cmp_presignature_inventory::replenishment_request& request) {requests.push_back(request);});
+
+    cmp_presignature_inventory::config cfg;
+    cfg.capacity = 100;
+    cfg.low_watermark = 10;
+    cfg.min_batch = 5;
+    cfg.max_batch = 40;
+    cfg.lead_time_ms = 1000;
+    cfg.rate_window_ms = 10000;
+
+    SECTION("replenish") {
+        inventory.add_key(key_id, cfg);
+        REQUIRE_THROWS_AS(inventory.add_key(key_id, cfg), cosigner_exception);
+        REQUIRE(requests.size() == 1);
+        REQUIRE(requests[0].key_id == key_id);
+        REQUIRE(requests[0].start_index == 0);
+        REQUIRE(requests[0].count == 10);
+        REQUIRE(requests[0].total_count == 100);
+        REQUIRE(inventory.pending(key_id) == 10);
+
+        uint64_t index;
+        REQUIRE_FALSE(inventory.acquire(key_id, 1, index));
+        REQUIRE(requests.size() == 1); // a single request is in flight
+        REQUIRE_THROWS_AS(inventory.preprocessing_completed(key_id, 0, 11), cosigner_exception);
+        inventory.preprocessing_completed(key_id, 0, 10);
+        REQUIRE(inventory.available(key_id) == 10);
+        REQUIRE(inventory.pending(key_id) == 0);
+        REQUIRE(requests.size() == 1);
+
+        REQUIRE(inventory.acquire(key_id, 2, index));
+        REQUIRE(index == 0);
+        REQUIRE(inventory.available(key_id) == 8);
+        REQUIRE(requests.size() == 2);
+        REQUIRE(requests[1].start_index == 10);
+        REQUIRE(requests[1].count == 5); // low watermark + 1 presignature consumed during the lead time - 8 ready, raised to min_batch
+
+        REQUIRE(inventory.acquire(key_id, 3, index));
+        REQUIRE(index == 2);
+        inventory.release(key_id, 2, 3);
+        REQUIRE(inventory.available(key_id) == 8);
+        REQUIRE_THROWS_AS(inventory.signing_completed(key_id, 2, 3), cosigner_exception);
+        inventory.signing_completed(key_id, 0, 2);
+        REQUIRE_THROWS_AS(inventory.acquire("no_such_key", 1, index), cosigner_exception);
+    }
+
+    SECTION("consumption rate") {
+        cfg.lead_time_ms = cfg.rate_window_ms;
+        std::vector<uint64_t> ready;
+        for (uint64_t i = 0; i < 20; i++)
+            ready.push_back(i);
+        inventory.add_key(key_id, cfg, ready);
+        REQUIRE(requests.empty());
+
+        // 11 presignatures consumed in the window, so 11 more are expected to be consumed during the lead time
+        uint64_t index;
+        for (size_t i = 0; i < 11; i++)
+        {
+            platform._now += 100;
+            REQUIRE(inventory.acquire(key_id, 1, index));
+        }
+        REQUIRE(requests.size() == 1);
+        REQUIRE(requests[0].start_index == 20);
+        REQUIRE(requests[0].count == 12);
+
+        // the old consumption is dropped from the window
+        inventory.preprocessing_completed(key_id, requests[0].start_index, requests[0].count);
+        REQUIRE(inventory.available(key_id) == 21);
+        platform._now += 2 * cfg.rate_window_ms;
+        for (size_t i = 0; i < 12; i++)
+            REQUIRE(inventory.acquire(key_id, 1, index));
+        REQUIRE(requests.size() == 2);
+        REQUIRE(requests[1].start_index == 32);
+        REQUIRE(requests[1].count == 13);
+    }
+
+    SECTION("wrap around") {
+        cfg.capacity = 20;
+        cfg.max_batch = 20;
+        std::vector<uint64_t> ready;
+        for (uint64_t i = 12; i < 20; i++)
+            ready.push_back(i);
+        inventory.add_key(key_id, cfg, ready);
+        REQUIRE(inventory.available(key_id) == 8);
+        REQUIRE(requests.size() == 1);
+        REQUIRE(requests[0].start_index == 0);
+        REQUIRE(requests[0].count == 5);
+        inventory.preprocessing_completed(key_id, 0, 5);
+
+        // the indices must be consecutive, so 6 presignatures can't be taken from [12, 20) + [0, 5)
+        uint64_t index;
+        REQUIRE(inventory.acquire(key_id, 6, index));
+        REQUIRE(index == 12);
+        REQUIRE_FALSE(inventory.acquire(key_id, 6, index));
+        REQUIRE(inventory.acquire(key_id, 2, index));
+        REQUIRE(index == 18);
+        REQUIRE(inventory.acquire(key_id, 5, index));
+        REQUIRE(index == 0);
+    }
+
+    SECTION("callback failure") {
+        bool fail = true;
+        cmp_presignature_inventory failing(platform, [&](const cmp_presignature_inventory::replenishment_request& request)
+        {
+            if (fail)
+                throw std::runtime_error("preprocessing is unavailable");
+            requests.push_back(request);
+        });
+        failing.add_key(key_id, cfg);
+        REQUIRE(failing.pending(key_id) == 0);
+
+        fail = false;
+        uint64_t index;
+        REQUIRE_FALSE(failing.acquire(key_id, 1, index));
+        REQUIRE(requests.size() == 1);
+        failing.preprocessing_failed(key_id, requests[0].start_index, requests[0].count);
+        REQUIRE(failing.pending(key_id) == 0);
+        REQUIRE(requests.size() == 1);
+    }
+
+    SECTION("unknown callback failure") {
+        bool fail = true;
+        cmp_presignature_inventory failing(platform, [&](const cmp_presignature_inventory::replenishment_request& request)
+        {
+            if (fail)
+                throw 1;
+            requests.push_back(request);
+        });
+        REQUIRE_THROWS_AS(failing.add_key(key_id, cfg), int);
+        REQUIRE(failing.pending(key_id) == 0);
+
+        // the slots were returned, so the key is still replenished
+        fail = false;
+        uint64_t index;
+        REQUIRE_FALSE(failing.acquire(key_id, 1, index));
+        REQUIRE(requests.size() == 1);
+        REQUIRE(failing.pending(key_id) == requests[0].count);
+    }
+
+    SECTION("invalid config") {
+        cfg.min_batch = 50;
+        REQUIRE_THROWS_AS(inventory.add_key(key_id, cfg), cosigner_exception);
+        cfg.min_batch = 5;
+        cfg.max_batch = 101;
+        REQUIRE_THROWS_AS(inventory.add_key(key_id, cfg), cosigner_exception);
+        cfg.max_batch = 40;
+        REQUIRE_THROWS_AS(inventory.add_key(key_id, cfg, std::vector<uint64_t>(1, 100)), cosigner_exception);
+        REQUIRE(requests.empty());
+    }
+
+    SECTION("concurrent acquire") {
+        const size_t THREADS = 4;
+        const size_t PER_THREAD = 50;
+        cfg.capacity = THREADS * PER_THREAD;
+        cfg.low_watermark = 0;
+        std::vector<uint64_t> ready;
+        for (uint64_t i = 0; i < cfg.capacity; i++)
+            ready.push_back(i);
+        inventory.add_key(key_id, cfg, ready);
+        REQUIRE(requests.empty());
+
+        std::vector<std::vector<uint64_t>> acquired(THREADS);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREADS; i++)
+        {
+            threads.emplace_back([&, i]()
+            {
+                uint64_t index;
+                for (size_t j = 0; j < PER_THREAD; j++)
+                    if (inventory.acquire(key_id, 1, index))
+                        acquired[i].push_back(index);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        std::set<uint64_t> unique;
+        for (auto& v : acquired)
+            unique.insert(v.begin(), v.end());
+        REQUIRE(unique.size() == cfg.capacity);
+        REQUIRE(inventory.available(key_id) == 0);
+    }
+}
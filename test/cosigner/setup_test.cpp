@@ -1,11 +1,16 @@
 #include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include <tests/catch.hpp>
 
 #include "cosigner/cosigner_exception.h"
 #include "test_common.h"
 #include "crypto/elliptic_curve_algebra/elliptic_curve256_algebra.h"
 #include "cosigner/cmp_key_persistency.h"
+#include "cosigner/cmp_auxiliary_keys_pool.h"
+#include "crypto/commitments/ring_pedersen.h"
+#include "crypto/paillier/paillier.h"
 
 #include <string.h>
 #include <stdarg.h>
@@ -40,6 +45,7 @@ static elliptic_curve256_algebra_ctx_t* create_algebra(cosigner_sign_algorithm t
 
 std::string setup_persistency::dump_key(const std::string& key_id) const
     {
+        std::lock_guard<std::mutex> lg(_lock);
         auto it = _keys.find(key_id);
         if (it == _keys.end())
             throw cosigner_exception(cosigner_exception::BAD_KEY);
@@ -48,11 +54,13 @@ std::string setup_persistency::dump_key(const std::string& key_id) const
 
 bool setup_persistency::key_exist(const std::string& key_id) const
 {
+    std::lock_guard<std::mutex> lg(_lock);
     return _keys.find(key_id) != _keys.end();
 }
 
 void setup_persistency::load_key(const std::string& key_id, cosigner_sign_algorithm& algorithm, elliptic_curve256_scalar_t& private_key) const
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto it = _keys.find(key_id);
     if (it == _keys.end())
         throw cosigner_exception(cosigner_exception::BAD_KEY);
@@ -62,19 +70,63 @@ void setup_persistency::load_key(const std::string& key_id, cosigner_sign_algori
 
 const std::string setup_persistency::get_tenantid_from_keyid(const std::string& key_id) const
 {
+    std::lock_guard<std::mutex> lg(_lock);
     return TENANT_ID;
 }
 
+static lazy_public_key<paillier_public_key> serialized_key(const paillier_public_key_t* key)
+{
+    uint32_t len = 0;
+    paillier_public_key_serialize(key, NULL, 0, &len);
+    byte_vector_t buffer(len);
+    REQUIRE(paillier_public_key_serialize(key, buffer.data(), len, &len));
+    return lazy_public_key<paillier_public_key>::from_serialized(std::move(buffer));
+}
+
+static lazy_public_key<ring_pedersen_public> serialized_key(const ring_pedersen_public_t* key)
+{
+    uint32_t len = 0;
+    ring_pedersen_public_serialize(key, NULL, 0, &len);
+    byte_vector_t buffer(len);
+    REQUIRE(ring_pedersen_public_serialize(key, buffer.data(), len, &len));
+    return lazy_public_key<ring_pedersen_public>::from_serialized(std::move(buffer));
+}
+
 void setup_persistency::load_key_metadata(const std::string& key_id, cmp_key_metadata& metadata, bool full_load) const
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto it = _keys.find(key_id);
     if (it == _keys.end())
         throw cosigner_exception(cosigner_exception::BAD_KEY);
     metadata = it->second.metadata.value();
+    if (!full_load)
+        return;
+
+    if (_cache_public_keys)
+    {
+        auto cached = _cached_players_info.find(key_id);
+        if (cached != _cached_players_info.end())
+        {
+            metadata.players_info = cached->second;
+            return;
+        }
+    }
+
+    // return the players public keys serialized, like a real store does, so they are deserialized only when used
+    for (auto i = metadata.players_info.begin(); i != metadata.players_info.end(); ++i)
+    {
+        if (i->second.paillier)
+            i->second.paillier = serialized_key(i->second.paillier.get());
+        if (i->second.ring_pedersen)
+            i->second.ring_pedersen = serialized_key(i->second.ring_pedersen.get());
+    }
+    if (_cache_public_keys)
+        _cached_players_info[key_id] = metadata.players_info;
 }
 
 void setup_persistency::load_auxiliary_keys(const std::string& key_id, auxiliary_keys& aux) const
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto it = _keys.find(key_id);
     if (it == _keys.end())
         throw cosigner_exception(cosigner_exception::BAD_KEY);
@@ -83,6 +135,7 @@ void setup_persistency::load_auxiliary_keys(const std::string& key_id, auxiliary
 
 void setup_persistency::store_key(const std::string& key_id, cosigner_sign_algorithm algorithm, const elliptic_curve256_scalar_t& private_key, uint64_t ttl)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto& info = _keys[key_id];
     memcpy(info.private_key, private_key, sizeof(elliptic_curve256_scalar_t));
     info.algorithm = algorithm;
@@ -90,15 +143,18 @@ void setup_persistency::store_key(const std::string& key_id, cosigner_sign_algor
 
 void setup_persistency::store_key_metadata(const std::string& key_id, const cmp_key_metadata& metadata, bool allow_override)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto& info = _keys[key_id];
     if (!allow_override && info.metadata)
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
 
     info.metadata = metadata;
+    _cached_players_info.erase(key_id);
 }
 
 void setup_persistency::store_auxiliary_keys(const std::string& key_id, const auxiliary_keys& aux)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     auto& info = _keys[key_id];
     info.aux_keys = aux;
 }
@@ -107,16 +163,19 @@ void setup_persistency::store_keyid_tenant_id(const std::string& key_id, const s
 
 void setup_persistency::store_setup_data(const std::string& key_id, const setup_data& metadata)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     _setup_data[key_id] = metadata;
 }
 
 void setup_persistency::load_setup_data(const std::string& key_id, setup_data& metadata)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     metadata = _setup_data[key_id];
 }
 
 void setup_persistency::store_setup_commitments(const std::string& key_id, const std::map<uint64_t, commitment>& commitments)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     if (_commitments.find(key_id) != _commitments.end())
         throw cosigner_exception(cosigner_exception::INTERNAL_ERROR);
 
@@ -125,15 +184,20 @@ void setup_persistency::store_setup_commitments(const std::string& key_id, const
 
 void setup_persistency::load_setup_commitments(const std::string& key_id, std::map<uint64_t, commitment>& commitments)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     commitments = _commitments[key_id];
 }
 
 void setup_persistency::delete_temporary_key_data(const std::string& key_id, bool delete_key)
 {
+    std::lock_guard<std::mutex> lg(_lock);
     _setup_data.erase(key_id);
     _commitments.erase(key_id);
     if (delete_key)
+    {
         _keys.erase(key_id);
+        _cached_players_info.erase(key_id);
+    }
 }
 
 class platform : public platform_service
@@ -163,12 +227,12 @@ private:
 
 struct setup_info
 {
-    setup_info(uint64_t id, setup_persistency& persistency) : platform_service(id), setup_service(platform_service, persistency) {}
+    setup_info(uint64_t id, setup_persistency& persistency, cmp_auxiliary_keys_pool* aux_keys_pool = NULL) : platform_service(id), setup_service(platform_service, persistency, aux_keys_pool) {}
     platform platform_service;
     cmp_setup_service setup_service;
 };
 
-void create_secret(players_setup_info& players, cosigner_sign_algorithm type, const std::string& keyid, elliptic_curve256_point_t& pubkey)
+void create_secret(players_setup_info& players, cosigner_sign_algorithm type, const std::string& keyid, elliptic_curve256_point_t& pubkey, cmp_auxiliary_keys_pool* aux_keys_pool)
 {
     std::unique_ptr<elliptic_curve256_algebra_ctx_t, void(*)(elliptic_curve256_algebra_ctx_t*)> algebra(create_algebra(type), elliptic_curve256_algebra_ctx_free);
     const size_t PUBKEY_SIZE = algebra->point_size(algebra.get());
@@ -180,7 +244,7 @@ void create_secret(players_setup_info& players, cosigner_sign_algorithm type, co
     std::map<uint64_t, std::unique_ptr<setup_info>> services;
     for (auto i = players.begin(); i != players.end(); ++i)
     {
-        services.emplace(i->first, std::make_unique<setup_info>(i->first, i->second));
+        services.emplace(i->first, std::make_unique<setup_info>(i->first, i->second, aux_keys_pool));
         players_ids.push_back(i->first);
     }
 
@@ -334,6 +398,250 @@ void add_user(players_setup_info& old_players, players_setup_info& new_players,
     }
 }
 
+class aux_keys_pool_persistency : public cmp_auxiliary_keys_pool::pool_persistency
+{
+public:
+    void load_pool_keys(std::map<uint64_t, auxiliary_keys>& keys) override {keys = _keys;}
+    void store_pool_keys(uint64_t id, const auxiliary_keys& aux) override
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        _keys[id] = aux;
+    }
+    void delete_pool_keys(uint64_t id) override
+    {
+        std::lock_guard<std::mutex> lg(_lock);
+        _keys.erase(id);
+    }
+
+    std::mutex _lock;
+    std::map<uint64_t, auxiliary_keys> _keys;
+};
+
+TEST_CASE("aux_keys_pool") {
+    SECTION("persistency") {
+        aux_keys_pool_persistency persistency;
+        std::shared_ptr<struct paillier_private_key> first;
+        {
+            cmp_auxiliary_keys_pool pool(3, 0, &persistency);
+            REQUIRE(pool.size() == 0);
+            pool.fill();
+            REQUIRE(pool.size() == 3);
+            REQUIRE(persistency._keys.size() == 3);
+
+            auxiliary_keys aux = pool.get();
+            REQUIRE(aux.paillier);
+            REQUIRE(aux.ring_pedersen);
+            REQUIRE(pool.size() == 2);
+            REQUIRE(persistency._keys.size() == 2);
+            first = aux.paillier;
+        }
+
+        cmp_auxiliary_keys_pool pool(3, 0, &persistency);
+        REQUIRE(pool.size() == 2);
+        pool.fill();
+        REQUIRE(pool.size() == 3);
+        REQUIRE(persistency._keys.size() == 3);
+        for (size_t i = 0; i < 3; i++)
+        {
+            auxiliary_keys aux = pool.get();
+            REQUIRE(aux.paillier != first);
+        }
+        REQUIRE(persistency._keys.empty());
+
+        // empty pool generates the keys inline
+        auxiliary_keys aux = pool.get();
+        REQUIRE(aux.paillier);
+        REQUIRE(aux.ring_pedersen);
+    }
+
+    SECTION("background") {
+        cmp_auxiliary_keys_pool pool(1);
+        auto start = std::chrono::steady_clock::now();
+        while (pool.size() == 0 && std::chrono::steady_clock::now() - start < std::chrono::minutes(5))
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(pool.size() == 1);
+        std::cout << "auxiliary keys generation took: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+    }
+
+    SECTION("setup") {
+        cmp_auxiliary_keys_pool pool(2, 0);
+        pool.fill();
+        uuid_t uid;
+        char keyid[37] = {0};
+        uuid_generate_random(uid);
+        uuid_unparse(uid, keyid);
+        elliptic_curve256_point_t pubkey;
+        players_setup_info players;
+        players[1];
+        players[2];
+        auto before = std::chrono::steady_clock::now();
+        create_secret(players, ECDSA_SECP256K1, keyid, pubkey, &pool);
+        std::cout << "setup using auxiliary keys pool took: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before).count() << " ms" << std::endl;
+        REQUIRE(pool.size() == 0);
+    }
+}
+
+TEST_CASE("lazy_public_key") {
+    paillier_public_key_t* pub;
+    paillier_private_key_t* priv;
+    REQUIRE(paillier_generate_key_pair(2048, &pub, &priv) == PAILLIER_SUCCESS);
+    std::shared_ptr<paillier_public_key_t> key(pub, paillier_free_public_key);
+    paillier_free_private_key(priv);
+
+    lazy_public_key<paillier_public_key> empty;
+    REQUIRE_FALSE(empty);
+    REQUIRE(empty.get() == NULL);
+
+    lazy_public_key<paillier_public_key> direct(key);
+    REQUIRE(direct.get() == key.get());
+
+    auto lazy = serialized_key(key.get());
+    auto copy = lazy;
+    REQUIRE(lazy);
+    REQUIRE(lazy.get() != key.get());
+    REQUIRE(copy.get() == lazy.get()); // copies share the deserialized key
+    uint8_t n1[256], n2[256];
+    REQUIRE(paillier_public_key_n(lazy.get(), n1, sizeof(n1), NULL) == PAILLIER_SUCCESS);
+    REQUIRE(paillier_public_key_n(key.get(), n2, sizeof(n2), NULL) == PAILLIER_SUCCESS);
+    REQUIRE(memcmp(n1, n2, sizeof(n1)) == 0);
+
+    // concurrent first access from copies deserializes the key once
+    auto shared = serialized_key(key.get());
+    std::vector<lazy_public_key<paillier_public_key>> copies(8, shared);
+    std::vector<paillier_public_key_t*> loaded(copies.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < copies.size(); i++)
+        threads.emplace_back([&, i]() {loaded[i] = copies[i].get();});
+    for (auto& t : threads)
+        t.join();
+    for (size_t i = 0; i < copies.size(); i++)
+        REQUIRE(loaded[i] == shared.get());
+
+    auto invalid = lazy_public_key<ring_pedersen_public>::from_serialized(byte_vector_t(10, 0));
+    REQUIRE_THROWS_AS(invalid.get(), cosigner_exception);
+    REQUIRE_THROWS_AS(invalid.get(), cosigner_exception);
+}
+
+TEST_CASE("setup_batch") {
+    const size_t BATCH_SIZE = 2;
+    // two auxiliary keys per key for the batch and four more for the failed batches
+    cmp_auxiliary_keys_pool pool(BATCH_SIZE * 2 + 4, 0);
+    pool.fill();
+    players_setup_info players;
+    players[1];
+    players[2];
+
+    std::vector<uint64_t> players_ids;
+    std::map<uint64_t, std::unique_ptr<setup_info>> services;
+    for (auto i = players.begin(); i != players.end(); ++i)
+    {
+        services.emplace(i->first, std::make_unique<setup_info>(i->first, i->second, &pool));
+        players_ids.push_back(i->first);
+    }
+
+    std::vector<std::string> key_ids;
+    for (size_t i = 0; i < BATCH_SIZE; i++)
+    {
+        uuid_t uid;
+        char keyid[37] = {0};
+        uuid_generate_random(uid);
+        uuid_unparse(uid, keyid);
+        key_ids.push_back(keyid);
+    }
+
+    auto before = std::chrono::steady_clock::now();
+    std::map<std::string, std::map<uint64_t, commitment>> commitments;
+    for (auto i = services.begin(); i != services.end(); ++i)
+    {
+        std::map<std::string, commitment> commits;
+        REQUIRE(i->second->setup_service.generate_setup_commitments_batch(key_ids, TENANT_ID, ECDSA_SECP256K1, players_ids, players_ids.size(), 0, commits).empty());
+        REQUIRE(commits.size() == BATCH_SIZE);
+        for (auto j = commits.begin(); j != commits.end(); ++j)
+            commitments[j->first][i->first] = j->second;
+    }
+
+    std::map<std::string, std::map<uint64_t, setup_decommitment>> decommitments;
+    for (auto i = services.begin(); i != services.end(); ++i)
+    {
+        std::map<std::string, setup_decommitment> decommits;
+        REQUIRE(i->second->setup_service.store_setup_commitments_batch(commitments, decommits).empty());
+        for (auto j = decommits.begin(); j != decommits.end(); ++j)
+            decommitments[j->first][i->first] = j->second;
+    }
+
+    std::map<std::string, std::map<uint64_t, setup_zk_proofs>> proofs;
+    for (auto i = services.begin(); i != services.end(); ++i)
+    {
+        std::map<std::string, setup_zk_proofs> player_proofs;
+        REQUIRE(i->second->setup_service.generate_setup_proofs_batch(decommitments, player_proofs).empty());
+        for (auto j = player_proofs.begin(); j != player_proofs.end(); ++j)
+            proofs[j->first][i->first] = j->second;
+    }
+
+    std::map<std::string, std::map<uint64_t, std::map<uint64_t, byte_vector_t>>> paillier_large_factor_proofs;
+    for (auto i = services.begin(); i != services.end(); ++i)
+    {
+        std::map<std::string, std::map<uint64_t, byte_vector_t>> player_proofs;
+        REQUIRE(i->second->setup_service.verify_setup_proofs_batch(proofs, player_proofs).empty());
+        for (auto j = player_proofs.begin(); j != player_proofs.end(); ++j)
+            paillier_large_factor_proofs[j->first][i->first] = j->second;
+    }
+
+    // a key that fails in the last round doesn't affect the keys that were created
+    const std::string unknown_key_id = "5d1c9e3a-7b2f-4e8d-a6c1-0f9b8e7d6c5a";
+    paillier_large_factor_proofs[unknown_key_id];
+
+    std::map<std::string, std::string> public_keys;
+    for (auto i = services.begin(); i != services.end(); ++i)
+    {
+        std::map<std::string, std::string> player_public_keys;
+        std::map<std::string, cosigner_sign_algorithm> algorithms;
+        REQUIRE(i->second->setup_service.create_secret_batch(paillier_large_factor_proofs, player_public_keys, algorithms) == std::vector<std::string>({unknown_key_id}));
+        REQUIRE(algorithms.size() == BATCH_SIZE);
+        for (auto j = algorithms.begin(); j != algorithms.end(); ++j)
+            REQUIRE(j->second == ECDSA_SECP256K1);
+        REQUIRE(player_public_keys.size() == BATCH_SIZE);
+        for (auto j = key_ids.begin(); j != key_ids.end(); ++j)
+            REQUIRE(static_cast<const cmp_setup_service::setup_key_persistency&>(players.at(i->first)).key_exist(*j));
+        if (public_keys.empty())
+            public_keys = player_public_keys;
+        else
+            REQUIRE(public_keys == player_public_keys);
+    }
+    std::cout << "batched setup of " << BATCH_SIZE << " keys took: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before).count() << " ms" << std::endl;
+    REQUIRE(public_keys.begin()->second != public_keys.rbegin()->second);
+    REQUIRE(pool.size() == 4);
+
+    // the keys of a batch fail independently, an already existing key fails and is left untouched
+    std::vector<std::string> bad_batch = {"ee2a1a6c-1d1a-4bde-8a9b-3c4f4e5d6a7b", key_ids[0]};
+    std::map<std::string, commitment> commits;
+    REQUIRE(services.begin()->second->setup_service.generate_setup_commitments_batch(bad_batch, TENANT_ID, ECDSA_SECP256K1, players_ids, players_ids.size(), 0, commits) == std::vector<std::string>({key_ids[0]}));
+    REQUIRE(commits.size() == 1);
+    REQUIRE(commits.count(bad_batch[0]));
+    const cmp_setup_service::setup_key_persistency& persistency = players.begin()->second;
+    REQUIRE(persistency.key_exist(bad_batch[0]));
+    REQUIRE(persistency.key_exist(key_ids[0]));
+    REQUIRE_THROWS_AS(services.begin()->second->setup_service.generate_setup_commitments_batch({key_ids[1], key_ids[1]}, TENANT_ID, ECDSA_SECP256K1, players_ids, players_ids.size(), 0, commits), cosigner_exception);
+
+    // so do they in the later rounds, only the outputs of the keys that succeeded are returned
+    std::vector<std::string> failed_batch = {"0b6c2e1d-8f4a-4c3e-9d2b-7a1e5f6c8d9e", "f3a9d8c7-2b1e-4f6a-8c5d-9e0b1a2c3d4f"};
+    commits.clear();
+    REQUIRE(services.begin()->second->setup_service.generate_setup_commitments_batch(failed_batch, TENANT_ID, ECDSA_SECP256K1, players_ids, players_ids.size(), 0, commits).empty());
+    std::map<std::string, std::map<uint64_t, commitment>> failed_commitments;
+    for (auto i = commits.begin(); i != commits.end(); ++i)
+        failed_commitments[i->first][players.begin()->first] = i->second;
+    // the second player commits only to the second key, so the first one is missing a commitment
+    commits.clear();
+    REQUIRE(services.rbegin()->second->setup_service.generate_setup_commitments_batch({failed_batch[1]}, TENANT_ID, ECDSA_SECP256K1, players_ids, players_ids.size(), 0, commits).empty());
+    failed_commitments[failed_batch[1]][players.rbegin()->first] = commits.at(failed_batch[1]);
+    std::map<std::string, setup_decommitment> decommits;
+    REQUIRE(services.begin()->second->setup_service.store_setup_commitments_batch(failed_commitments, decommits) == std::vector<std::string>({failed_batch[0]}));
+    REQUIRE(decommits.size() == 1);
+    REQUIRE(decommits.count(failed_batch[1]));
+    REQUIRE(persistency.key_exist(failed_batch[0]));
+    REQUIRE(persistency.key_exist(failed_batch[1]));
+}
+
 #if 0
 TEST_CASE("setup") {
     SECTION("secp256k1") {
@@ -3,6 +3,7 @@
 #include <uuid/uuid.h>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 #include "cosigner/cmp_setup_service.h"
@@ -13,6 +14,9 @@ class setup_persistency : public fireblocks::common::cosigner::cmp_setup_service
 public:
     // debug only
     std::string dump_key(const std::string& key_id) const;
+    // when set, the players public keys are deserialized once and shared by all the loads of the key metadata, like a store with a keys
+    // cache does, otherwise every load returns its own copy of the keys
+    void cache_public_keys(bool cache) {std::lock_guard<std::mutex> lg(_lock); _cache_public_keys = cache; _cached_players_info.clear();}
 private:
     bool key_exist(const std::string& key_id) const override;
     void load_key(const std::string& key_id, cosigner_sign_algorithm& algorithm, elliptic_curve256_scalar_t& private_key) const override;
@@ -40,6 +44,9 @@ private:
     std::map<std::string, key_info> _keys;
     std::map<std::string, fireblocks::common::cosigner::setup_data> _setup_data;
     std::map<std::string, std::map<uint64_t, fireblocks::common::cosigner::commitment>> _commitments;
+    bool _cache_public_keys = false;
+    mutable std::map<std::string, std::map<uint64_t, fireblocks::common::cosigner::cmp_player_info>> _cached_players_info;
+    mutable std::mutex _lock;
 };
 
 typedef std::map<uint64_t, setup_persistency> players_setup_info;
@@ -71,5 +78,5 @@ inline std::string HexStr(const T& vch)
     return HexStr(vch.begin(), vch.end());
 }
 
-void create_secret(players_setup_info& players, cosigner_sign_algorithm type, const std::string& keyid, elliptic_curve256_point_t& pubkey);
+void create_secret(players_setup_info& players, cosigner_sign_algorithm type, const std::string& keyid, elliptic_curve256_point_t& pubkey, fireblocks::common::cosigner::cmp_auxiliary_keys_pool* aux_keys_pool = NULL);
 void add_user(players_setup_info& old_players, players_setup_info& new_players, cosigner_sign_algorithm type, const std::string& old_keyid, const std::string& new_keyid, const elliptic_curve256_point_t& pubkey);
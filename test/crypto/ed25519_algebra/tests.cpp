@@ -392,6 +392,70 @@ TEST_CASE( "ed25519_algebra_point_mul", "zkp") {
     ed25519_algebra_ctx_free(ctx);
 }
 
+TEST_CASE( "ed25519_algebra_multi_point_mul_vartime", "zkp") {
+    ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
+
+    SECTION("basic") {
+        REQUIRE(ctx);
+        ed25519_point_t points[3], expected, tmp, res;
+        ed25519_le_scalar_t exps[3];
+        ed25519_scalar_t exp;
+        ed25519_le_scalar_t generator_exp;
+        for (size_t i = 0; i < 3; i++)
+        {
+            REQUIRE(ed25519_algebra_rand(ctx, &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(ed25519_algebra_generator_mul(ctx, &points[i], &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(ed25519_algebra_rand(ctx, &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(ed25519_algebra_be_to_le(&exps[i], &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(ed25519_algebra_point_mul(ctx, &tmp, &points[i], &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            if (i == 0)
+                memcpy(expected, tmp, sizeof(ed25519_point_t));
+            else
+                REQUIRE(ed25519_algebra_add_points(ctx, &expected, &expected, &tmp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        }
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, NULL, points, exps, 3) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(expected, res, sizeof(res)) == 0);
+
+        REQUIRE(ed25519_algebra_rand(ctx, &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_generator_mul(ctx, &tmp, &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_add_points(ctx, &expected, &expected, &tmp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_be_to_le(&generator_exp, &exp) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, &generator_exp, points, exps, 3) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(expected, res, sizeof(res)) == 0);
+
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, &generator_exp, NULL, NULL, 0) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(tmp, res, sizeof(res)) == 0);
+    }
+
+    SECTION("zero") {
+        REQUIRE(ctx);
+        const ed25519_point_t IDENTITY = {1};
+        ed25519_point_t point, res;
+        ed25519_le_scalar_t exp = {0};
+        uint8_t a = 7;
+        REQUIRE(ed25519_algebra_generator_mul_data(ctx, &a, sizeof(a), &point) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, &exp, &point, &exp, 1) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(IDENTITY, res, sizeof(res)) == 0);
+    }
+
+    SECTION("invalid param") {
+        REQUIRE(ctx);
+        ed25519_point_t point, res;
+        ed25519_le_scalar_t exp = {0};
+        uint8_t a = 7;
+        REQUIRE(ed25519_algebra_generator_mul_data(ctx, &a, sizeof(a), &point) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, NULL, NULL, &exp, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, NULL, NULL, &point, &exp, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        exp[31] = 0x80;
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, NULL, &point, &exp, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR);
+        exp[31] = 0;
+        ed25519_point_t invalid = {2}; // not on the curve
+        REQUIRE(ed25519_algebra_multi_point_mul_vartime(ctx, &res, NULL, &invalid, &exp, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_POINT);
+    }
+
+    ed25519_algebra_ctx_free(ctx);
+}
+
 TEST_CASE( "ed25519_algebra_generator_mul", "zkp") {
     ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
 
@@ -449,6 +513,79 @@ TEST_CASE( "ed25519_algebra_generator_mul", "zkp") {
     ed25519_algebra_ctx_free(ctx);
 }
 
+TEST_CASE( "ed25519_algebra_generator_mul_batch", "zkp") {
+    elliptic_curve256_algebra_ctx_t* ed25519 = elliptic_curve256_new_ed25519_algebra();
+    REQUIRE(ed25519);
+    const uint32_t COUNT = 9;
+    elliptic_curve256_scalar_t exps[COUNT];
+    elliptic_curve256_point_t points[COUNT];
+    for (uint32_t i = 0; i < COUNT; i++)
+        REQUIRE(ed25519->rand(ed25519, &exps[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+    memset(exps[2], 0, sizeof(elliptic_curve256_scalar_t)); // infinity
+    memset(exps[5], 0xff, sizeof(elliptic_curve256_scalar_t)); // larger than the order
+
+    REQUIRE(ed25519->generator_mul_batch(ed25519, points, exps, COUNT) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        elliptic_curve256_point_t expected;
+        REQUIRE(ed25519->generator_mul(ed25519, &expected, &exps[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(points[i], expected, sizeof(elliptic_curve256_point_t)) == 0);
+    }
+    REQUIRE(memcmp(points[2], ed25519->infinity_point(ed25519), sizeof(elliptic_curve256_point_t)) == 0);
+
+    REQUIRE(ed25519->generator_mul_batch(ed25519, points, exps, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+    REQUIRE(ed25519->generator_mul_batch(ed25519, NULL, exps, COUNT) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+    REQUIRE(ed25519->generator_mul_batch(ed25519, points, NULL, COUNT) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+    elliptic_curve256_algebra_ctx_free(ed25519);
+}
+
+TEST_CASE( "ed25519_algebra_batch_inverse", "zkp") {
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_ed25519_algebra()};
+    const uint32_t COUNT = 9;
+
+    for (auto algebra : algebras)
+    {
+        REQUIRE(algebra);
+        elliptic_curve256_scalar_t vals[COUNT];
+        elliptic_curve256_scalar_t inverses[COUNT];
+        for (uint32_t i = 0; i < COUNT; i++)
+            REQUIRE(algebra->rand(algebra, &vals[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        memset(vals[4], 0, sizeof(elliptic_curve256_scalar_t));
+        vals[4][sizeof(elliptic_curve256_scalar_t) - 1] = 1;
+
+        for (uint8_t constant_time = 0; constant_time < 2; constant_time++)
+        {
+            REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, constant_time) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            for (uint32_t i = 0; i < COUNT; i++)
+            {
+                elliptic_curve256_scalar_t expected;
+                REQUIRE(algebra->inverse(algebra, &expected, &vals[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+                REQUIRE(memcmp(inverses[i], expected, sizeof(elliptic_curve256_scalar_t)) == 0);
+            }
+        }
+
+        // in place
+        memcpy(inverses, vals, sizeof(vals));
+        REQUIRE(algebra->batch_inverse(algebra, inverses, inverses, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            elliptic_curve256_scalar_t one;
+            REQUIRE(algebra->mul_scalars(algebra, &one, vals[i], sizeof(elliptic_curve256_scalar_t), inverses[i], sizeof(elliptic_curve256_scalar_t)) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            for (size_t j = 0; j < sizeof(elliptic_curve256_scalar_t) - 1; j++)
+                REQUIRE(one[j] == 0);
+            REQUIRE(one[sizeof(elliptic_curve256_scalar_t) - 1] == 1);
+        }
+
+        memset(vals[7], 0, sizeof(elliptic_curve256_scalar_t));
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, 0, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->batch_inverse(algebra, NULL, vals, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, NULL, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        elliptic_curve256_algebra_ctx_free(algebra);
+    }
+}
+
 TEST_CASE( "ed25519_algebra_add_scalars", "zkp") {
     ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
 
@@ -547,6 +684,94 @@ TEST_CASE( "ed25519_algebra_add_scalars", "zkp") {
     ed25519_algebra_ctx_free(ctx);
 }
 
+TEST_CASE( "ed25519_algebra_scalars_match_bn", "zkp") {
+    ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
+    REQUIRE(ctx);
+    BN_CTX* bn_ctx = BN_CTX_new();
+    BIGNUM* bn_a = BN_new();
+    BIGNUM* bn_b = BN_new();
+    BIGNUM* bn_c = BN_new();
+    BIGNUM* bn_res = BN_new();
+    BIGNUM* bn_field = BN_bin2bn(ED25519_FIELD, ED25519_FIELD_SIZE, NULL);
+    REQUIRE(bn_field);
+
+    const uint32_t sizes[] = {1, 20, 31, 32, 33, 64, 65, 100};
+    for (size_t iter = 0; iter < 200; iter++)
+    {
+        uint8_t a[100];
+        uint8_t b[100];
+        uint32_t a_len = sizes[iter % 8];
+        uint32_t b_len = sizes[(iter / 8) % 8];
+        REQUIRE(RAND_bytes(a, sizeof(a)));
+        REQUIRE(RAND_bytes(b, sizeof(b)));
+        if (iter % 5 == 0)
+            memset(a, 0xff, a_len);
+        else if (iter % 5 == 1 && a_len >= ED25519_FIELD_SIZE)
+        {
+            // l - 1
+            memset(a, 0, a_len);
+            memcpy(a + a_len - ED25519_FIELD_SIZE, ED25519_FIELD, ED25519_FIELD_SIZE);
+            a[a_len - 1]--;
+        }
+        REQUIRE(BN_bin2bn(a, a_len, bn_a));
+        REQUIRE(BN_bin2bn(b, b_len, bn_b));
+
+        ed25519_scalar_t res;
+        REQUIRE(ed25519_algebra_add_scalars(ctx, &res, a, a_len, b, b_len) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(BN_mod_add(bn_c, bn_a, bn_b, bn_field, bn_ctx));
+        REQUIRE(BN_bin2bn(res, sizeof(res), bn_res));
+        REQUIRE(BN_cmp(bn_c, bn_res) == 0);
+
+        REQUIRE(ed25519_algebra_sub_scalars(ctx, &res, a, a_len, b, b_len) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(BN_mod_sub(bn_c, bn_a, bn_b, bn_field, bn_ctx));
+        REQUIRE(BN_bin2bn(res, sizeof(res), bn_res));
+        REQUIRE(BN_cmp(bn_c, bn_res) == 0);
+
+        REQUIRE(ed25519_algebra_mul_scalars(ctx, &res, a, a_len, b, b_len) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(BN_mod_mul(bn_c, bn_a, bn_b, bn_field, bn_ctx));
+        REQUIRE(BN_bin2bn(res, sizeof(res), bn_res));
+        REQUIRE(BN_cmp(bn_c, bn_res) == 0);
+
+        if (a_len == ED25519_FIELD_SIZE)
+        {
+            REQUIRE(ed25519_algebra_inverse(ctx, &res, (const ed25519_scalar_t*)a) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(BN_mod_inverse(bn_c, bn_a, bn_field, bn_ctx));
+            REQUIRE(BN_bin2bn(res, sizeof(res), bn_res));
+            REQUIRE(BN_cmp(bn_c, bn_res) == 0);
+
+            // a * b + c with unreduced little endian inputs
+            ed25519_le_scalar_t le_a, le_b, le_c, le_res;
+            memcpy(le_a, a, sizeof(le_a));
+            memcpy(le_b, b, sizeof(le_b));
+            memcpy(le_c, b + 50, sizeof(le_c));
+            REQUIRE(ed25519_algebra_mul_add(ctx, &le_res, &le_a, &le_b, &le_c) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(BN_lebin2bn(le_a, sizeof(le_a), bn_a));
+            REQUIRE(BN_lebin2bn(le_b, sizeof(le_b), bn_b));
+            REQUIRE(BN_lebin2bn(le_c, sizeof(le_c), bn_c));
+            REQUIRE(BN_mul(bn_a, bn_a, bn_b, bn_ctx));
+            REQUIRE(BN_add(bn_a, bn_a, bn_c));
+            REQUIRE(BN_nnmod(bn_a, bn_a, bn_field, bn_ctx));
+            REQUIRE(BN_lebin2bn(le_res, sizeof(le_res), bn_res));
+            REQUIRE(BN_cmp(bn_a, bn_res) == 0);
+        }
+    }
+
+    ed25519_scalar_t zero = {0};
+    ed25519_scalar_t res;
+    REQUIRE(ed25519_algebra_inverse(ctx, &res, &zero) != ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+    ed25519_le_scalar_t le_field;
+    ed25519_algebra_be_to_le(&le_field, (const ed25519_scalar_t*)ED25519_FIELD);
+    REQUIRE(ed25519_algebra_add_le_scalars(ctx, &le_field, &le_field, (const ed25519_le_scalar_t*)zero) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+
+    BN_free(bn_field);
+    BN_free(bn_res);
+    BN_free(bn_c);
+    BN_free(bn_b);
+    BN_free(bn_a);
+    BN_CTX_free(bn_ctx);
+    ed25519_algebra_ctx_free(ctx);
+}
+
 TEST_CASE( "sign", "ed25519") {
     ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
 
@@ -630,4 +855,51 @@ TEST_CASE( "calc_hram", "ed25519") {
         REQUIRE(ed25519_calc_hram(ctx, &hram, &R, &public_key, NULL, sizeof(message), 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
         REQUIRE(ed25519_calc_hram(ctx, &hram, &R, &public_key, message, 0, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
     }
-}
\ No newline at end of file
+}
+TEST_CASE( "calc_hram_batch", "ed25519") {
+    ed25519_algebra_ctx_t* ctx = ed25519_algebra_ctx_new();
+    const uint32_t COUNT = 13;
+    ed25519_point_t R[COUNT], public_keys[COUNT];
+    uint8_t data[COUNT][300];
+    const uint8_t* messages[COUNT];
+    uint32_t sizes[COUNT];
+    RAND_bytes((uint8_t*)R, sizeof(R));
+    RAND_bytes((uint8_t*)public_keys, sizeof(public_keys));
+    RAND_bytes((uint8_t*)data, sizeof(data));
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        messages[i] = data[i];
+        sizes[i] = 1 + (i * 23) % sizeof(data[i]);
+    }
+
+    SECTION("matches calc_hram") {
+        for (uint8_t use_keccak = 0; use_keccak < 2; use_keccak++)
+        {
+            ed25519_le_scalar_t hrams[COUNT];
+            REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, messages, sizes, COUNT, use_keccak) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            for (uint32_t i = 0; i < COUNT; i++)
+            {
+                ed25519_le_scalar_t hram;
+                REQUIRE(ed25519_calc_hram(ctx, &hram, &R[i], &public_keys[i], messages[i], sizes[i], use_keccak) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+                REQUIRE(memcmp(hram, hrams[i], sizeof(ed25519_le_scalar_t)) == 0);
+            }
+        }
+    }
+
+    SECTION("param check") {
+        ed25519_le_scalar_t hrams[COUNT];
+        REQUIRE(ed25519_calc_hram_batch(NULL, hrams, R, public_keys, messages, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, NULL, R, public_keys, messages, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, NULL, public_keys, messages, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, NULL, messages, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, NULL, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, messages, NULL, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, messages, sizes, 0, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        sizes[3] = 0;
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, messages, sizes, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        sizes[3] = 1;
+        messages[5] = NULL;
+        REQUIRE(ed25519_calc_hram_batch(ctx, hrams, R, public_keys, messages, sizes, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+    }
+    ed25519_algebra_ctx_free(ctx);
+}
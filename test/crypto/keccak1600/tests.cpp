@@ -0,0 +1,146 @@
+#include "crypto/keccak1600/keccak1600.h"
+#include <openssl/rand.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <string.h>
+
+#include <tests/catch.hpp>
+
+using Clock = std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock,
+        std::chrono::steady_clock>::type;
+
+struct test_messages
+{
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<std::vector<keccak1600_batch_buffer_t>> parts;
+    std::vector<keccak1600_batch_message_t> messages;
+};
+
+// messages of different lengths (crossing several blocks), each split to up to 3 parts (some may be empty)
+static void create_messages(test_messages& test, size_t count, size_t max_len)
+{
+    test.data.resize(count);
+    test.parts.resize(count);
+    test.messages.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t len = (i * 37) % (max_len + 1);
+        test.data[i].resize(len);
+        if (len)
+            RAND_bytes(test.data[i].data(), len);
+
+        size_t first = len / 3;
+        size_t second = i % 2 ? 0 : len / 2;
+        test.parts[i].push_back({test.data[i].data(), first});
+        test.parts[i].push_back({test.data[i].data() + first, second});
+        test.parts[i].push_back({test.data[i].data() + first + second, len - first - second});
+        test.messages[i].parts = test.parts[i].data();
+        test.messages[i].parts_count = test.parts[i].size();
+    }
+}
+
+static std::vector<uint8_t> expected_digests(const test_messages& test, size_t md_size_in_bits, unsigned char pad)
+{
+    std::vector<uint8_t> mds(test.messages.size() * md_size_in_bits / 8);
+    for (size_t i = 0; i < test.messages.size(); i++)
+    {
+        KECCAK1600_CTX ctx;
+        REQUIRE(keccak1600_init(&ctx, md_size_in_bits, pad));
+        REQUIRE(keccak1600_update(&ctx, test.data[i].data(), test.data[i].size()));
+        REQUIRE(keccak1600_final(&ctx, mds.data() + i * md_size_in_bits / 8));
+    }
+    return mds;
+}
+
+TEST_CASE("keccak1600_batch") {
+    SECTION("known answer") {
+        // keccak256("abc")
+        static const uint8_t ABC_KECCAK256[] = {0x4e, 0x03, 0x65, 0x7a, 0xea, 0x45, 0xa9, 0x4f, 0xc7, 0xd4, 0x7b, 0xa8, 0x26, 0xc8, 0xd6, 0x67,
+            0xc0, 0xd1, 0xe6, 0xe3, 0x3a, 0x64, 0xa0, 0x36, 0xec, 0x44, 0xf5, 0x8f, 0xa1, 0x2d, 0x6c, 0x45};
+        keccak1600_batch_buffer_t abc = {(const uint8_t*)"abc", 3};
+        keccak1600_batch_message_t messages[9];
+        for (size_t i = 0; i < 9; i++)
+            messages[i] = {&abc, 1};
+        const keccak1600_batch_impl impls[] = {KECCAK1600_BATCH_IMPL_AUTO, KECCAK1600_BATCH_IMPL_SCALAR, KECCAK1600_BATCH_IMPL_AVX2, KECCAK1600_BATCH_IMPL_AVX512};
+        for (auto impl : impls)
+        {
+            uint8_t mds[9][32];
+            if (!keccak1600_batch_with_impl(256, KECCAK256_PAD, messages, 9, &mds[0][0], impl))
+            {
+                REQUIRE(impl != KECCAK1600_BATCH_IMPL_AUTO);
+                REQUIRE(impl != KECCAK1600_BATCH_IMPL_SCALAR);
+                continue;
+            }
+            for (size_t i = 0; i < 9; i++)
+                REQUIRE(memcmp(mds[i], ABC_KECCAK256, sizeof(ABC_KECCAK256)) == 0);
+        }
+    }
+
+    SECTION("all implementations") {
+        test_messages test;
+        create_messages(test, 101, 500);
+        const keccak1600_batch_impl impls[] = {KECCAK1600_BATCH_IMPL_AUTO, KECCAK1600_BATCH_IMPL_SCALAR, KECCAK1600_BATCH_IMPL_AVX2, KECCAK1600_BATCH_IMPL_AVX512};
+        const size_t md_sizes[] = {224, 256, 384, 512};
+        const unsigned char pads[] = {KECCAK256_PAD, SHA3_FIPS202_PAD};
+        for (auto md_size : md_sizes)
+        {
+            for (auto pad : pads)
+            {
+                std::vector<uint8_t> expected = expected_digests(test, md_size, pad);
+                for (auto impl : impls)
+                {
+                    std::vector<uint8_t> mds(expected.size());
+                    if (!keccak1600_batch_with_impl(md_size, pad, test.messages.data(), test.messages.size(), mds.data(), impl))
+                    {
+                        REQUIRE((impl == KECCAK1600_BATCH_IMPL_AVX2 || impl == KECCAK1600_BATCH_IMPL_AVX512));
+                        continue;
+                    }
+                    REQUIRE(mds == expected);
+
+                    // fewer messages than lanes
+                    std::fill(mds.begin(), mds.end(), 0);
+                    REQUIRE(keccak1600_batch_with_impl(md_size, pad, test.messages.data(), 3, mds.data(), impl));
+                    REQUIRE(memcmp(mds.data(), expected.data(), 3 * md_size / 8) == 0);
+                }
+            }
+        }
+    }
+
+    SECTION("invalid param") {
+        uint8_t md[64];
+        keccak1600_batch_buffer_t null_data = {NULL, 1};
+        keccak1600_batch_message_t message = {&null_data, 1};
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, NULL, 1, md) == 0);
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, &message, 1, NULL) == 0);
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, &message, 1, md) == 0);
+        message.parts = NULL;
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, &message, 1, md) == 0);
+        message.parts_count = 0;
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, &message, 1, md) == 1);
+        REQUIRE(keccak1600_batch(250, KECCAK256_PAD, &message, 1, md) == 0);
+        REQUIRE(keccak1600_batch(800, KECCAK256_PAD, &message, 1, md) == 0);
+        REQUIRE(keccak1600_batch(256, KECCAK256_PAD, NULL, 0, NULL) == 1);
+        REQUIRE(keccak1600_batch_with_impl(256, KECCAK256_PAD, &message, 1, md, (keccak1600_batch_impl)7) == 0);
+    }
+
+    SECTION("performance") {
+        const size_t COUNT = 8000;
+        test_messages test;
+        create_messages(test, COUNT, 100);
+        std::vector<uint8_t> mds(COUNT * 64);
+        std::cout << "default keccak1600 batch implementation " << keccak1600_batch_default_impl() << std::endl;
+
+        const keccak1600_batch_impl impls[] = {KECCAK1600_BATCH_IMPL_SCALAR, KECCAK1600_BATCH_IMPL_AVX2, KECCAK1600_BATCH_IMPL_AVX512};
+        for (auto impl : impls)
+        {
+            auto before = Clock::now();
+            int ret = keccak1600_batch_with_impl(512, KECCAK256_PAD, test.messages.data(), COUNT, mds.data(), impl);
+            auto after = Clock::now();
+            if (ret)
+                std::cout << "keccak512 implementation " << impl << " of " << COUNT << " messages took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+        }
+    }
+}
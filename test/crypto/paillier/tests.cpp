@@ -4,6 +4,12 @@
 
 #include <string.h>
 
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <tests/catch.hpp>
 
 TEST_CASE( "gen_key", "paillier") {
@@ -711,6 +717,36 @@ TEST_CASE( "paillier_blum_zkp", "paillier") {
         REQUIRE(res == PAILLIER_SUCCESS);
     }
 
+    SECTION("parallel") {
+        REQUIRE(res == PAILLIER_SUCCESS);
+        // runs the tasks on 4 threads, each one taking every 4th task
+        auto executor = [](void* executor, uint32_t count, paillier_task_t task, void* arg)
+        {
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < 4; t++)
+            {
+                threads.emplace_back([=]()
+                {
+                    for (uint32_t i = t; i < count; i += 4)
+                        task(arg, i);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            ++*(uint32_t*)executor;
+        };
+        uint32_t calls = 0;
+        uint32_t proof_len;
+        res = paillier_generate_paillier_blum_zkp_parallel(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, NULL, 0, &proof_len, executor, &calls);
+        REQUIRE(res == PAILLIER_ERROR_BUFFER_TOO_SHORT);
+        std::unique_ptr<uint8_t[]> proof(new uint8_t[proof_len]);
+        res = paillier_generate_paillier_blum_zkp_parallel(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len, &proof_len, executor, &calls);
+        REQUIRE(res == PAILLIER_SUCCESS);
+        REQUIRE(calls == 1);
+        res = paillier_verify_paillier_blum_zkp(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+    }
+
     SECTION("invalid aad") {
         REQUIRE(res == PAILLIER_SUCCESS);
         uint32_t proof_len;
@@ -763,6 +799,92 @@ TEST_CASE( "paillier_blum_zkp", "paillier") {
         res = paillier_verify_paillier_blum_zkp(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), 7);
         REQUIRE(res == PAILLIER_ERROR_INVALID_PARAM);
     }
+
+    SECTION("prime modulus") {
+        REQUIRE(res == PAILLIER_SUCCESS);
+        uint32_t proof_len;
+        res = paillier_generate_paillier_blum_zkp(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, NULL, 0, &proof_len);
+        REQUIRE(res == PAILLIER_ERROR_BUFFER_TOO_SHORT);
+        std::unique_ptr<uint8_t[]> proof(new uint8_t[proof_len]);
+        res = paillier_generate_paillier_blum_zkp(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len, &proof_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+
+        // a prime n = 5 mod 8 has the same size as the real modulus
+        BIGNUM* prime = BN_new();
+        BIGNUM* eight = BN_new();
+        BIGNUM* five = BN_new();
+        REQUIRE(BN_set_word(eight, 8));
+        REQUIRE(BN_set_word(five, 5));
+        REQUIRE(BN_generate_prime_ex(prime, 2048, 0, eight, five, NULL));
+        uint8_t buffer[sizeof(uint32_t) + 256];
+        *(uint32_t*)buffer = 256;
+        REQUIRE(BN_bn2binpad(prime, buffer + sizeof(uint32_t), 256) == 256);
+        paillier_public_key_t* prime_pub = paillier_public_key_deserialize(buffer, sizeof(buffer));
+        REQUIRE(prime_pub);
+        res = paillier_verify_paillier_blum_zkp(prime_pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len);
+        REQUIRE(res == PAILLIER_ERROR_INVALID_KEY);
+        paillier_free_public_key(prime_pub);
+        BN_free(prime);
+        BN_free(eight);
+        BN_free(five);
+    }
+
+    SECTION("performance") {
+        REQUIRE(res == PAILLIER_SUCCESS);
+        const size_t COUNT = 10;
+        uint32_t proof_len;
+        res = paillier_generate_paillier_blum_zkp(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, NULL, 0, &proof_len);
+        REQUIRE(res == PAILLIER_ERROR_BUFFER_TOO_SHORT);
+        std::unique_ptr<uint8_t[]> proof(new uint8_t[proof_len]);
+        res = paillier_generate_paillier_blum_zkp(priv, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len, &proof_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+
+        auto before = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            res = paillier_verify_paillier_blum_zkp(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len);
+            REQUIRE(res == PAILLIER_SUCCESS);
+        }
+        std::cout << "paillier blum zkp verification took: " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count() / COUNT << " us" << std::endl;
+    }
+
+    SECTION("deserialized key") {
+        REQUIRE(res == PAILLIER_SUCCESS);
+        uint32_t len = 0;
+        paillier_private_key_serialize(priv, NULL, 0, &len);
+        std::unique_ptr<uint8_t[]> buffer(new uint8_t[len]);
+        REQUIRE(paillier_private_key_serialize(priv, buffer.get(), len, &len));
+        paillier_private_key_t* priv2 = paillier_private_key_deserialize(buffer.get(), len);
+        REQUIRE(priv2);
+
+        uint32_t proof_len;
+        res = paillier_generate_paillier_blum_zkp(priv2, (const unsigned char*)"hello world", sizeof("hello world") - 1, NULL, 0, &proof_len);
+        REQUIRE(res == PAILLIER_ERROR_BUFFER_TOO_SHORT);
+        std::unique_ptr<uint8_t[]> proof(new uint8_t[proof_len]);
+        auto before = std::chrono::steady_clock::now();
+        res = paillier_generate_paillier_blum_zkp(priv2, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len, &proof_len);
+        std::cout << "paillier blum zkp generation took: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - before).count() << " ms" << std::endl;
+        REQUIRE(res == PAILLIER_SUCCESS);
+        res = paillier_verify_paillier_blum_zkp(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, proof.get(), proof_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+
+        unsigned char x[PAILLIER_SHA256_LEN];
+        unsigned char y[256];
+        res = paillier_generate_factorization_zkpok(priv2, (const unsigned char*)"hello world", sizeof("hello world") - 1, x, y, sizeof(y), NULL);
+        REQUIRE(res == PAILLIER_SUCCESS);
+        res = paillier_verify_factorization_zkpok(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, x, y, sizeof(y));
+        REQUIRE(res == PAILLIER_SUCCESS);
+
+        uint32_t coprime_len;
+        res = paillier_generate_coprime_zkp(priv2, (const unsigned char*)"hello world", sizeof("hello world") - 1, NULL, 0, &coprime_len);
+        REQUIRE(res == PAILLIER_ERROR_BUFFER_TOO_SHORT);
+        std::unique_ptr<uint8_t[]> coprime(new uint8_t[coprime_len]);
+        res = paillier_generate_coprime_zkp(priv2, (const unsigned char*)"hello world", sizeof("hello world") - 1, coprime.get(), coprime_len, &coprime_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+        res = paillier_verify_coprime_zkp(pub, (const unsigned char*)"hello world", sizeof("hello world") - 1, coprime.get(), coprime_len);
+        REQUIRE(res == PAILLIER_SUCCESS);
+        paillier_free_private_key(priv2);
+    }
     
     paillier_free_public_key(pub);
     paillier_free_private_key(priv);
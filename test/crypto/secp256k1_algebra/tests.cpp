@@ -552,4 +552,79 @@ TEST_CASE( "point_projection" ) {
     REQUIRE(overflow == 1);
     REQUIRE(memcmp(x_val, two, sizeof(elliptic_curve256_scalar_t)) == 0);
     GFp_curve_algebra_ctx_free(secp256k1);
-}
\ No newline at end of file
+}
+TEST_CASE( "generator_mul_batch" ) {
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_secp256k1_algebra(), elliptic_curve256_new_secp256r1_algebra(), elliptic_curve256_new_stark_algebra()};
+    const uint32_t COUNT = 9;
+
+    for (auto algebra : algebras)
+    {
+        REQUIRE(algebra);
+        elliptic_curve256_scalar_t exps[COUNT];
+        elliptic_curve256_point_t points[COUNT];
+        for (uint32_t i = 0; i < COUNT; i++)
+            REQUIRE(algebra->rand(algebra, &exps[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        memset(exps[2], 0, sizeof(elliptic_curve256_scalar_t)); // infinity
+        memset(exps[5], 0xff, sizeof(elliptic_curve256_scalar_t)); // larger than the order
+
+        REQUIRE(algebra->generator_mul_batch(algebra, points, exps, COUNT) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            elliptic_curve256_point_t expected;
+            REQUIRE(algebra->generator_mul(algebra, &expected, &exps[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(memcmp(points[i], expected, sizeof(elliptic_curve256_point_t)) == 0);
+        }
+
+        REQUIRE(algebra->generator_mul_batch(algebra, points, exps, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->generator_mul_batch(algebra, NULL, exps, COUNT) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->generator_mul_batch(algebra, points, NULL, COUNT) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        elliptic_curve256_algebra_ctx_free(algebra);
+    }
+}
+
+TEST_CASE( "batch_inverse" ) {
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_secp256k1_algebra(), elliptic_curve256_new_secp256r1_algebra(), elliptic_curve256_new_stark_algebra()};
+    const uint32_t COUNT = 9;
+
+    for (auto algebra : algebras)
+    {
+        REQUIRE(algebra);
+        elliptic_curve256_scalar_t vals[COUNT];
+        elliptic_curve256_scalar_t inverses[COUNT];
+        for (uint32_t i = 0; i < COUNT; i++)
+            REQUIRE(algebra->rand(algebra, &vals[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        memset(vals[4], 0, sizeof(elliptic_curve256_scalar_t));
+        vals[4][sizeof(elliptic_curve256_scalar_t) - 1] = 1;
+
+        for (uint8_t constant_time = 0; constant_time < 2; constant_time++)
+        {
+            REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, constant_time) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            for (uint32_t i = 0; i < COUNT; i++)
+            {
+                elliptic_curve256_scalar_t expected;
+                REQUIRE(algebra->inverse(algebra, &expected, &vals[i]) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+                REQUIRE(memcmp(inverses[i], expected, sizeof(elliptic_curve256_scalar_t)) == 0);
+            }
+        }
+
+        // in place
+        memcpy(inverses, vals, sizeof(vals));
+        REQUIRE(algebra->batch_inverse(algebra, inverses, inverses, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            elliptic_curve256_scalar_t one;
+            REQUIRE(algebra->mul_scalars(algebra, &one, vals[i], sizeof(elliptic_curve256_scalar_t), inverses[i], sizeof(elliptic_curve256_scalar_t)) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            for (size_t j = 0; j < sizeof(elliptic_curve256_scalar_t) - 1; j++)
+                REQUIRE(one[j] == 0);
+            REQUIRE(one[sizeof(elliptic_curve256_scalar_t) - 1] == 1);
+        }
+
+        memset(vals[7], 0, sizeof(elliptic_curve256_scalar_t));
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, COUNT, 1) == ELLIPTIC_CURVE_ALGEBRA_INVALID_SCALAR);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, vals, 0, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->batch_inverse(algebra, NULL, vals, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        REQUIRE(algebra->batch_inverse(algebra, inverses, NULL, COUNT, 0) == ELLIPTIC_CURVE_ALGEBRA_INVALID_PARAMETER);
+        elliptic_curve256_algebra_ctx_free(algebra);
+    }
+}
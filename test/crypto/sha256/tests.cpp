@@ -0,0 +1,173 @@
+#include "crypto/sha256/sha256_batch.h"
+#include "crypto/commitments/commitments.h"
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <string.h>
+
+#include <tests/catch.hpp>
+
+using Clock = std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock,
+        std::chrono::steady_clock>::type;
+
+struct digest
+{
+    sha256_md_t md;
+};
+
+struct test_messages
+{
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<std::vector<sha256_batch_buffer_t>> parts;
+    std::vector<sha256_batch_message_t> messages;
+    std::vector<digest> expected;
+};
+
+// messages of different lengths, each split to up to 3 parts (some may be empty)
+static void create_messages(test_messages& test, size_t count, size_t max_len)
+{
+    test.data.resize(count);
+    test.parts.resize(count);
+    test.messages.resize(count);
+    test.expected.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t len = (i * 37) % (max_len + 1);
+        test.data[i].resize(len);
+        if (len)
+            RAND_bytes(test.data[i].data(), len);
+        SHA256(test.data[i].data(), len, test.expected[i].md);
+
+        uint32_t first = len / 3;
+        uint32_t second = i % 2 ? 0 : len / 2;
+        test.parts[i].push_back({test.data[i].data(), first});
+        test.parts[i].push_back({test.data[i].data() + first, second});
+        test.parts[i].push_back({test.data[i].data() + first + second, len - first - second});
+        test.messages[i].parts = test.parts[i].data();
+        test.messages[i].parts_count = test.parts[i].size();
+    }
+}
+
+TEST_CASE("sha256_batch") {
+    SECTION("known answer") {
+        static const uint8_t ABC_SHA256[] = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+            0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+        sha256_batch_buffer_t abc = {(const uint8_t*)"abc", 3};
+        sha256_batch_message_t messages[9];
+        for (size_t i = 0; i < 9; i++)
+            messages[i] = {&abc, 1};
+        sha256_md_t digests[9];
+        REQUIRE(sha256_batch(messages, 9, digests) == SHA256_BATCH_SUCCESS);
+        for (size_t i = 0; i < 9; i++)
+            REQUIRE(memcmp(digests[i], ABC_SHA256, sizeof(sha256_md_t)) == 0);
+
+        for (auto impl : {SHA256_BATCH_IMPL_MULTI_BUFFER, SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512})
+        {
+            memset(digests, 0, sizeof(digests));
+            sha256_batch_status status = sha256_batch_with_impl(messages, 9, digests, impl);
+            REQUIRE((status == SHA256_BATCH_SUCCESS || status == SHA256_BATCH_NOT_SUPPORTED));
+            if (status == SHA256_BATCH_SUCCESS)
+            {
+                for (size_t i = 0; i < 9; i++)
+                    REQUIRE(memcmp(digests[i], ABC_SHA256, sizeof(sha256_md_t)) == 0);
+            }
+        }
+    }
+
+    SECTION("all implementations") {
+        test_messages test;
+        create_messages(test, 101, 300);
+        const sha256_batch_impl impls[] = {SHA256_BATCH_IMPL_AUTO, SHA256_BATCH_IMPL_OPENSSL, SHA256_BATCH_IMPL_MULTI_BUFFER, SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512};
+        for (auto impl : impls)
+        {
+            std::vector<digest> digests(test.messages.size());
+            sha256_batch_status status = sha256_batch_with_impl(test.messages.data(), test.messages.size(), (sha256_md_t*)digests.data(), impl);
+            if (status == SHA256_BATCH_NOT_SUPPORTED)
+                continue;
+            REQUIRE(status == SHA256_BATCH_SUCCESS);
+            for (size_t i = 0; i < test.messages.size(); i++)
+                REQUIRE(memcmp(digests[i].md, test.expected[i].md, sizeof(sha256_md_t)) == 0);
+
+            // fewer messages than lanes
+            REQUIRE(sha256_batch_with_impl(test.messages.data(), 3, (sha256_md_t*)digests.data(), impl) == SHA256_BATCH_SUCCESS);
+            for (size_t i = 0; i < 3; i++)
+                REQUIRE(memcmp(digests[i].md, test.expected[i].md, sizeof(sha256_md_t)) == 0);
+        }
+    }
+
+    SECTION("invalid param") {
+        sha256_md_t digest;
+        sha256_batch_buffer_t null_data = {NULL, 1};
+        sha256_batch_message_t message = {&null_data, 1};
+        REQUIRE(sha256_batch(NULL, 1, &digest) == SHA256_BATCH_INVALID_PARAMETER);
+        REQUIRE(sha256_batch(&message, 1, NULL) == SHA256_BATCH_INVALID_PARAMETER);
+        REQUIRE(sha256_batch(&message, 1, &digest) == SHA256_BATCH_INVALID_PARAMETER);
+        message.parts = NULL;
+        REQUIRE(sha256_batch(&message, 1, &digest) == SHA256_BATCH_INVALID_PARAMETER);
+        REQUIRE(sha256_batch(NULL, 0, NULL) == SHA256_BATCH_SUCCESS);
+        REQUIRE(sha256_batch_with_impl(&message, 0, &digest, (sha256_batch_impl)7) == SHA256_BATCH_SUCCESS);
+        message.parts_count = 0;
+        REQUIRE(sha256_batch_with_impl(&message, 1, &digest, (sha256_batch_impl)7) == SHA256_BATCH_INVALID_PARAMETER);
+    }
+
+    SECTION("performance") {
+        const size_t COUNT = 10000;
+        test_messages test;
+        create_messages(test, COUNT, 100);
+        std::vector<digest> digests(COUNT);
+        std::cout << "default sha256 batch implementation " << sha256_batch_default_impl() << std::endl;
+
+        auto before = Clock::now();
+        REQUIRE(sha256_batch_with_impl(test.messages.data(), COUNT, (sha256_md_t*)digests.data(), SHA256_BATCH_IMPL_OPENSSL) == SHA256_BATCH_SUCCESS);
+        auto after = Clock::now();
+        std::cout << "openssl sha256 of " << COUNT << " messages took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+
+        before = Clock::now();
+        sha256_batch_status status = sha256_batch_with_impl(test.messages.data(), COUNT, (sha256_md_t*)digests.data(), SHA256_BATCH_IMPL_MULTI_BUFFER);
+        after = Clock::now();
+        if (status == SHA256_BATCH_SUCCESS)
+            std::cout << "multi buffer sha256 of " << COUNT << " messages took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+
+        before = Clock::now();
+        status = sha256_batch_with_impl(test.messages.data(), COUNT, (sha256_md_t*)digests.data(), SHA256_BATCH_IMPL_MULTI_BUFFER_AVX512);
+        after = Clock::now();
+        if (status == SHA256_BATCH_SUCCESS)
+            std::cout << "avx512 multi buffer sha256 of " << COUNT << " messages took: " << std::chrono::duration_cast<std::chrono::microseconds>(after - before).count() << " us" << std::endl;
+    }
+}
+
+TEST_CASE("commitments_batch") {
+    const size_t COUNT = 20;
+    std::vector<std::vector<uint8_t>> data(COUNT);
+    std::vector<const uint8_t*> ptrs(COUNT);
+    std::vector<uint32_t> sizes(COUNT);
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        data[i].resize(i + 1);
+        RAND_bytes(data[i].data(), data[i].size());
+        ptrs[i] = data[i].data();
+        sizes[i] = data[i].size();
+    }
+
+    std::vector<commitments_commitment_t> commitments(COUNT);
+    REQUIRE(commitments_create_commitments_batch(ptrs.data(), sizes.data(), COUNT, commitments.data()) == COMMITMENTS_SUCCESS);
+    for (size_t i = 0; i < COUNT; i++)
+        REQUIRE(commitments_verify_commitment(ptrs[i], sizes[i], &commitments[i]) == COMMITMENTS_SUCCESS);
+    REQUIRE(commitments_verify_commitments_batch(ptrs.data(), sizes.data(), COUNT, commitments.data()) == COMMITMENTS_SUCCESS);
+
+    commitments_commitment_t single;
+    REQUIRE(commitments_create_commitment_for_data(ptrs[3], sizes[3], &single) == COMMITMENTS_SUCCESS);
+    commitments[3] = single;
+    REQUIRE(commitments_verify_commitments_batch(ptrs.data(), sizes.data(), COUNT, commitments.data()) == COMMITMENTS_SUCCESS);
+
+    data[COUNT - 1][0] ^= 1;
+    REQUIRE(commitments_verify_commitments_batch(ptrs.data(), sizes.data(), COUNT, commitments.data()) == COMMITMENTS_INVALID_COMMITMENT);
+
+    sizes[0] = 0;
+    REQUIRE(commitments_verify_commitments_batch(ptrs.data(), sizes.data(), COUNT, commitments.data()) == COMMITMENTS_INVALID_PARAMETER);
+    REQUIRE(commitments_create_commitments_batch(ptrs.data(), sizes.data(), 0, commitments.data()) == COMMITMENTS_INVALID_PARAMETER);
+}
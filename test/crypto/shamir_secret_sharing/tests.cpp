@@ -3,6 +3,7 @@
 #include <openssl/bn.h>
 
 #include <memory>
+#include <utility>
 
 #include <string.h>
 
@@ -379,3 +380,220 @@ TEST_CASE( "ed25519", "secret_sharing") {
         printf("%s\n", secret2);
     }
 }
+
+TEST_CASE( "custom_ids", "secret_sharing") {
+    const uint8_t T = 7;
+    const uint8_t N = 12;
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_secp256k1_algebra(), elliptic_curve256_new_stark_algebra(), elliptic_curve256_new_ed25519_algebra()};
+
+    for (auto algebra : algebras)
+    {
+        elliptic_curve256_scalar_t secret;
+        uint8_t secret2[sizeof(elliptic_curve256_scalar_t)];
+        uint64_t ids[N];
+        verifiable_secret_sharing_t *shamir;
+        shamir_secret_share_t share[N];
+        elliptic_curve256_point_t share_proof[N];
+        elliptic_curve256_point_t coeff_proof[T];
+        uint32_t size;
+
+        REQUIRE(algebra->rand(algebra, &secret) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        for (size_t i = 0; i < N; i++)
+            ids[i] = 0xfedcba9876543210ULL - i * 0x1000000001ULL;
+        REQUIRE(verifiable_secret_sharing_split_with_custom_ids(algebra, secret, sizeof(secret), T, N, ids, &shamir) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        REQUIRE(verifiable_secret_sharing_get_polynom_proofs(shamir, coeff_proof, T) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        for (size_t i = 0; i < N; i++)
+        {
+            REQUIRE(verifiable_secret_sharing_get_share_and_proof(shamir, i, share + i, share_proof + i) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            REQUIRE(share[i].id == ids[i]);
+        }
+        verifiable_secret_sharing_free_shares(shamir);
+
+        // the first coefficient is the secret
+        elliptic_curve256_point_t public_key;
+        REQUIRE(algebra->generator_mul(algebra, &public_key, &secret) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+        REQUIRE(memcmp(public_key, coeff_proof[0], sizeof(elliptic_curve256_point_t)) == 0);
+
+        for (size_t i = 0; i < N; i++)
+        {
+            elliptic_curve256_point_t proof;
+            REQUIRE(algebra->generator_mul(algebra, &proof, &share[i].data) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(memcmp(proof, share_proof[i], sizeof(elliptic_curve256_point_t)) == 0);
+            REQUIRE(verifiable_secret_sharing_verify_share(algebra, share[i].id, share_proof + i, T, coeff_proof) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        }
+
+        REQUIRE(verifiable_secret_sharing_reconstruct(algebra, share + N - T, T, secret2, sizeof(secret2), &size) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        REQUIRE(size <= sizeof(secret));
+        REQUIRE(memcmp(secret + sizeof(secret) - size, secret2, size) == 0);
+        elliptic_curve256_algebra_ctx_free(algebra);
+    }
+}
+
+TEST_CASE( "verify_shares_batch", "secret_sharing") {
+    const uint8_t T = 4;
+    const uint8_t N = 6;
+    const uint32_t DEALERS = 7;
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_secp256k1_algebra(), elliptic_curve256_new_secp256r1_algebra(), elliptic_curve256_new_ed25519_algebra()};
+
+    for (auto algebra : algebras)
+    {
+        // every dealer sends the share of player index (dealer % N)
+        uint64_t ids[DEALERS];
+        elliptic_curve256_point_t share_proofs[DEALERS];
+        elliptic_curve256_point_t coeff_proofs[DEALERS * T];
+        for (uint32_t i = 0; i < DEALERS; i++)
+        {
+            elliptic_curve256_scalar_t secret;
+            verifiable_secret_sharing_t *shamir;
+            shamir_secret_share_t share;
+            REQUIRE(algebra->rand(algebra, &secret) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(verifiable_secret_sharing_split(algebra, secret, sizeof(secret), T, N, &shamir) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            REQUIRE(verifiable_secret_sharing_get_polynom_proofs(shamir, coeff_proofs + i * T, T) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            REQUIRE(verifiable_secret_sharing_get_share_and_proof(shamir, i % N, &share, share_proofs + i) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            ids[i] = share.id;
+            verifiable_secret_sharing_free_shares(shamir);
+        }
+
+        uint32_t invalid_index = DEALERS;
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, DEALERS, T, coeff_proofs, &invalid_index) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        REQUIRE(invalid_index == DEALERS);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, 1, T, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+
+        for (uint32_t bad = 0; bad < DEALERS; bad += 3)
+        {
+            // a share proof that belongs to another dealer
+            elliptic_curve256_point_t saved;
+            memcpy(saved, share_proofs[bad], sizeof(saved));
+            memcpy(share_proofs[bad], share_proofs[(bad + 1) % DEALERS], sizeof(saved));
+            REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, DEALERS, T, coeff_proofs, &invalid_index) == VERIFIABLE_SECRET_SHARING_INVALID_SHARE);
+            REQUIRE(invalid_index == bad);
+            memcpy(share_proofs[bad], saved, sizeof(saved));
+        }
+
+        ids[DEALERS - 1]++;
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, DEALERS, T, coeff_proofs, &invalid_index) == VERIFIABLE_SECRET_SHARING_INVALID_SHARE);
+        REQUIRE(invalid_index == DEALERS - 1);
+        ids[DEALERS - 1]--;
+
+        // all the shares of two dealers, the coefficient proofs repeat for each share
+        uint64_t all_ids[2 * N];
+        elliptic_curve256_point_t all_share_proofs[2 * N];
+        elliptic_curve256_point_t all_coeff_proofs[2 * N * T];
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            elliptic_curve256_scalar_t secret;
+            verifiable_secret_sharing_t *shamir;
+            elliptic_curve256_point_t polynom[T];
+            REQUIRE(algebra->rand(algebra, &secret) == ELLIPTIC_CURVE_ALGEBRA_SUCCESS);
+            REQUIRE(verifiable_secret_sharing_split(algebra, secret, sizeof(secret), T, N, &shamir) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            REQUIRE(verifiable_secret_sharing_get_polynom_proofs(shamir, polynom, T) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            for (uint32_t j = 0; j < N; j++)
+            {
+                // interleave the dealers
+                shamir_secret_share_t share;
+                REQUIRE(verifiable_secret_sharing_get_share_and_proof(shamir, j, &share, all_share_proofs + 2 * j + i) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+                all_ids[2 * j + i] = share.id;
+                memcpy(all_coeff_proofs + (2 * j + i) * T, polynom, sizeof(polynom));
+            }
+            verifiable_secret_sharing_free_shares(shamir);
+        }
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, all_ids, all_share_proofs, 2 * N, T, all_coeff_proofs, &invalid_index) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        std::swap(all_ids[5], all_ids[7]);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, all_ids, all_share_proofs, 2 * N, T, all_coeff_proofs, &invalid_index) == VERIFIABLE_SECRET_SHARING_INVALID_SHARE);
+        REQUIRE(invalid_index == 5);
+
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(NULL, ids, share_proofs, DEALERS, T, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, NULL, share_proofs, DEALERS, T, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, NULL, DEALERS, T, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, 0, T, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, DEALERS, 0, coeff_proofs, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_verify_shares_batch(algebra, ids, share_proofs, DEALERS, T, NULL, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        elliptic_curve256_algebra_ctx_free(algebra);
+    }
+}
+
+// lambda_i = prod(x_j / (x_j - x_i)) for j != i
+static void naive_lagrange_coefficient(const elliptic_curve256_algebra_ctx_t* algebra, const uint64_t* ids, uint8_t count, uint8_t index, elliptic_curve256_scalar_t* res)
+{
+    BN_CTX* ctx = BN_CTX_new();
+    BIGNUM* p = BN_new();
+    BIGNUM* x = BN_new();
+    BIGNUM* tmp = BN_new();
+    const BIGNUM* field = algebra->order_internal(algebra);
+    BN_one(p);
+    for (uint8_t j = 0; j < count; j++)
+    {
+        if (j == index)
+            continue;
+        BN_set_word(x, ids[j]);
+        BN_set_word(tmp, ids[index]);
+        BN_mod_sub(tmp, x, tmp, field, ctx);
+        BN_mod_inverse(tmp, tmp, field, ctx);
+        BN_mod_mul(tmp, tmp, x, field, ctx);
+        BN_mod_mul(p, p, tmp, field, ctx);
+    }
+    BN_bn2binpad(p, *res, sizeof(elliptic_curve256_scalar_t));
+    BN_free(tmp);
+    BN_free(x);
+    BN_free(p);
+    BN_CTX_free(ctx);
+}
+
+TEST_CASE( "lagrange_coefficients", "secret_sharing") {
+    elliptic_curve256_algebra_ctx_t* algebras[] = {elliptic_curve256_new_secp256k1_algebra(), elliptic_curve256_new_ed25519_algebra()};
+    const uint8_t COUNT = 5;
+    uint64_t ids[COUNT] = {0xfedcba9876543210ULL, 3, 0x1000000001ULL, 17, 0x8000000000000000ULL};
+    elliptic_curve256_scalar_t coefficients[COUNT];
+    elliptic_curve256_scalar_t expected;
+
+    verifiable_secret_sharing_clear_lagrange_cache();
+    for (auto algebra : algebras)
+    {
+        // the second call is served from the cache, the third with a different order of the same ids
+        for (size_t round = 0; round < 3; round++)
+        {
+            if (round == 2)
+            {
+                std::swap(ids[0], ids[4]);
+                std::swap(ids[1], ids[2]);
+            }
+            REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebra, ids, COUNT, coefficients) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            for (uint8_t i = 0; i < COUNT; i++)
+            {
+                naive_lagrange_coefficient(algebra, ids, COUNT, i, &expected);
+                REQUIRE(memcmp(coefficients[i], expected, sizeof(elliptic_curve256_scalar_t)) == 0);
+            }
+        }
+
+        // more ids sets than cache entries
+        for (uint64_t first = 100; first < 200; first++)
+        {
+            uint64_t subset[3] = {first, 1, 2};
+            REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebra, subset, 3, coefficients) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+            for (uint8_t i = 0; i < 3; i++)
+            {
+                naive_lagrange_coefficient(algebra, subset, 3, i, &expected);
+                REQUIRE(memcmp(coefficients[i], expected, sizeof(elliptic_curve256_scalar_t)) == 0);
+            }
+        }
+
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebra, ids, 1, coefficients) == VERIFIABLE_SECRET_SHARING_SUCCESS);
+        naive_lagrange_coefficient(algebra, ids, 1, 0, &expected);
+        REQUIRE(memcmp(coefficients[0], expected, sizeof(elliptic_curve256_scalar_t)) == 0);
+    }
+
+    SECTION("invalid") {
+        uint64_t bad_ids[3] = {1, 2, 1};
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(NULL, ids, COUNT, coefficients) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebras[0], NULL, COUNT, coefficients) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebras[0], ids, 0, coefficients) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebras[0], ids, COUNT, NULL) == VERIFIABLE_SECRET_SHARING_INVALID_PARAMETER);
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebras[0], bad_ids, 3, coefficients) == VERIFIABLE_SECRET_SHARING_INVALID_SHARE_ID);
+        bad_ids[2] = 0;
+        REQUIRE(verifiable_secret_sharing_get_lagrange_coefficients(algebras[0], bad_ids, 3, coefficients) == VERIFIABLE_SECRET_SHARING_INVALID_SHARE_ID);
+    }
+
+    verifiable_secret_sharing_clear_lagrange_cache();
+    for (auto algebra : algebras)
+        elliptic_curve256_algebra_ctx_free(algebra);
+}
@@ -897,6 +897,7 @@ TEST_CASE("paillier_large_factors", "verify") {
     {
         BIGNUM *n;
         BIGNUM *n2;
+        BN_MONT_CTX *mont_n2;
     };
 
     struct paillier_private_key 
@@ -906,6 +907,9 @@ TEST_CASE("paillier_large_factors", "verify") {
         BIGNUM *q;
         BIGNUM *lamda;
         BIGNUM *mu;
+        BIGNUM *p_inv_mod_q;
+        BN_MONT_CTX *mont_p;
+        BN_MONT_CTX *mont_q;
     };
 
     SECTION("invalid proof") {
@@ -0,0 +1,126 @@
+#include "logging/logging_t.h"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tests/catch.hpp>
+
+struct log_records
+{
+    std::mutex lock;
+    std::vector<std::pair<int, std::string>> messages;
+};
+
+static void record_callback(int level, const char* file, int line, const char* func, const char* message, void* userp)
+{
+    (void)file;
+    (void)line;
+    (void)func;
+    auto records = (log_records*)userp;
+    std::lock_guard<std::mutex> lg(records->lock);
+    records->messages.emplace_back(level, message);
+}
+
+static int formatted_arg(int& count)
+{
+    return ++count;
+}
+
+TEST_CASE("logging") {
+    log_records records;
+    cosigner_log_init(record_callback, &records);
+
+    SECTION("min level") {
+        int count = 0;
+        cosigner_log_set_min_level(COSIGNER_LOG_LEVEL_WARN);
+        REQUIRE(cosigner_log_get_min_level() == COSIGNER_LOG_LEVEL_WARN);
+        LOG_INFO("info %d", formatted_arg(count));
+        LOG_DEBUG("debug %d", formatted_arg(count));
+        LOG_WARN("warn %d", formatted_arg(count));
+        LOG_ERROR("error %d", formatted_arg(count));
+        cosigner_log_set_min_level(0);
+
+        // the arguments of filtered messages aren't evaluated
+        REQUIRE(count == 2);
+        REQUIRE(records.messages.size() == 2);
+        REQUIRE(records.messages[0] == std::make_pair((int)COSIGNER_LOG_LEVEL_WARN, std::string("warn 1")));
+        REQUIRE(records.messages[1] == std::make_pair((int)COSIGNER_LOG_LEVEL_ERROR, std::string("error 2")));
+    }
+
+    SECTION("async") {
+        REQUIRE(cosigner_log_async_start(0) == -1);
+        REQUIRE(cosigner_log_async_start(100) == -1);
+        REQUIRE(cosigner_log_async_start(1024) == 0);
+        REQUIRE(cosigner_log_async_start(1024) == -1);
+
+        const size_t THREADS = 4;
+        const size_t MESSAGES = 200;
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREADS; i++)
+        {
+            threads.emplace_back([i]()
+            {
+                for (size_t j = 0; j < MESSAGES; j++)
+                    LOG_INFO("thread %lu message %lu", i, j);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        cosigner_log_async_stop();
+
+        // all the messages are delivered in order by the time stop returns
+        REQUIRE(records.messages.size() == THREADS * MESSAGES);
+        std::vector<size_t> next(THREADS, 0);
+        for (auto& m : records.messages)
+        {
+            size_t thread, message;
+            REQUIRE(sscanf(m.second.c_str(), "thread %lu message %lu", &thread, &message) == 2);
+            REQUIRE(thread < THREADS);
+            REQUIRE(message == next[thread]++);
+        }
+
+        // after stop messages are delivered synchronously
+        LOG_INFO("sync");
+        REQUIRE(records.messages.back().second == "sync");
+    }
+
+    SECTION("dropped") {
+        REQUIRE(cosigner_log_async_start(2) == 0);
+        for (size_t i = 0; i < 100; i++)
+            LOG_INFO("message %lu", i);
+        cosigner_log_async_stop();
+
+        // some messages may be dropped, but each drop is reported
+        size_t delivered = 0, dropped = 0;
+        for (auto& m : records.messages)
+        {
+            size_t count;
+            if (sscanf(m.second.c_str(), "%lu log messages were dropped", &count) == 1)
+                dropped += count;
+            else
+                delivered++;
+        }
+        REQUIRE(delivered + dropped == 100);
+    }
+
+    SECTION("errors aren't dropped") {
+        REQUIRE(cosigner_log_async_start(2) == 0);
+        for (size_t i = 0; i < 100; i++)
+            LOG_ERROR("error %lu", i);
+        cosigner_log_async_stop();
+
+        size_t errors = 0;
+        for (auto& m : records.messages)
+        {
+            size_t count;
+            REQUIRE(sscanf(m.second.c_str(), "%lu log messages were dropped", &count) != 1);
+            if (m.first == COSIGNER_LOG_LEVEL_ERROR)
+                errors++;
+        }
+        REQUIRE(errors == 100);
+    }
+
+    cosigner_log_init(NULL, NULL);
+}